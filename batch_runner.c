@@ -0,0 +1,170 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "batch_runner.h"
+#include "battle.h"
+#include "entity_factory.h"
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    const BatchConfig *config;
+    uint32_t *next_battle;      // shared work counter
+    BatchResult partial;        // this worker's tallies, merged after join
+    int started;
+    int failed;
+} BatchWorker;
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Mix the batch seed with the battle index so every battle gets its own stream
+static uint32_t battle_seed(uint32_t seed, uint32_t battle_index) {
+    uint32_t h = seed ^ (battle_index * 0x9E3779B9u);
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+static void tally_battle(BatchResult *r, const BattleResult *battle, const BatchConfig *config) {
+    r->battles++;
+    r->total_turns += battle->turns;
+    if (battle->turns < r->min_turns) r->min_turns = battle->turns;
+    if (battle->turns > r->max_turns) r->max_turns = battle->turns;
+    if (battle->timed_out) r->timeouts++;
+
+    if (battle->winner < 0) {
+        r->draws++;
+        return;
+    }
+
+    uint32_t survivors = battle->survivors[battle->winner];
+    uint32_t army = battle->winner == 0 ? config->team_a_size : config->team_b_size;
+    if (battle->winner == 0) r->team_a_wins++;
+    else r->team_b_wins++;
+
+    r->total_survivors += survivors;
+    uint32_t bucket = (uint32_t)((uint64_t)survivors * BATCH_SURVIVOR_BUCKETS / (army ? army : 1));
+    if (bucket >= BATCH_SURVIVOR_BUCKETS) bucket = BATCH_SURVIVOR_BUCKETS - 1;
+    r->survivor_histogram[bucket]++;
+}
+
+static void* batch_worker_main(void *arg) {
+    BatchWorker *worker = arg;
+    const BatchConfig *config = worker->config;
+
+    // One World per worker, reused for every battle it picks up
+    World *world = world_create((size_t)config->team_a_size + config->team_b_size);
+    if (!world) {
+        worker->failed = 1;
+        return NULL;
+    }
+    world->targeting_mode = config->targeting_mode;
+    world->schedule_mode = config->schedule_mode;
+
+    for (;;) {
+        uint32_t battle_index = __atomic_fetch_add(worker->next_battle, 1, __ATOMIC_RELAXED);
+        if (battle_index >= config->battles) break;
+
+        world_reset_battle(world);
+        world_seed(world, battle_seed(config->seed, battle_index));
+        spawn_army(world, 0, config->team_a_size);
+        spawn_army(world, 1, config->team_b_size);
+
+        BattleResult battle = battle_run(world, config->max_turns);
+        tally_battle(&worker->partial, &battle, config);
+    }
+
+    world_destroy(world);
+    return NULL;
+}
+
+static void batch_result_init(BatchResult *r) {
+    memset(r, 0, sizeof(*r));
+    r->min_turns = UINT32_MAX;
+}
+
+static void batch_result_merge(BatchResult *into, const BatchResult *from) {
+    into->battles += from->battles;
+    into->team_a_wins += from->team_a_wins;
+    into->team_b_wins += from->team_b_wins;
+    into->draws += from->draws;
+    into->timeouts += from->timeouts;
+    into->total_turns += from->total_turns;
+    into->total_survivors += from->total_survivors;
+    if (from->min_turns < into->min_turns) into->min_turns = from->min_turns;
+    if (from->max_turns > into->max_turns) into->max_turns = from->max_turns;
+    for (int i = 0; i < BATCH_SURVIVOR_BUCKETS; i++) {
+        into->survivor_histogram[i] += from->survivor_histogram[i];
+    }
+}
+
+int batch_run(const BatchConfig *config, BatchResult *result) {
+    uint32_t threads = config->threads ? config->threads : 1;
+    if (threads > config->battles && config->battles > 0) threads = config->battles;
+
+    BatchWorker *workers = calloc(threads, sizeof(BatchWorker));
+    pthread_t *handles = calloc(threads, sizeof(pthread_t));
+    if (!workers || !handles) {
+        free(workers);
+        free(handles);
+        return -1;
+    }
+
+    uint32_t next_battle = 0;
+    batch_result_init(result);
+    double start = wall_seconds();
+
+    for (uint32_t t = 0; t < threads; t++) {
+        workers[t].config = config;
+        workers[t].next_battle = &next_battle;
+        batch_result_init(&workers[t].partial);
+        workers[t].started = pthread_create(&handles[t], NULL, batch_worker_main, &workers[t]) == 0;
+        if (!workers[t].started) workers[t].failed = 1;
+    }
+
+    int status = 0;
+    for (uint32_t t = 0; t < threads; t++) {
+        if (workers[t].started) pthread_join(handles[t], NULL);
+        if (workers[t].failed) status = -1;
+        batch_result_merge(result, &workers[t].partial);
+    }
+
+    result->elapsed_seconds = wall_seconds() - start;
+    result->battles_per_second = result->elapsed_seconds > 0.0
+        ? result->battles / result->elapsed_seconds : 0.0;
+    if (result->battles == 0) result->min_turns = 0;
+
+    free(handles);
+    free(workers);
+    return status;
+}
+
+void batch_result_print(const BatchConfig *config, const BatchResult *result, FILE *out) {
+    const double n = result->battles ? (double)result->battles : 1.0;
+    const uint32_t decided = result->team_a_wins + result->team_b_wins;
+
+    fprintf(out, "\n=== BATCH RESULTS ===\n");
+    fprintf(out, "Battles: %u (%u vs %u units, seed %u, %u threads)\n",
+            result->battles, config->team_a_size, config->team_b_size, config->seed, config->threads);
+    fprintf(out, "Team A wins: %u (%.2f%%)\n", result->team_a_wins, 100.0 * result->team_a_wins / n);
+    fprintf(out, "Team B wins: %u (%.2f%%)\n", result->team_b_wins, 100.0 * result->team_b_wins / n);
+    fprintf(out, "Draws:       %u (%.2f%%, %u timeouts)\n", result->draws, 100.0 * result->draws / n, result->timeouts);
+    fprintf(out, "Turns: mean %.1f, min %u, max %u\n",
+            (double)result->total_turns / n, result->min_turns, result->max_turns);
+    fprintf(out, "Winner survivors: mean %.1f\n",
+            decided ? (double)result->total_survivors / decided : 0.0);
+    for (int i = 0; i < BATCH_SURVIVOR_BUCKETS; i++) {
+        fprintf(out, "  %3d-%3d%% of army: %u\n", i * 100 / BATCH_SURVIVOR_BUCKETS,
+                (i + 1) * 100 / BATCH_SURVIVOR_BUCKETS, result->survivor_histogram[i]);
+    }
+    fprintf(out, "Elapsed: %.3f s, %.2f battles/s\n", result->elapsed_seconds, result->battles_per_second);
+}
@@ -0,0 +1,44 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_BATCH_RUNNER_H
+#define SPARSE_STORAGE_LEARNING_BATCH_RUNNER_H
+
+#include <stdio.h>
+#include "world.h"
+
+#define BATCH_SURVIVOR_BUCKETS 10
+
+typedef struct {
+    uint32_t battles;           // number of independent battles to run
+    uint32_t team_a_size;
+    uint32_t team_b_size;
+    uint32_t seed;              // battle i is seeded from (seed, i), independent of thread count
+    uint32_t threads;           // worker threads, each with its own World
+    uint32_t max_turns;
+    TargetingMode targeting_mode;
+    ScheduleMode schedule_mode;
+} BatchConfig;
+
+typedef struct {
+    uint32_t battles;
+    uint32_t team_a_wins;
+    uint32_t team_b_wins;
+    uint32_t draws;             // mutual destruction or timeout
+    uint32_t timeouts;
+    uint64_t total_turns;
+    uint32_t min_turns;
+    uint32_t max_turns;
+    uint64_t total_survivors;   // winner's survivors, summed over decided battles
+    // Winner's survivors as a fraction of its army, in 10% buckets
+    uint32_t survivor_histogram[BATCH_SURVIVOR_BUCKETS];
+    double elapsed_seconds;     // wall clock for the whole batch
+    double battles_per_second;
+} BatchResult;
+
+// Run config->battles battles across config->threads workers; returns 0 on success
+int batch_run(const BatchConfig *config, BatchResult *result);
+void batch_result_print(const BatchConfig *config, const BatchResult *result, FILE *out);
+
+#endif //SPARSE_STORAGE_LEARNING_BATCH_RUNNER_H
@@ -0,0 +1,197 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "battle.h"
+#include "battle_metrics.h"
+#include "combat_system.h"
+#include "ecs_core/profiler.h"
+#include <time.h>
+
+const BattlePhase battle_phases[BATTLE_PHASE_COUNT] = {
+    // 1. Collect units whose cooldown expired (cooldown scheduling only)
+    {"schedule", combat_system_schedule, combat_system_schedule_step},
+    // 2. Target acquisition
+    {"target_acquisition", combat_system_target_acquisition, combat_system_target_acquisition_step},
+    // 3. Close in on targets (nearest targeting only)
+    {"movement", combat_system_movement, combat_system_movement_step},
+    // 4. Execute attacks
+    {"execute_attacks", combat_system_execute_attacks, combat_system_execute_attacks_step},
+    // 5. Process deaths
+    {"process_deaths", combat_system_process_deaths, combat_system_process_deaths_step},
+};
+
+static uint64_t step_clock_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void battle_run_turn(World *world) {
+    PROFILE_ZONE("turn");
+    if (!battle_metrics.enabled) {
+        for (int i = 0; i < BATTLE_PHASE_COUNT; i++) {
+            battle_phases[i].run(world);
+        }
+        battle_finish_turn(world);
+        return;
+    }
+
+    // Same turn, with every phase timed
+    const uint64_t turn_start = step_clock_ns();
+    uint64_t phase_start = turn_start;
+    for (int i = 0; i < BATTLE_PHASE_COUNT; i++) {
+        battle_phases[i].run(world);
+        const uint64_t phase_end = step_clock_ns();
+        battle_metrics_record_phase(i, phase_end - phase_start);
+        phase_start = phase_end;
+    }
+    battle_finish_turn(world);
+    metrics_record(battle_metrics.turn_seconds, step_clock_ns() - turn_start);
+}
+
+void battle_finish_turn(World *world) {
+    if (world->state_hash) {
+        const uint64_t hash = world_state_hash(world);
+        if (world->journal) {
+            journal_record(world->journal, world->turn_number, COMBAT_EVENT_STATE_HASH,
+                           world->combatant_storage->dense_count, (uint32_t)(hash >> 32), (int32_t)(uint32_t)hash);
+        }
+    }
+    // Observers always get the final state, however sparse the publishes
+    if (world->shared_view && (world->turn_number % world->shared_view_every == 0 ||
+                               combat_system_check_victory(world))) {
+        shared_view_publish(world->shared_view, world->combatant_storage, world->entity_manager, world->turn_number);
+    }
+    if (battle_metrics.enabled) battle_metrics_record_turn(world);
+    world->turn_number++;
+}
+
+// Whether the view's latest publish is of this turn
+static bool shared_view_holds_turn(const SharedView *view, uint32_t turn) {
+    const SharedViewHeader *header = view->header;
+    if (header->published == SHARED_VIEW_NONE) return false;
+    const SharedViewFrameHeader *frame =
+            (const SharedViewFrameHeader*)((const char*)header + header->buffer_offset[header->published]);
+    return frame->tick == turn;
+}
+
+void battle_end(World *world) {
+    // Stopped short of victory (by max_turns) on a turn battle_finish_turn
+    // didn't publish: observers still get where it stopped. Not partway into
+    // a turn (world_step), when the storage holds no whole turn's state
+    if (world->shared_view && world->battle_active && world->turn_number > 0 && world->turn_cursor.phase == 0 &&
+        !shared_view_holds_turn(world->shared_view, world->turn_number - 1)) {
+        shared_view_publish(world->shared_view, world->combatant_storage, world->entity_manager,
+                            world->turn_number - 1);
+    }
+    world->battle_active = false;
+}
+
+BattleResult battle_run(World *world, uint32_t max_turns) {
+    PROFILE_FUNCTION();
+    const uint64_t start = battle_metrics.enabled ? step_clock_ns() : 0;
+    world->battle_active = true;
+
+    while (world->battle_active && world->turn_number < max_turns) {
+        battle_run_turn(world);
+
+        if (combat_system_check_victory(world)) {
+            world->battle_active = false;
+        }
+    }
+
+    BattleResult result = battle_result(world);
+    battle_end(world);
+    if (battle_metrics.enabled) {
+        metrics_add(battle_metrics.battles, 1);
+        metrics_record(battle_metrics.battle_seconds, step_clock_ns() - start);
+    }
+    return result;
+}
+
+WorldStepResult world_step(World *world, uint64_t budget_ns) {
+    PROFILE_FUNCTION();
+    WorldStepResult result = {0};
+    TurnCursor *cursor = &world->turn_cursor;
+
+    // Slices start small in every phase and double or halve to take about
+    // an eighth of the budget, so cheap passes don't pay a clock read per
+    // few items and expensive ones (nearest-enemy queries) don't overrun
+    const uint64_t slice_target_ns = budget_ns / 8 ? budget_ns / 8 : 1;
+    uint32_t slice = WORLD_STEP_SLICE_MIN;
+    uint32_t slice_phase = cursor->phase;
+    uint64_t last_ns = 0;   // cost of the last unit of work, the guess for the next
+
+    const uint64_t start = step_clock_ns();
+    uint64_t now = start;
+
+    for (bool first = true;; first = false) {
+        // Between turns: same stopping rule as battle_run. A timed-out battle
+        // stays active, so battle_result reports it as such.
+        if (cursor->phase == 0) {
+            if (world->turn_number >= BATTLE_MAX_TURNS) {
+                result.finished = true;
+                break;
+            }
+            if (world->turn_number > 0 && combat_system_check_victory(world)) {
+                world->battle_active = false;
+                result.finished = true;
+                break;
+            }
+            world->battle_active = true;
+        }
+        // Stop before work that likely won't fit; always do some, so callers progress
+        if (!first && now - start + last_ns > budget_ns) break;
+
+        if (cursor->phase < BATTLE_PHASE_COUNT) {
+            if (cursor->phase != slice_phase) {
+                slice = WORLD_STEP_SLICE_MIN;
+                slice_phase = cursor->phase;
+            }
+            const bool done = battle_phases[cursor->phase].step(world, slice);
+            const uint64_t end = step_clock_ns();
+            last_ns = end - now;
+            now = end;
+
+            if (done) {
+                cursor->phase++;
+            } else if (last_ns < slice_target_ns / 2 && slice < WORLD_STEP_SLICE_MAX) {
+                slice *= 2;
+            } else if (last_ns > slice_target_ns && slice > WORLD_STEP_SLICE_MIN) {
+                slice /= 2;
+            }
+        } else {
+            battle_finish_turn(world);
+            cursor->phase = 0;
+            result.turns++;
+            const uint64_t end = step_clock_ns();
+            last_ns = end - now;
+            now = end;
+        }
+    }
+
+    result.used_ns = now - start;
+    result.mid_turn = cursor->phase != 0;
+    return result;
+}
+
+BattleResult battle_result(const World *world) {
+    BattleResult result;
+    result.turns = world->turn_number;
+    result.team_count = world->team_count;
+    result.timed_out = world->battle_active;
+
+    // A winner is the only team with units left
+    uint32_t teams_alive = 0;
+    result.winner = -1;
+    for (uint32_t t = 0; t < MAX_TEAMS; t++) {
+        result.survivors[t] = field_index_count(world->team_index, t);
+        if (result.survivors[t] > 0) {
+            teams_alive++;
+            result.winner = (int)t;
+        }
+    }
+    if (teams_alive != 1) result.winner = -1;
+    return result;
+}
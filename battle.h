@@ -0,0 +1,79 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_BATTLE_H
+#define SPARSE_STORAGE_LEARNING_BATTLE_H
+
+#include "world.h"
+
+#define BATTLE_MAX_TURNS 100000
+
+typedef struct {
+    int winner;                 // team_id of the last team standing (0 = Team A, 1 = Team B, ...),
+                                // -1 = draw or timeout
+    bool timed_out;             // hit max_turns before all but one side were wiped out
+    uint32_t turns;             // turns simulated
+    uint32_t team_count;        // teams that took part
+    uint32_t survivors[MAX_TEAMS]; // units alive per team_id
+} BattleResult;
+
+// One step of a turn; battle_run_turn runs battle_phases in order
+typedef void (*BattlePhaseFn)(World *world);
+
+// The same step in slices: does up to budget items and returns true once the
+// phase is complete, keeping its place in world->turn_cursor (see world_step)
+typedef bool (*BattlePhaseStepFn)(World *world, uint32_t budget);
+
+typedef struct {
+    const char *name;
+    BattlePhaseFn run;
+    BattlePhaseStepFn step;
+} BattlePhase;
+
+#define BATTLE_PHASE_COUNT 5
+extern const BattlePhase battle_phases[BATTLE_PHASE_COUNT];
+
+// Run one turn of every combat system and advance the turn counter
+void battle_run_turn(World *world);
+
+// End-of-turn bookkeeping after the phases: update the state hash (recording
+// it in the journal, if any), publish to the shared view, if any and due,
+// update the battle metrics, if enabled, and advance the turn counter
+void battle_finish_turn(World *world);
+
+// Run turns until at most one side has units left or max_turns is reached (no output)
+BattleResult battle_run(World *world, uint32_t max_turns);
+
+// Items a phase processes between world_step's clock checks; the slice
+// adapts between these bounds to the cost per item
+#define WORLD_STEP_SLICE_MIN 64
+#define WORLD_STEP_SLICE_MAX 1024
+
+typedef struct {
+    uint32_t turns;     // turns completed during this call
+    uint64_t used_ns;   // wall time spent in this call
+    bool mid_turn;      // stopped partway through a turn; the next call picks it up
+    bool finished;      // battle over: at most one side left or BATTLE_MAX_TURNS reached
+} WorldStepResult;
+
+// Advance the battle for up to about budget_ns and return. Phases run in
+// slices sized from their measured cost per item, and a call stops when the
+// next slice wouldn't fit, so time per call stays near the budget however
+// large the armies are; what can't be split (the schedule phase's wheel
+// advance, the end-of-turn hash update) can still overrun it. Each call does
+// at least one slice. The next call resumes exactly where this one stopped,
+// and the battle plays out exactly as battle_run would. Starts the battle on
+// the first call; don't mix with battle_run or battle_run_turn while a turn
+// is in progress.
+WorldStepResult world_step(World *world, uint64_t budget_ns);
+
+// Outcome of the world's battle as it stands (timed_out if it is still active)
+BattleResult battle_result(const World *world);
+
+// Stop the battle where it stands (after taking its battle_result): clears
+// battle_active and, if it stopped on a turn the shared view skipped,
+// publishes that turn, so observers always see the last one
+void battle_end(World *world);
+
+#endif //SPARSE_STORAGE_LEARNING_BATTLE_H
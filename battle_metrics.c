@@ -0,0 +1,69 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "battle_metrics.h"
+#include <pthread.h>
+
+BattleMetrics battle_metrics = {.enabled = false};
+
+// Label sets per phase, in battle_phases order
+static const char *const phase_labels[BATTLE_PHASE_COUNT] = {
+    "phase=\"schedule\"",
+    "phase=\"target_acquisition\"",
+    "phase=\"movement\"",
+    "phase=\"execute_attacks\"",
+    "phase=\"process_deaths\"",
+};
+
+// Label sets per team_id: Team A is "a" and so on
+static const char *const team_labels[MAX_TEAMS] = {
+    "team=\"a\"", "team=\"b\"", "team=\"c\"", "team=\"d\"", "team=\"e\"", "team=\"f\"", "team=\"g\"", "team=\"h\"",
+    "team=\"i\"", "team=\"j\"", "team=\"k\"", "team=\"l\"", "team=\"m\"", "team=\"n\"", "team=\"o\"", "team=\"p\"",
+};
+
+static pthread_once_t register_once = PTHREAD_ONCE_INIT;
+
+static void register_metrics(void) {
+    BattleMetrics *m = &battle_metrics;
+    m->battles = metrics_counter("ecs_battles_total", NULL, "Battles run to completion or timeout");
+    m->turns = metrics_counter("ecs_turns_total", NULL, "Turns simulated");
+    m->deaths = metrics_counter("ecs_deaths_total", NULL, "Units destroyed");
+    m->targets_acquired = metrics_counter("ecs_targets_acquired_total", NULL, "New targets picked");
+    // Teams' alive gauges are registered as teams first take part
+    for (int t = 0; t < MAX_TEAMS; t++) m->alive[t] = METRIC_INVALID;
+    m->battle_arena_used = metrics_gauge("ecs_arena_used_bytes", "arena=\"battle\"", "Bytes allocated from the arena");
+    m->persistent_arena_used = metrics_gauge("ecs_arena_used_bytes", "arena=\"persistent\"",
+                                             "Bytes allocated from the arena");
+    m->turn_deaths = metrics_histogram("ecs_turn_deaths", NULL, "Units destroyed per turn", 1.0);
+    m->turn_seconds = metrics_histogram("ecs_turn_duration_seconds", NULL, "Wall time per turn", 1e-9);
+    for (int p = 0; p < BATTLE_PHASE_COUNT; p++) {
+        m->phase_seconds[p] = metrics_histogram("ecs_phase_duration_seconds", phase_labels[p],
+                                                "Wall time per combat phase", 1e-9);
+    }
+    m->battle_seconds = metrics_histogram("ecs_battle_duration_seconds", NULL, "Wall time per battle", 1e-9);
+}
+
+void battle_metrics_enable(void) {
+    pthread_once(&register_once, register_metrics);
+    battle_metrics.enabled = true;
+}
+
+void battle_metrics_record_phase(int phase, uint64_t ns) {
+    metrics_record(battle_metrics.phase_seconds[phase], ns);
+}
+
+void battle_metrics_record_turn(const World *world) {
+    metrics_add(battle_metrics.turns, 1);
+    for (uint32_t t = 0; t < MAX_TEAMS; t++) {
+        MetricId alive = __atomic_load_n(&battle_metrics.alive[t], __ATOMIC_RELAXED);
+        if (t < world->team_count && alive == METRIC_INVALID) {
+            alive = metrics_gauge("ecs_units_alive", team_labels[t], "Units alive after the last turn");
+            __atomic_store_n(&battle_metrics.alive[t], alive, __ATOMIC_RELAXED);
+        }
+        // Teams an earlier, larger battle had read 0 rather than its last count
+        metrics_set(alive, t < world->team_count ? field_index_count(world->team_index, t) : 0);
+    }
+    metrics_set(battle_metrics.battle_arena_used, (int64_t)world->battle_arena->offset);
+    metrics_set(battle_metrics.persistent_arena_used, (int64_t)world->persistent_arena->offset);
+}
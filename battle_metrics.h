@@ -0,0 +1,54 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_BATTLE_METRICS_H
+#define SPARSE_STORAGE_LEARNING_BATTLE_METRICS_H
+
+#include "battle.h"
+#include "ecs_core/metrics.h"
+
+// Battle metrics in the process-wide registry (ecs_core/metrics.h). Off until
+// battle_metrics_enable; after that battle_run, battle_run_turn,
+// battle_finish_turn and the combat systems keep them up to date from
+// whichever threads run battles:
+//
+//   ecs_battles_total, ecs_turns_total, ecs_deaths_total,
+//   ecs_targets_acquired_total                      counters
+//   ecs_units_alive{team}, ecs_arena_used_bytes{arena}  gauges, last turn written
+//                                                   (a team's once it first plays)
+//   ecs_turn_deaths                                 histogram, deaths per turn
+//   ecs_turn_duration_seconds,
+//   ecs_phase_duration_seconds{phase},
+//   ecs_battle_duration_seconds                     histograms
+//
+// Turns played through world_step count everywhere except the turn and phase
+// durations, which only whole turns (battle_run_turn) record.
+
+typedef struct {
+    bool enabled;
+    MetricId battles;
+    MetricId turns;
+    MetricId deaths;
+    MetricId targets_acquired;
+    MetricId alive[MAX_TEAMS];
+    MetricId battle_arena_used;
+    MetricId persistent_arena_used;
+    MetricId turn_deaths;
+    MetricId turn_seconds;
+    MetricId phase_seconds[BATTLE_PHASE_COUNT];
+    MetricId battle_seconds;
+} BattleMetrics;
+
+extern BattleMetrics battle_metrics;
+
+// Register the battle metrics and start recording them; safe to call again
+void battle_metrics_enable(void);
+
+// Record how long one phase of a turn took (battle_run_turn does this itself)
+void battle_metrics_record_phase(int phase, uint64_t ns);
+
+// Record the end of a turn: turn counter, alive gauges and arena usage
+void battle_metrics_record_turn(const World *world);
+
+#endif //SPARSE_STORAGE_LEARNING_BATTLE_METRICS_H
@@ -0,0 +1,162 @@
+//
+// Created by jo on 10/19/2026.
+//
+// Death queue throughput with 1 to 32 producer threads: the concurrent
+// queue (per-thread producers reserving slot ranges) against one DeathQueue
+// behind a mutex, plus the cost of draining the concurrent queue into a
+// sorted batch. Every producer pushes a share of the same deaths, in blocks
+// the way parallel_for chunks hand them out, and the drained batch is checked
+// against the serial order.
+//
+// Usage: death_queue_bench [deaths]   (default 4000000)
+//
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ecs_core/death_queue.h"
+
+#define MAX_PRODUCERS 32
+#define BLOCK 4096  // deaths per block; producer t takes blocks t, t + P, ...
+
+typedef struct {
+    ConcurrentDeathQueue *queue;    // concurrent case
+    DeathQueue *locked_queue;       // mutex case
+    pthread_mutex_t *lock;
+    uint32_t deaths;
+    uint32_t producers;
+    uint32_t index;
+    int *ready;                     // atomic: producers waiting for the start
+    int *go;                        // atomic
+    uint64_t end_ns;
+} Producer;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Order key i stands for a unit dying at dense slot i; IDs are scrambled so
+// the sort has real work to do
+static Entity death_entity(uint32_t i) {
+    return (Entity){(i * 2654435761u) >> 8, i & 7};
+}
+
+static void wait_for_start(Producer *p) {
+    __atomic_fetch_add(p->ready, 1, __ATOMIC_ACQ_REL);
+    while (!__atomic_load_n(p->go, __ATOMIC_ACQUIRE)) sched_yield();
+}
+
+static void* produce_concurrent(void *arg) {
+    Producer *p = arg;
+    wait_for_start(p);
+
+    DeathQueueProducer producer;
+    death_queue_producer_init(&producer, p->queue);
+    for (uint32_t block = p->index * BLOCK; block < p->deaths; block += p->producers * BLOCK) {
+        const uint32_t end = block + BLOCK < p->deaths ? block + BLOCK : p->deaths;
+        for (uint32_t i = block; i < end; i++) death_queue_producer_push(&producer, death_entity(i), i);
+    }
+    death_queue_producer_flush(&producer);
+    p->end_ns = now_ns();
+    return NULL;
+}
+
+static void* produce_locked(void *arg) {
+    Producer *p = arg;
+    wait_for_start(p);
+
+    for (uint32_t block = p->index * BLOCK; block < p->deaths; block += p->producers * BLOCK) {
+        const uint32_t end = block + BLOCK < p->deaths ? block + BLOCK : p->deaths;
+        for (uint32_t i = block; i < end; i++) {
+            pthread_mutex_lock(p->lock);
+            death_queue_push(p->locked_queue, death_entity(i));
+            pthread_mutex_unlock(p->lock);
+        }
+    }
+    p->end_ns = now_ns();
+    return NULL;
+}
+
+// Start the producers together; returns ns from the start to the last one finishing
+static uint64_t run_producers(Producer *producers, uint32_t count, void *(*fn)(void*)) {
+    pthread_t threads[MAX_PRODUCERS];
+    int ready = 0, go = 0;
+    uint32_t started = 0;
+    for (uint32_t t = 0; t < count; t++) {
+        producers[t].ready = &ready;
+        producers[t].go = &go;
+        if (pthread_create(&threads[t], NULL, fn, &producers[t]) != 0) break;
+        started++;
+    }
+    while (__atomic_load_n(&ready, __ATOMIC_ACQUIRE) < (int)started) sched_yield();
+    const uint64_t start = now_ns();
+    __atomic_store_n(&go, 1, __ATOMIC_RELEASE);
+
+    uint64_t end = start;
+    for (uint32_t t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+        if (producers[t].end_ns > end) end = producers[t].end_ns;
+    }
+    return started == count ? end - start : 0;
+}
+
+int main(int argc, char **argv) {
+    uint32_t deaths = 4000000;
+    if (argc > 1) deaths = (uint32_t)strtoul(argv[1], NULL, 10);
+
+    ConcurrentDeathQueue queue;
+    DeathQueue drained, locked_queue;
+    if (deaths == 0 || concurrent_death_queue_init(&queue, deaths) != 0) {
+        fprintf(stderr, "cannot allocate a queue for %u deaths\n", deaths);
+        return 1;
+    }
+    death_queue_init(&drained, deaths);
+    death_queue_init(&locked_queue, deaths);
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+    printf("=== DEATH QUEUE PRODUCERS (%u deaths) ===\n", deaths);
+    printf("%9s %16s %16s %12s %10s\n", "producers", "concurrent_M/s", "mutex_M/s", "drain_ms", "ordered");
+
+    for (uint32_t count = 1; count <= MAX_PRODUCERS; count *= 2) {
+        Producer producers[MAX_PRODUCERS];
+        for (uint32_t t = 0; t < count; t++) {
+            producers[t] = (Producer){&queue, &locked_queue, &lock, deaths, count, t, NULL, NULL, 0};
+        }
+
+        const uint64_t concurrent_ns = run_producers(producers, count, produce_concurrent);
+
+        death_queue_clear(&drained);
+        const uint64_t drain_start = now_ns();
+        concurrent_death_queue_drain(&queue, &drained);
+        const uint64_t drain_ns = now_ns() - drain_start;
+
+        // The batch must come out in serial order whatever the interleaving
+        bool ordered = drained.count == deaths;
+        for (uint32_t i = 0; ordered && i < deaths; i++) {
+            const Entity expected = death_entity(i);
+            ordered = drained.entities[i].id == expected.id && drained.entities[i].generation == expected.generation;
+        }
+
+        death_queue_clear(&locked_queue);
+        const uint64_t locked_ns = run_producers(producers, count, produce_locked);
+
+        if (concurrent_ns == 0 || locked_ns == 0) {
+            fprintf(stderr, "cannot start %u producer threads\n", count);
+            break;
+        }
+        printf("%9u %16.1f %16.1f %12.2f %10s\n", count, deaths / (concurrent_ns / 1e3), deaths / (locked_ns / 1e3),
+               drain_ns / 1e6, ordered ? "yes" : "NO");
+    }
+
+    concurrent_death_queue_free(&queue);
+    death_queue_free(&drained);
+    death_queue_free(&locked_queue);
+    return 0;
+}
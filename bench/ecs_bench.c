@@ -0,0 +1,692 @@
+//
+// Created by jo on 10/19/2026.
+//
+// Non-interactive battle benchmark. Runs warm-up plus measured battles on one
+// World and prints JSON with min / median / p99 wall-clock and thread CPU time
+// for reset, spawn, every combat phase and the whole battle, so runs from
+// different builds can be diffed. CPU time is the benchmark thread's own, so
+// with --threads > 1 spawn helpers show up in wall time only.
+//
+// Usage: ecs_bench [--army A B | --teams N SIZE] [--seed S] [--reps N] [--warmup N]
+//                  [--threads T] [--nearest] [--cooldown]
+//                  [--max-turns N] [--out FILE] [--trace FILE] [--perf]
+//                  [--snapshot FILE] [--scenario FILE] [--journal FILE] [--hash]
+//                  [--tick-budget NS] [--shared-view NAME [--view-every N]]
+//                  [--metrics] [--metrics-listen ADDR]
+//
+// --teams plays a free-for-all of N teams (up to MAX_TEAMS) of SIZE units
+// each instead of the two armies of --army; the JSON's "team_wins" counts
+// wins per team either way.
+//
+// --snapshot spawns the armies once, saves them to FILE, and then loads the
+// snapshot in place of spawn_army on every iteration, so "spawn" measures
+// world_snapshot_load.
+//
+// --scenario loads the armies from a scenario file (see scenario.h and
+// tools/scenario_gen.c) on every iteration instead of spawning them; --army
+// is ignored and "spawn" measures scenario_load. The JSON gets the loader's
+// best units and bytes per second.
+//
+// --journal records every battle's combat events to FILE (see
+// tools/journal_dump.c); compare against a run without it for the overhead.
+//
+// --hash keeps the incremental state hash up to date every turn and prints
+// the final one, so two builds can be checked for identical battles.
+//
+// --tick-budget plays every battle through world_step calls of NS each, the
+// way a server loop with a per-tick latency budget would, and adds the
+// distribution of time per call (and how many overran) to the JSON. Phases
+// aren't timed individually in this mode, and --max-turns is checked between
+// calls, so a battle can stop partway into a later turn.
+//
+// --shared-view publishes the battle to POSIX shared memory NAME at the end
+// of every turn, or every N turns with --view-every (see
+// ecs_core/shared_view.h; tools/view_watch.c reads it), and adds the publish
+// count, bytes copied and time spent publishing to the JSON. Publishing also
+// evicts simulation data from cache, so compare battle times against a run
+// without it for the full cost.
+//
+// --metrics records the battle metrics (battle_metrics.h) while battles run
+// and adds a "registry" section to the JSON: their totals (warm-up
+// included), turn-time quantiles from the registry's histogram and the cost
+// of one Prometheus scrape. Compare battle times against a run without it for
+// the overhead. --metrics-listen also serves them on ADDR (see
+// metrics_exporter_start) while the benchmark runs.
+//
+// --perf reads hardware counters (perf_event_open) around every measured
+// section and adds per-phase IPC and misses per entity to the JSON. Counter
+// reads are syscalls, so timings taken with --perf run slightly high.
+//
+// --trace writes the last measured battle as Chrome trace JSON; it needs a
+// build with -DECS_ENABLE_PROFILER=ON.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "world.h"
+#include "entity_factory.h"
+#include "combat_system.h"
+#include "battle.h"
+#include "battle_metrics.h"
+#include "world_snapshot.h"
+#include "scenario.h"
+#include "ecs_core/profiler.h"
+#include "ecs_core/perf_counters.h"
+
+// reset, spawn, battle, then one per combat phase
+#define METRIC_RESET 0
+#define METRIC_SPAWN 1
+#define METRIC_BATTLE 2
+#define METRIC_PHASE_BASE 3
+#define METRIC_COUNT (METRIC_PHASE_BASE + BATTLE_PHASE_COUNT)
+
+typedef struct {
+    uint32_t team_a_size;
+    uint32_t team_b_size;
+    uint32_t teams;       // --teams: this many armies of team_size; 0 for --army
+    uint32_t team_size;
+    uint64_t seed;
+    uint32_t reps;
+    uint32_t warmup;
+    uint32_t threads;
+    uint32_t max_turns;
+    TargetingMode targeting_mode;
+    ScheduleMode schedule_mode;
+    const char *out_path;
+    const char *trace_path;
+    const char *snapshot_path;
+    const char *scenario_path;
+    const char *journal_path;
+    bool hash;
+    bool perf;
+    uint64_t tick_budget_ns;  // 0: run whole turns (run_timed_battle)
+    const char *shared_view_name;
+    uint32_t view_every;
+    bool metrics;
+    const char *metrics_address;
+} BenchConfig;
+
+// Time per world_step call over the measured battles (--tick-budget)
+typedef struct {
+    uint64_t *used_ns;
+    uint32_t count;
+    uint32_t capacity;
+    uint64_t turns;
+} TickLog;
+
+typedef struct {
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+    uint64_t counters[PERF_COUNTER_COUNT]; // hardware counts, only with --perf
+} Sample;
+
+// Open hardware counters, or NULL when --perf is off or they're unavailable
+static PerfCounters *bench_perf;
+static bool perf_valid[PERF_COUNTER_COUNT];
+
+static uint64_t clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static Sample sample_now(void) {
+    Sample sample;
+    memset(&sample, 0, sizeof(sample));
+
+    if (bench_perf) {
+        PerfSample perf;
+        perf_counters_read(bench_perf, &perf);
+        memcpy(sample.counters, perf.values, sizeof(sample.counters));
+    }
+
+    sample.wall_ns = clock_ns(CLOCK_MONOTONIC);
+    sample.cpu_ns = clock_ns(CLOCK_THREAD_CPUTIME_ID);
+    return sample;
+}
+
+static void sample_add_since(Sample *into, Sample start) {
+    const Sample end = sample_now();
+    into->wall_ns += end.wall_ns - start.wall_ns;
+    into->cpu_ns += end.cpu_ns - start.cpu_ns;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        into->counters[c] += end.counters[c] - start.counters[c];
+    }
+}
+
+static const char* metric_name(int metric) {
+    switch (metric) {
+        case METRIC_RESET: return "reset";
+        case METRIC_SPAWN: return "spawn";
+        case METRIC_BATTLE: return "battle";
+        default: return battle_phases[metric - METRIC_PHASE_BASE].name;
+    }
+}
+
+// Same loop as battle_run, with every phase timed. entities[] accumulates the
+// units alive at the start of each turn, the divisor for misses per entity.
+// With metrics enabled the phase timings also go to the metrics registry, as
+// battle_run_turn would record them.
+static BattleResult run_timed_battle(World *world, uint32_t max_turns, Sample *samples, uint64_t *entities) {
+    world->battle_active = true;
+
+    const Sample battle_start = sample_now();
+    while (world->battle_active && world->turn_number < max_turns) {
+        const uint32_t alive = world->combatant_storage->dense_count;
+        entities[METRIC_BATTLE] += alive;
+        uint64_t turn_ns = 0;
+        for (int p = 0; p < BATTLE_PHASE_COUNT; p++) {
+            entities[METRIC_PHASE_BASE + p] += alive;
+            const uint64_t before = samples[METRIC_PHASE_BASE + p].wall_ns;
+            const Sample start = sample_now();
+            battle_phases[p].run(world);
+            sample_add_since(&samples[METRIC_PHASE_BASE + p], start);
+            if (battle_metrics.enabled) {
+                const uint64_t phase_ns = samples[METRIC_PHASE_BASE + p].wall_ns - before;
+                battle_metrics_record_phase(p, phase_ns);
+                turn_ns += phase_ns;
+            }
+        }
+        battle_finish_turn(world);
+        if (battle_metrics.enabled) metrics_record(battle_metrics.turn_seconds, turn_ns);
+
+        if (combat_system_check_victory(world)) {
+            world->battle_active = false;
+        }
+    }
+    sample_add_since(&samples[METRIC_BATTLE], battle_start);
+    if (battle_metrics.enabled) {
+        metrics_add(battle_metrics.battles, 1);
+        metrics_record(battle_metrics.battle_seconds, samples[METRIC_BATTLE].wall_ns);
+    }
+
+    BattleResult result = battle_result(world);
+    battle_end(world);
+    return result;
+}
+
+// The same battle through world_step, budget_ns per call; tick times go to
+// log when it is set
+static BattleResult run_stepped_battle(World *world, uint32_t max_turns, uint64_t budget_ns,
+                                       Sample *samples, TickLog *log) {
+    const Sample battle_start = sample_now();
+    while (world->turn_number < max_turns) {
+        const WorldStepResult step = world_step(world, budget_ns);
+        if (log) {
+            if (log->count == log->capacity) {
+                const uint32_t capacity = log->capacity ? log->capacity * 2 : 4096;
+                uint64_t *grown = realloc(log->used_ns, sizeof(uint64_t) * capacity);
+                if (!grown) break;
+                log->used_ns = grown;
+                log->capacity = capacity;
+            }
+            log->used_ns[log->count++] = step.used_ns;
+            log->turns += step.turns;
+        }
+        if (step.finished) break;
+    }
+    sample_add_since(&samples[METRIC_BATTLE], battle_start);
+
+    BattleResult result = battle_result(world);
+    battle_end(world);
+    return result;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t*)a;
+    const uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile over a sorted array
+static uint64_t percentile(const uint64_t *sorted, uint32_t n, double p) {
+    uint32_t rank = (uint32_t)(p * n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+static void print_stats(FILE *out, const char *key, uint64_t *values, uint32_t n) {
+    qsort(values, n, sizeof(uint64_t), compare_u64);
+    fprintf(out, "\"%s\": {\"min\": %llu, \"median\": %llu, \"p99\": %llu}", key,
+            (unsigned long long)values[0],
+            (unsigned long long)percentile(values, n, 0.5),
+            (unsigned long long)percentile(values, n, 0.99));
+}
+
+static int parse_args(int argc, char **argv, BenchConfig *config) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--army") == 0 && i + 2 < argc) {
+            config->team_a_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+            config->team_b_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--teams") == 0 && i + 2 < argc) {
+            config->teams = (uint32_t)strtoul(argv[++i], NULL, 10);
+            config->team_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+            if (config->teams < 2 || config->teams > MAX_TEAMS || config->team_size == 0) {
+                fprintf(stderr, "--teams needs 2 to %d teams of at least one unit\n", MAX_TEAMS);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) {
+            config->reps = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            config->warmup = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config->threads = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-turns") == 0 && i + 1 < argc) {
+            config->max_turns = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            config->out_path = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            config->trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            config->snapshot_path = argv[++i];
+        } else if (strcmp(argv[i], "--scenario") == 0 && i + 1 < argc) {
+            config->scenario_path = argv[++i];
+        } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            config->journal_path = argv[++i];
+        } else if (strcmp(argv[i], "--tick-budget") == 0 && i + 1 < argc) {
+            config->tick_budget_ns = strtoull(argv[++i], NULL, 10);
+            if (config->tick_budget_ns == 0) {
+                fprintf(stderr, "--tick-budget must be positive\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--shared-view") == 0 && i + 1 < argc) {
+            config->shared_view_name = argv[++i];
+        } else if (strcmp(argv[i], "--view-every") == 0 && i + 1 < argc) {
+            config->view_every = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--metrics-listen") == 0 && i + 1 < argc) {
+            config->metrics_address = argv[++i];
+            config->metrics = true;
+        } else if (strcmp(argv[i], "--metrics") == 0) {
+            config->metrics = true;
+        } else if (strcmp(argv[i], "--hash") == 0) {
+            config->hash = true;
+        } else if (strcmp(argv[i], "--perf") == 0) {
+            config->perf = true;
+        } else if (strcmp(argv[i], "--nearest") == 0) {
+            config->targeting_mode = TARGETING_NEAREST;
+        } else if (strcmp(argv[i], "--cooldown") == 0) {
+            config->schedule_mode = SCHEDULE_COOLDOWN;
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    if (config->reps == 0 || config->team_a_size == 0 || config->team_b_size == 0) {
+        fprintf(stderr, "--reps and both army sizes must be positive\n");
+        return -1;
+    }
+    return 0;
+}
+
+// The configured armies: --teams, or Team A and Team B of --army
+static void spawn_armies(World *world, const BenchConfig *config) {
+    if (config->teams > 0) {
+        for (uint32_t t = 0; t < config->teams; t++) spawn_army(world, (uint8_t)t, config->team_size);
+        return;
+    }
+    spawn_army(world, 0, config->team_a_size);
+    spawn_army(world, 1, config->team_b_size);
+}
+
+int main(int argc, char **argv) {
+    BenchConfig config = {
+        .team_a_size = 10000,
+        .team_b_size = 10000,
+        .teams = 0,
+        .team_size = 0,
+        .seed = 1,
+        .reps = 10,
+        .warmup = 2,
+        .threads = 1,
+        .max_turns = BATTLE_MAX_TURNS,
+        .targeting_mode = TARGETING_WEAKEST,
+        .schedule_mode = SCHEDULE_EVERY_TURN,
+        .out_path = NULL,
+        .trace_path = NULL,
+        .snapshot_path = NULL,
+        .scenario_path = NULL,
+        .journal_path = NULL,
+        .hash = false,
+        .perf = false,
+        .tick_budget_ns = 0,
+        .shared_view_name = NULL,
+        .view_every = 1,
+        .metrics = false,
+        .metrics_address = NULL,
+    };
+    if (parse_args(argc, argv, &config) != 0) {
+        return 2;
+    }
+
+    size_t capacity = config.teams > 0 ? (size_t)config.teams * config.team_size
+                                       : (size_t)config.team_a_size + config.team_b_size;
+    if (config.scenario_path) {
+        if (config.snapshot_path) {
+            fprintf(stderr, "--scenario and --snapshot can't be combined\n");
+            return 2;
+        }
+        if ((capacity = scenario_unit_count(config.scenario_path)) == 0) {
+            fprintf(stderr, "cannot read scenario %s\n", config.scenario_path);
+            return 1;
+        }
+    }
+
+    World *world = world_create(capacity);
+    if (!world) {
+        fprintf(stderr, "world_create failed\n");
+        return 1;
+    }
+    world->targeting_mode = config.targeting_mode;
+    world->schedule_mode = config.schedule_mode;
+    world->worker_threads = config.threads;
+    if (config.teams > 0) world->team_count = config.teams;
+    if (config.hash) world_enable_state_hash(world);
+    if (config.metrics) battle_metrics_enable();
+    if (config.metrics_address && metrics_exporter_start(config.metrics_address) != 0) {
+        fprintf(stderr, "cannot serve metrics on %s\n", config.metrics_address);
+        return 1;
+    }
+    if (config.shared_view_name && world_share_view(world, config.shared_view_name, config.view_every) != 0) {
+        fprintf(stderr, "cannot create shared view %s\n", config.shared_view_name);
+        return 1;
+    }
+
+    Journal *journal = NULL;
+    if (config.journal_path) {
+        if (!(journal = journal_open(config.journal_path, 1))) {
+            fprintf(stderr, "cannot open journal %s\n", config.journal_path);
+            return 1;
+        }
+        world->journal = journal_ring(journal, 0);
+    }
+
+    // One column per metric, wall and CPU separately, plus turns
+    uint64_t *wall = calloc((size_t)METRIC_COUNT * config.reps, sizeof(uint64_t));
+    uint64_t *cpu = calloc((size_t)METRIC_COUNT * config.reps, sizeof(uint64_t));
+    uint64_t *turns = calloc(config.reps, sizeof(uint64_t));
+    if (!wall || !cpu || !turns) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    uint32_t team_wins[MAX_TEAMS] = {0}, draws = 0;
+    uint64_t final_hash = 0;
+    TickLog ticks = {0};
+    uint64_t view_publishes = 0, view_bytes = 0, view_ns = 0;
+
+    // Hardware counters summed over measured reps, with the entity counts to divide by
+    PerfCounters perf;
+    uint64_t counter_totals[METRIC_COUNT][PERF_COUNTER_COUNT];
+    uint64_t entity_totals[METRIC_COUNT];
+    memset(counter_totals, 0, sizeof(counter_totals));
+    memset(entity_totals, 0, sizeof(entity_totals));
+    if (config.perf) {
+        if (perf_counters_open(&perf) > 0) {
+            PerfSample probe;
+            perf_counters_read(&perf, &probe);
+            memcpy(perf_valid, probe.valid, sizeof(perf_valid));
+            bench_perf = &perf;
+        } else {
+            fprintf(stderr, "warning: hardware counters unavailable, continuing without --perf\n");
+        }
+    }
+    const uint64_t army_total = capacity;
+    ScenarioStats scenario_best = {0};
+
+    if (config.snapshot_path) {
+        world_seed(world, config.seed);
+        spawn_armies(world, &config);
+        if (world_snapshot_save(world, config.snapshot_path) != 0) {
+            fprintf(stderr, "cannot write snapshot %s\n", config.snapshot_path);
+            return 1;
+        }
+    }
+
+    // Every iteration replays the same seed, so measured reps are identical battles
+    for (uint32_t iter = 0; iter < config.warmup + config.reps; iter++) {
+        Sample samples[METRIC_COUNT];
+        uint64_t entities[METRIC_COUNT];
+        memset(samples, 0, sizeof(samples));
+        memset(entities, 0, sizeof(entities));
+        entities[METRIC_RESET] = army_total;
+        entities[METRIC_SPAWN] = army_total;
+
+        // Keep only the latest battle in the trace
+        profiler_reset();
+
+        Sample start = sample_now();
+        world_reset_battle(world);
+        sample_add_since(&samples[METRIC_RESET], start);
+
+        world_seed(world, config.seed);
+        start = sample_now();
+        if (config.snapshot_path) {
+            if (world_snapshot_load(world, config.snapshot_path) != 0) {
+                fprintf(stderr, "cannot load snapshot %s\n", config.snapshot_path);
+                return 1;
+            }
+        } else if (config.scenario_path) {
+            ScenarioStats stats;
+            if (scenario_load(world, config.scenario_path, &stats) != 0) {
+                fprintf(stderr, "cannot load scenario %s (line %llu)\n", config.scenario_path,
+                        (unsigned long long)stats.error_line);
+                return 1;
+            }
+            if (scenario_best.load_ns == 0 || stats.load_ns < scenario_best.load_ns) scenario_best = stats;
+            config.team_a_size = world->team_spawned[0];
+            config.team_b_size = world->team_spawned[1];
+        } else {
+            spawn_armies(world, &config);
+        }
+        sample_add_since(&samples[METRIC_SPAWN], start);
+
+        SharedView *view = world->shared_view;
+        const uint64_t view_count_before = view ? view->header->publish_count : 0;
+        const uint64_t view_bytes_before = view ? view->bytes : 0;
+        const uint64_t view_ns_before = view ? view->publish_ns : 0;
+
+        BattleResult result = config.tick_budget_ns
+            ? run_stepped_battle(world, config.max_turns, config.tick_budget_ns, samples,
+                                 iter < config.warmup ? NULL : &ticks)
+            : run_timed_battle(world, config.max_turns, samples, entities);
+
+        if (iter < config.warmup) continue;
+
+        const uint32_t rep = iter - config.warmup;
+        for (int m = 0; m < METRIC_COUNT; m++) {
+            wall[(size_t)m * config.reps + rep] = samples[m].wall_ns;
+            cpu[(size_t)m * config.reps + rep] = samples[m].cpu_ns;
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                counter_totals[m][c] += samples[m].counters[c];
+            }
+            entity_totals[m] += entities[m];
+        }
+        turns[rep] = result.turns;
+        if (view) {
+            view_publishes += view->header->publish_count - view_count_before;
+            view_bytes += view->bytes - view_bytes_before;
+            view_ns += view->publish_ns - view_ns_before;
+        }
+        final_hash = world_state_hash(world);
+        if (result.winner >= 0) team_wins[result.winner]++;
+        else draws++;
+    }
+
+    uint64_t journal_bytes = 0;
+    int journal_rc = 0;
+    if (journal) {
+        world->journal = NULL;
+        journal_rc = journal_close(journal);
+        FILE *jf = fopen(config.journal_path, "rb");
+        if (jf && fseek(jf, 0, SEEK_END) == 0) journal_bytes = (uint64_t)ftell(jf);
+        if (jf) fclose(jf);
+    }
+
+    if (config.trace_path) {
+#ifndef ECS_PROFILE
+        fprintf(stderr, "warning: built without ECS_ENABLE_PROFILER, %s will be empty\n", config.trace_path);
+#endif
+        FILE *trace = fopen(config.trace_path, "w");
+        if (!trace || profiler_write_chrome_trace(trace) != 0) {
+            fprintf(stderr, "cannot write %s\n", config.trace_path);
+        }
+        if (trace) fclose(trace);
+    }
+
+    FILE *out = stdout;
+    if (config.out_path && !(out = fopen(config.out_path, "w"))) {
+        fprintf(stderr, "cannot open %s\n", config.out_path);
+        return 1;
+    }
+
+    fprintf(out, "{\n");
+    fprintf(out, "  \"config\": {\"team_a\": %u, \"team_b\": %u, \"teams\": %u, \"seed\": %llu, \"reps\": %u, "
+                 "\"warmup\": %u, \"threads\": %u, \"max_turns\": %u, \"targeting\": \"%s\", \"schedule\": \"%s\", \"spawn_from\": \"%s\"},\n",
+            config.teams > 0 ? config.team_size : config.team_a_size,
+            config.teams > 0 ? config.team_size : config.team_b_size,
+            world->team_count, (unsigned long long)config.seed, config.reps,
+            config.warmup, config.threads, config.max_turns,
+            config.targeting_mode == TARGETING_NEAREST ? "nearest" : "weakest",
+            config.schedule_mode == SCHEDULE_COOLDOWN ? "cooldown" : "every_turn",
+            config.snapshot_path ? "snapshot" : config.scenario_path ? "scenario" : "spawn_army");
+    fprintf(out, "  \"outcome\": {\"team_a_wins\": %u, \"team_b_wins\": %u, \"draws\": %u, \"team_wins\": [",
+            team_wins[0], team_wins[1], draws);
+    for (uint32_t t = 0; t < world->team_count; t++) {
+        fprintf(out, "%s%u", t > 0 ? ", " : "", team_wins[t]);
+    }
+    fprintf(out, "], ");
+    print_stats(out, "turns", turns, config.reps);
+    if (config.hash) fprintf(out, ", \"state_hash\": \"%016llx\"", (unsigned long long)final_hash);
+    fprintf(out, "},\n");
+
+    fprintf(out, "  \"metrics\": {\n");
+    for (int m = 0; m < METRIC_COUNT; m++) {
+        fprintf(out, "    \"%s\": {", metric_name(m));
+        print_stats(out, "wall_ns", &wall[(size_t)m * config.reps], config.reps);
+        fprintf(out, ", ");
+        print_stats(out, "cpu_ns", &cpu[(size_t)m * config.reps], config.reps);
+        fprintf(out, "}%s\n", m + 1 < METRIC_COUNT ? "," : "");
+    }
+    fprintf(out, "  }");
+
+    if (config.perf) {
+        fprintf(out, ",\n  \"perf\": {\"available\": %s", bench_perf ? "true" : "false");
+        if (bench_perf) {
+            fprintf(out, ", \"phases\": {\n");
+            for (int m = 0; m < METRIC_COUNT; m++) {
+                const uint64_t *totals = counter_totals[m];
+                const double per_entity = entity_totals[m] ? 1.0 / (double)entity_totals[m] : 0.0;
+
+                fprintf(out, "    \"%s\": {\"entities\": %llu", metric_name(m),
+                        (unsigned long long)(entity_totals[m] / config.reps));
+                if (perf_valid[PERF_COUNTER_CYCLES] && perf_valid[PERF_COUNTER_INSTRUCTIONS]) {
+                    fprintf(out, ", \"ipc\": %.3f", totals[PERF_COUNTER_CYCLES]
+                            ? (double)totals[PERF_COUNTER_INSTRUCTIONS] / (double)totals[PERF_COUNTER_CYCLES] : 0.0);
+                }
+                for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                    if (!perf_valid[c]) continue;
+                    fprintf(out, ", \"%s\": %llu, \"%s_per_entity\": %.4f",
+                            perf_counter_name((PerfCounterId)c),
+                            (unsigned long long)(totals[c] / config.reps),
+                            perf_counter_name((PerfCounterId)c), (double)totals[c] * per_entity);
+                }
+                fprintf(out, "}%s\n", m + 1 < METRIC_COUNT ? "," : "");
+            }
+            fprintf(out, "  }");
+        }
+        fprintf(out, "}");
+    }
+
+    if (config.scenario_path) {
+        const double seconds = scenario_best.load_ns / 1e9;
+        fprintf(out, ",\n  \"scenario\": {\"units\": %u, \"types\": %u, \"bytes\": %llu, \"best_load_ns\": %llu, "
+                     "\"units_per_sec\": %.0f, \"bytes_per_sec\": %.0f}",
+                scenario_best.units, scenario_best.types, (unsigned long long)scenario_best.bytes,
+                (unsigned long long)scenario_best.load_ns,
+                seconds > 0 ? scenario_best.units / seconds : 0.0, seconds > 0 ? scenario_best.bytes / seconds : 0.0);
+    }
+
+    if (config.tick_budget_ns && ticks.count > 0) {
+        uint32_t over_budget = 0;
+        for (uint32_t t = 0; t < ticks.count; t++) {
+            if (ticks.used_ns[t] > config.tick_budget_ns) over_budget++;
+        }
+        fprintf(out, ",\n  \"ticks\": {\"budget_ns\": %llu, \"count\": %u, \"turns_per_tick\": %.3f, \"over_budget\": %u, ",
+                (unsigned long long)config.tick_budget_ns, ticks.count, (double)ticks.turns / ticks.count, over_budget);
+        print_stats(out, "used_ns", ticks.used_ns, ticks.count);
+        fprintf(out, ", \"max_ns\": %llu}", (unsigned long long)ticks.used_ns[ticks.count - 1]);
+    }
+
+    if (journal) {
+        fprintf(out, ",\n  \"journal\": {\"bytes\": %llu, \"ok\": %s}",
+                (unsigned long long)journal_bytes, journal_rc == 0 ? "true" : "false");
+    }
+
+    if (world->shared_view) {
+        uint64_t battle_ns = 0;
+        for (uint32_t rep = 0; rep < config.reps; rep++) battle_ns += wall[(size_t)METRIC_BATTLE * config.reps + rep];
+        fprintf(out, ",\n  \"shared_view\": {\"name\": \"%s\", \"every\": %u, \"publishes\": %llu, \"bytes_per_publish\": %.0f, "
+                     "\"publish_ns_mean\": %.0f, \"battle_share\": %.4f}",
+                config.shared_view_name, world->shared_view_every, (unsigned long long)view_publishes,
+                view_publishes ? (double)view_bytes / view_publishes : 0.0,
+                view_publishes ? (double)view_ns / view_publishes : 0.0,
+                battle_ns ? (double)view_ns / battle_ns : 0.0);
+    }
+
+    if (config.metrics) {
+        // One scrape's worth of text, timed
+        char *text = NULL;
+        size_t text_len = 0;
+        FILE *scrape = open_memstream(&text, &text_len);
+        const uint64_t scrape_start = clock_ns(CLOCK_MONOTONIC);
+        if (scrape) {
+            metrics_write_prometheus(scrape);
+            fclose(scrape);
+        }
+        const uint64_t scrape_ns = clock_ns(CLOCK_MONOTONIC) - scrape_start;
+        free(text);
+
+        fprintf(out, ",\n  \"registry\": {\"battles\": %llu, \"turns\": %llu, \"deaths\": %llu, "
+                     "\"targets_acquired\": %llu, \"turn_ns\": {\"p50\": %llu, \"p99\": %llu, \"max\": %llu}, "
+                     "\"scrape_bytes\": %zu, \"scrape_ns\": %llu}",
+                (unsigned long long)metrics_counter_total(battle_metrics.battles),
+                (unsigned long long)metrics_counter_total(battle_metrics.turns),
+                (unsigned long long)metrics_counter_total(battle_metrics.deaths),
+                (unsigned long long)metrics_counter_total(battle_metrics.targets_acquired),
+                (unsigned long long)metrics_histogram_quantile(battle_metrics.turn_seconds, 0.5),
+                (unsigned long long)metrics_histogram_quantile(battle_metrics.turn_seconds, 0.99),
+                (unsigned long long)metrics_histogram_quantile(battle_metrics.turn_seconds, 1.0),
+                text_len, (unsigned long long)scrape_ns);
+    }
+
+    // Footprint after the last battle; high-water marks cover that battle
+    WorldMemoryReport memory;
+    world_memory_report(world, &memory);
+    fprintf(out, ",\n  \"memory\": {\n");
+    for (size_t i = 0; i < memory.count; i++) {
+        const MemoryRegion *r = &memory.regions[i];
+        fprintf(out, "    \"%s\": {\"reserved\": %zu, \"committed\": %zu, \"used\": %zu, "
+                     "\"high_water\": %zu, \"nested\": %s}%s\n",
+                r->name, r->reserved, r->committed, r->used, r->high_water,
+                r->nested ? "true" : "false", i + 1 < memory.count ? "," : "");
+    }
+    fprintf(out, "  }\n}\n");
+
+    if (out != stdout) fclose(out);
+    if (bench_perf) perf_counters_close(bench_perf);
+    free(wall);
+    free(cpu);
+    free(turns);
+    free(ticks.used_ns);
+    metrics_exporter_stop();
+    world_destroy(world);
+    return 0;
+}
@@ -0,0 +1,484 @@
+//
+// Created by jo on 10/19/2026.
+//
+// ns/op for the ecs_core building blocks at 10k .. max_entities entities:
+// arena allocation and checkpoints, entity create/destroy, sparse set
+// add/get/remove with sequential vs random IDs and hit vs miss lookups,
+// create/destroy churn at several fill ratios, batched storage removal,
+// field index maintenance and lookups, death queue pushes and metrics
+// registry updates.
+//
+// Usage: ecs_microbench [max_entities]   (default 10000000)
+//
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "ecs_core/arena.h"
+#include "ecs_core/entity_manager.h"
+#include "ecs_core/sparse_set_storage.h"
+#include "ecs_core/storage_manager.h"
+#include "ecs_core/field_index.h"
+#include "ecs_core/death_queue.h"
+#include "ecs_core/rng.h"
+#include "ecs_core/metrics.h"
+
+#define COMPONENT_SIZE 16
+#define MIN_OPS_PER_CASE 2000000ull // small sizes repeat until at least this many ops are timed
+
+typedef struct {
+    uint8_t bytes[COMPONENT_SIZE];
+} BenchComponent;
+
+// Keeps results observable so loops aren't optimized away
+static volatile uint64_t sink;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t reps_for(uint32_t n) {
+    const uint64_t reps = (MIN_OPS_PER_CASE + n - 1) / n;
+    return reps > 0 ? (uint32_t)reps : 1;
+}
+
+static void report(uint32_t n, const char *op, const char *pattern, uint64_t elapsed_ns, uint64_t ops) {
+    printf("%10u %-28s %-16s %10.2f\n", n, op, pattern, (double)elapsed_ns / (double)ops);
+}
+
+static void sequential_ids(uint32_t *ids, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) ids[i] = i;
+}
+
+static void random_ids(uint32_t *ids, uint32_t n, Rng *rng) {
+    sequential_ids(ids, n);
+    for (uint32_t i = n - 1; i > 0; i--) {
+        const uint32_t j = rng_range(rng, i + 1);
+        const uint32_t t = ids[i];
+        ids[i] = ids[j];
+        ids[j] = t;
+    }
+}
+
+static Arena* set_arena(uint32_t capacity, uint32_t sets) {
+    return arena_create(((size_t)capacity * (2 * sizeof(uint32_t) + COMPONENT_SIZE) + 128) * sets);
+}
+
+static void bench_arena(uint32_t n) {
+    const uint32_t reps = reps_for(n);
+    Arena *arena = arena_create((size_t)n * 64 + 64);
+    uint64_t elapsed = 0;
+
+    for (uint32_t r = 0; r < reps; r++) {
+        arena_reset(arena);
+        const uint64_t start = now_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            sink += (uintptr_t)arena_alloc_aligned(arena, 24, 64);
+        }
+        elapsed += now_ns() - start;
+    }
+    report(n, "arena_alloc_aligned", "24B@64", elapsed, (uint64_t)n * reps);
+
+    // Scratch pattern from the combat systems: checkpoint, allocate, restore
+    arena_reset(arena);
+    elapsed = 0;
+    for (uint32_t r = 0; r < reps; r++) {
+        const uint64_t start = now_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            const size_t checkpoint = arena_checkpoint(arena);
+            sink += (uintptr_t)arena_alloc(arena, 256);
+            arena_restore(arena, checkpoint);
+        }
+        elapsed += now_ns() - start;
+    }
+    report(n, "arena_checkpoint+restore", "256B scratch", elapsed, (uint64_t)n * reps);
+
+    arena_destroy(arena);
+}
+
+static void bench_entities(uint32_t n, Rng *rng) {
+    // At least two reps so both destroy orders are measured
+    const uint32_t reps = reps_for(n) < 2 ? 2 : reps_for(n);
+    Entity *handles = malloc(sizeof(Entity) * n);
+    uint32_t *order = malloc(sizeof(uint32_t) * n);
+    uint64_t create_ns = 0, destroy_seq_ns = 0, destroy_rand_ns = 0;
+
+    for (uint32_t r = 0; r < reps; r++) {
+        EntityManager em;
+        entity_manager_init(&em, n);
+
+        uint64_t start = now_ns();
+        for (uint32_t i = 0; i < n; i++) handles[i] = entity_create(&em);
+        create_ns += now_ns() - start;
+
+        // Alternate reps between destroying in creation order and in random order
+        const int random = r & 1;
+        if (random) random_ids(order, n, rng);
+        else sequential_ids(order, n);
+
+        start = now_ns();
+        for (uint32_t i = 0; i < n; i++) entity_destroy(&em, handles[order[i]]);
+        if (random) destroy_rand_ns += now_ns() - start;
+        else destroy_seq_ns += now_ns() - start;
+
+        sink += em.free_count;
+        entity_manager_free(&em);
+    }
+
+    const uint32_t rand_reps = reps / 2;
+    report(n, "entity_create", "fresh", create_ns, (uint64_t)n * reps);
+    report(n, "entity_destroy", "sequential", destroy_seq_ns, (uint64_t)n * (reps - rand_reps));
+    report(n, "entity_destroy", "random", destroy_rand_ns, (uint64_t)n * rand_reps);
+
+    free(order);
+    free(handles);
+}
+
+static void bench_sparse_set(uint32_t n, Rng *rng) {
+    const uint32_t reps = reps_for(n);
+    Arena *arena = set_arena(n, 1);
+    uint32_t *seq = malloc(sizeof(uint32_t) * n);
+    uint32_t *rnd = malloc(sizeof(uint32_t) * n);
+    sequential_ids(seq, n);
+    random_ids(rnd, n, rng);
+
+    BenchComponent component = {{0}};
+    const uint32_t *patterns[2] = {seq, rnd};
+    const char *pattern_names[2] = {"sequential", "random"};
+
+    for (int p = 0; p < 2; p++) {
+        const uint32_t *ids = patterns[p];
+        uint64_t add_ns = 0, get_ns = 0, remove_ns = 0;
+
+        for (uint32_t r = 0; r < reps; r++) {
+            arena_reset(arena);
+            SparseSet set;
+            sparse_set_init(&set, n, sizeof(BenchComponent), arena);
+
+            uint64_t start = now_ns();
+            for (uint32_t i = 0; i < n; i++) sparse_set_add(&set, ids[i], &component);
+            add_ns += now_ns() - start;
+
+            uint64_t sum = 0;
+            start = now_ns();
+            for (uint32_t i = 0; i < n; i++) {
+                const BenchComponent *c = sparse_set_get(&set, ids[i]);
+                sum += c->bytes[0];
+            }
+            get_ns += now_ns() - start;
+            sink += sum;
+
+            start = now_ns();
+            for (uint32_t i = 0; i < n; i++) sparse_set_remove(&set, ids[i]);
+            remove_ns += now_ns() - start;
+        }
+
+        report(n, "sparse_set_add", pattern_names[p], add_ns, (uint64_t)n * reps);
+        report(n, "sparse_set_get (hit)", pattern_names[p], get_ns, (uint64_t)n * reps);
+        report(n, "sparse_set_remove", pattern_names[p], remove_ns, (uint64_t)n * reps);
+    }
+
+    // Misses: half the IDs are present, look up the other half in random order
+    arena_reset(arena);
+    SparseSet set;
+    sparse_set_init(&set, n, sizeof(BenchComponent), arena);
+    for (uint32_t i = 0; i < n; i += 2) sparse_set_add(&set, i, &component);
+
+    uint64_t elapsed = 0, misses = 0;
+    for (uint32_t r = 0; r < reps; r++) {
+        const uint64_t start = now_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            misses += sparse_set_get(&set, rnd[i] | 1u) == NULL;
+        }
+        elapsed += now_ns() - start;
+    }
+    sink += misses;
+    report(n, "sparse_set_get (miss)", "random", elapsed, (uint64_t)n * reps);
+
+    free(rnd);
+    free(seq);
+    arena_destroy(arena);
+}
+
+// Destroy a random live entity and create a replacement, keeping fill constant
+static void bench_churn(uint32_t n, double fill, Rng *rng) {
+    const uint32_t live = (uint32_t)(n * fill);
+    if (live == 0) return;
+
+    Arena *arena = set_arena(n, 1);
+    EntityManager em;
+    entity_manager_init(&em, n);
+    SparseSet set;
+    sparse_set_init(&set, n, sizeof(BenchComponent), arena);
+
+    Entity *handles = malloc(sizeof(Entity) * live);
+    BenchComponent component = {{0}};
+    for (uint32_t i = 0; i < live; i++) {
+        handles[i] = entity_create(&em);
+        sparse_set_add(&set, handles[i].id, &component);
+    }
+
+    const uint64_t ops = MIN_OPS_PER_CASE > n ? MIN_OPS_PER_CASE : n;
+    const uint64_t start = now_ns();
+    for (uint64_t i = 0; i < ops; i++) {
+        const uint32_t slot = rng_range(rng, live);
+        sparse_set_remove(&set, handles[slot].id);
+        entity_destroy(&em, handles[slot]);
+
+        handles[slot] = entity_create(&em);
+        sparse_set_add(&set, handles[slot].id, &component);
+    }
+    const uint64_t elapsed = now_ns() - start;
+
+    char pattern[32];
+    snprintf(pattern, sizeof(pattern), "fill %.0f%%", fill * 100.0);
+    report(n, "churn (destroy+create)", pattern, elapsed, ops);
+
+    sink += set.dense_count;
+    free(handles);
+    entity_manager_free(&em);
+    arena_destroy(arena);
+}
+
+// The World's former layout: one component set and two index-only team sets
+static void bench_storage_manager(uint32_t n, Rng *rng) {
+    const uint32_t batch = n / 10;
+    if (batch == 0) return;
+
+    const uint32_t reps = reps_for(batch);
+    Arena *arena = set_arena(n, 3);
+    uint32_t *ids = malloc(sizeof(uint32_t) * n);
+    BenchComponent component = {{0}};
+    uint64_t elapsed = 0;
+
+    for (uint32_t r = 0; r < reps; r++) {
+        arena_reset(arena);
+        SparseSet data, team_a, team_b;
+        sparse_set_init(&data, n, sizeof(BenchComponent), arena);
+        sparse_set_init(&team_a, n, 0, arena);
+        sparse_set_init(&team_b, n, 0, arena);
+
+        StorageManager sm;
+        storage_manager_init(&sm, 4);
+        storage_manager_register(&sm, &data);
+        storage_manager_register(&sm, &team_a);
+        storage_manager_register(&sm, &team_b);
+
+        for (uint32_t i = 0; i < n; i++) {
+            sparse_set_add(&data, i, &component);
+            sparse_set_add((i & 1) ? &team_b : &team_a, i, NULL);
+        }
+
+        // A heavy turn's worth of deaths: 10% of entities at random
+        random_ids(ids, n, rng);
+        const uint64_t start = now_ns();
+        storage_manager_remove_entities(&sm, ids, batch);
+        elapsed += now_ns() - start;
+
+        sink += data.dense_count;
+        storage_manager_free(&sm);
+    }
+    report(n, "storage_mgr_remove_entities", "10% random, 3set", elapsed, (uint64_t)batch * reps);
+
+    free(ids);
+    arena_destroy(arena);
+}
+
+// Fill a component set with n entities keyed 0 .. buckets - 1, in key order
+// (one army after another) or mixed; returns ns spent adding
+static uint64_t fill_keyed(SparseSet *data, uint32_t n, uint32_t buckets, bool mixed, Rng *rng) {
+    BenchComponent component = {{0}};
+    const uint64_t start = now_ns();
+    for (uint32_t i = 0; i < n; i++) {
+        component.bytes[0] = (uint8_t)(mixed ? rng_range(rng, buckets) : (uint64_t)i * buckets / n);
+        sparse_set_add(data, i, &component);
+    }
+    return now_ns() - start;
+}
+
+// What the automatic index costs next to hand-kept team sets (the World's old
+// layout), and what a bucket lookup saves over filtering the whole set
+static void bench_field_index(uint32_t n, Rng *rng) {
+    const uint32_t batch = n / 10;
+    if (batch == 0) return;
+
+    const uint32_t reps = reps_for(n);
+    Arena *arena = set_arena(n, 3);
+    uint32_t *ids = malloc(sizeof(uint32_t) * n);
+    BenchComponent component = {{0}};
+
+    // Hand-kept: every add and remove also goes to one of two index-only sets
+    uint64_t add_ns = 0, remove_ns = 0;
+    for (uint32_t r = 0; r < reps; r++) {
+        arena_reset(arena);
+        SparseSet data, team[2];
+        sparse_set_init(&data, n, sizeof(BenchComponent), arena);
+        sparse_set_init(&team[0], n, 0, arena);
+        sparse_set_init(&team[1], n, 0, arena);
+
+        uint64_t start = now_ns();
+        for (uint32_t i = 0; i < n; i++) {
+            component.bytes[0] = (uint8_t)(i >= n / 2);
+            sparse_set_add(&data, i, &component);
+            sparse_set_add(&team[i >= n / 2], i, NULL);
+        }
+        add_ns += now_ns() - start;
+
+        random_ids(ids, n, rng);
+        start = now_ns();
+        for (uint32_t i = 0; i < batch; i++) {
+            const BenchComponent *c = sparse_set_get(&data, ids[i]);
+            sparse_set_remove(&team[c->bytes[0]], ids[i]);
+            sparse_set_remove(&data, ids[i]);
+        }
+        remove_ns += now_ns() - start;
+        sink += team[0].dense_count + team[1].dense_count;
+    }
+    report(n, "field_index_add", "manual 2set", add_ns, (uint64_t)n * reps);
+    report(n, "field_index_remove", "manual 2set", remove_ns, (uint64_t)batch * reps);
+
+    // Indexed, with 2 and 16 buckets, filled one key after another and mixed
+    const uint32_t bucket_counts[] = {2, 16};
+    for (size_t b = 0; b < sizeof(bucket_counts) / sizeof(bucket_counts[0]); b++) {
+        const uint32_t buckets = bucket_counts[b];
+        for (int mixed = 0; mixed <= 1; mixed++) {
+            uint64_t lookup_ns = 0, scan_ns = 0, matches = 0;
+            add_ns = remove_ns = 0;
+            for (uint32_t r = 0; r < reps; r++) {
+                arena_reset(arena);
+                SparseSet data;
+                FieldIndex index;
+                sparse_set_init(&data, n, sizeof(BenchComponent), arena);
+                field_index_init(&index, &data, FIELD_INDEX_KEY(BenchComponent, bytes[0]), buckets, arena);
+                add_ns += fill_keyed(&data, n, buckets, mixed, rng);
+
+                random_ids(ids, n, rng);
+                uint64_t start = now_ns();
+                for (uint32_t i = 0; i < batch; i++) sparse_set_remove(&data, ids[i]);
+                remove_ns += now_ns() - start;
+
+                // Every entity with key 1, through the bucket and by filtering
+                uint32_t count;
+                uint64_t sum = 0;
+                start = now_ns();
+                const uint32_t *members = field_index_bucket(&index, 1, &count);
+                for (uint32_t i = 0; i < count; i++) {
+                    sum += ((const BenchComponent*)sparse_set_get(&data, members[i]))->bytes[1] + members[i];
+                }
+                lookup_ns += now_ns() - start;
+
+                start = now_ns();
+                const BenchComponent *dense = data.dense_data;
+                for (uint32_t i = 0; i < data.dense_count; i++) {
+                    if (dense[i].bytes[0] == 1) sum += dense[i].bytes[1] + data.dense_entities[i];
+                }
+                scan_ns += now_ns() - start;
+                matches += count;
+                sink += sum;
+            }
+
+            char pattern[32];
+            snprintf(pattern, sizeof(pattern), "%u buckets %s", buckets, mixed ? "mixed" : "grouped");
+            report(n, "field_index_add", pattern, add_ns, (uint64_t)n * reps);
+            report(n, "field_index_remove", pattern, remove_ns, (uint64_t)batch * reps);
+            if (!mixed) {
+                report(n, "field_index_lookup", pattern, lookup_ns, matches ? matches : 1);
+                report(n, "field_index_scan_filter", pattern, scan_ns, matches ? matches : 1);
+            }
+        }
+    }
+
+    free(ids);
+    arena_destroy(arena);
+}
+
+static void bench_death_queue(uint32_t n) {
+    const uint32_t reps = reps_for(n);
+    uint64_t growing_ns = 0, presized_ns = 0;
+
+    for (uint32_t r = 0; r < reps; r++) {
+        DeathQueue growing, presized;
+        death_queue_init(&growing, 0);
+        death_queue_init(&presized, n);
+
+        uint64_t start = now_ns();
+        for (uint32_t i = 0; i < n; i++) death_queue_push(&growing, (Entity){i, 0});
+        growing_ns += now_ns() - start;
+
+        start = now_ns();
+        for (uint32_t i = 0; i < n; i++) death_queue_push(&presized, (Entity){i, 0});
+        presized_ns += now_ns() - start;
+
+        sink += growing.count + presized.count;
+        death_queue_free(&growing);
+        death_queue_free(&presized);
+    }
+    report(n, "death_queue_push", "growing", growing_ns, (uint64_t)n * reps);
+    report(n, "death_queue_push", "presized", presized_ns, (uint64_t)n * reps);
+}
+
+// Per-thread shard updates, the cost every instrumented call site pays
+static void bench_metrics(uint32_t n, Rng *rng) {
+    const MetricId counter = metrics_counter("microbench_ops_total", NULL, "Microbenchmark counter");
+    const MetricId gauge = metrics_gauge("microbench_level", NULL, "Microbenchmark gauge");
+    const MetricId histogram = metrics_histogram("microbench_latency_seconds", NULL, "Microbenchmark histogram", 1e-9);
+
+    // Values spread over six orders of magnitude, so records hit many buckets
+    uint32_t *values = malloc(sizeof(uint32_t) * n);
+    for (uint32_t i = 0; i < n; i++) values[i] = 1u << rng_range(rng, 20) | rng_range(rng, 1024);
+
+    const uint32_t reps = reps_for(n);
+    uint64_t add_ns = 0, set_ns = 0, record_ns = 0;
+    for (uint32_t r = 0; r < reps; r++) {
+        uint64_t start = now_ns();
+        for (uint32_t i = 0; i < n; i++) metrics_add(counter, 1);
+        add_ns += now_ns() - start;
+
+        start = now_ns();
+        for (uint32_t i = 0; i < n; i++) metrics_set(gauge, i);
+        set_ns += now_ns() - start;
+
+        start = now_ns();
+        for (uint32_t i = 0; i < n; i++) metrics_record(histogram, values[i]);
+        record_ns += now_ns() - start;
+    }
+    sink += metrics_counter_total(counter);
+    free(values);
+    report(n, "metrics_add", "counter", add_ns, (uint64_t)n * reps);
+    report(n, "metrics_set", "gauge", set_ns, (uint64_t)n * reps);
+    report(n, "metrics_record", "histogram", record_ns, (uint64_t)n * reps);
+}
+
+int main(int argc, char **argv) {
+    uint32_t max_entities = 10000000;
+    if (argc > 1) max_entities = (uint32_t)strtoul(argv[1], NULL, 10);
+
+    const double fills[] = {0.1, 0.5, 0.9};
+
+    // Fixed seed so every run sees the same ID orders
+    Rng rng;
+    rng_seed(&rng, 0x5EEDu);
+
+    printf("=== ECS CORE MICROBENCHMARKS ===\n");
+    printf("%10s %-28s %-16s %10s\n", "entities", "operation", "pattern", "ns/op");
+
+    for (uint32_t n = 10000; n <= max_entities; n *= 10) {
+        bench_arena(n);
+        bench_entities(n, &rng);
+        bench_sparse_set(n, &rng);
+        for (size_t f = 0; f < sizeof(fills) / sizeof(fills[0]); f++) {
+            bench_churn(n, fills[f], &rng);
+        }
+        bench_storage_manager(n, &rng);
+        bench_field_index(n, &rng);
+        bench_death_queue(n);
+        bench_metrics(n, &rng);
+        if (n > UINT32_MAX / 10) break;
+    }
+    return 0;
+}
@@ -0,0 +1,133 @@
+//
+// Created by jo on 10/19/2026.
+//
+// Spatial grid throughput at increasing unit densities: full rebuild cost,
+// incremental move cost, and k-nearest / radius query throughput.
+//
+// Usage: spatial_bench [max_units]   (default 1000000)
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#include "ecs_core/arena.h"
+#include "ecs_core/spatial_grid.h"
+
+#define CELL_SIZE 8.0f
+#define QUERY_COUNT 200000
+#define REBUILD_REPS 5
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Small self-contained generator so runs are repeatable
+static uint32_t bench_rng_state = 0x9E3779B9u;
+static float rand_unit(void) {
+    bench_rng_state ^= bench_rng_state << 13;
+    bench_rng_state ^= bench_rng_state >> 17;
+    bench_rng_state ^= bench_rng_state << 5;
+    return (float)(bench_rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+static void run_case(uint32_t units, float density) {
+    // density = units per square world unit
+    const float side = sqrtf((float)units / density);
+    const size_t cells = (size_t)ceilf(side / CELL_SIZE) * (size_t)ceilf(side / CELL_SIZE);
+    const size_t arena_size = (size_t)units * (6 * sizeof(uint32_t) + sizeof(uint8_t)) +
+                              cells * (SPATIAL_GRID_MAX_GROUPS * sizeof(uint32_t) + sizeof(uint16_t)) + (1 << 20);
+
+    Arena *arena = arena_create(arena_size);
+    if (!arena) {
+        fprintf(stderr, "arena allocation failed for %u units\n", units);
+        return;
+    }
+
+    SpatialGrid grid;
+    spatial_grid_init(&grid, units, 0.0f, 0.0f, side, side, CELL_SIZE, arena);
+
+    float *xs = malloc(sizeof(float) * units);
+    float *ys = malloc(sizeof(float) * units);
+    uint32_t *results = malloc(sizeof(uint32_t) * units);
+    for (uint32_t i = 0; i < units; i++) {
+        xs[i] = rand_unit() * side;
+        ys[i] = rand_unit() * side;
+    }
+
+    // Full rebuild: clear + insert everything
+    uint64_t start = now_ns();
+    for (int rep = 0; rep < REBUILD_REPS; rep++) {
+        spatial_grid_clear(&grid);
+        for (uint32_t i = 0; i < units; i++) {
+            spatial_grid_insert(&grid, i, xs[i], ys[i]);
+        }
+    }
+    double rebuild_ms = (double)(now_ns() - start) / REBUILD_REPS / 1e6;
+
+    // Incremental update: every unit takes a step of up to 2 world units
+    start = now_ns();
+    for (uint32_t i = 0; i < units; i++) {
+        xs[i] += (rand_unit() - 0.5f) * 4.0f;
+        ys[i] += (rand_unit() - 0.5f) * 4.0f;
+        spatial_grid_move(&grid, i, xs[i], ys[i]);
+    }
+    double move_ns = (double)(now_ns() - start) / units;
+
+    // k-nearest queries at random points
+    uint32_t knn_ids[8];
+    uint64_t checksum = 0;
+    start = now_ns();
+    for (uint32_t q = 0; q < QUERY_COUNT; q++) {
+        checksum += spatial_grid_query_nearest(&grid, rand_unit() * side, rand_unit() * side,
+                                               1, INFINITY, knn_ids, NULL);
+    }
+    double knn1_qps = QUERY_COUNT / ((double)(now_ns() - start) / 1e9);
+
+    start = now_ns();
+    for (uint32_t q = 0; q < QUERY_COUNT; q++) {
+        checksum += spatial_grid_query_nearest(&grid, rand_unit() * side, rand_unit() * side,
+                                               8, INFINITY, knn_ids, NULL);
+    }
+    double knn8_qps = QUERY_COUNT / ((double)(now_ns() - start) / 1e9);
+
+    // Radius queries of one cell size
+    uint64_t radius_hits = 0;
+    start = now_ns();
+    for (uint32_t q = 0; q < QUERY_COUNT; q++) {
+        radius_hits += spatial_grid_query_radius(&grid, rand_unit() * side, rand_unit() * side,
+                                                 CELL_SIZE, results, units);
+    }
+    double radius_qps = QUERY_COUNT / ((double)(now_ns() - start) / 1e9);
+
+    printf("%10u %8.2f %12.3f %10.1f %12.0f %12.0f %12.0f %10.1f %s\n",
+           units, density, rebuild_ms, move_ns, knn1_qps, knn8_qps, radius_qps,
+           (double)radius_hits / QUERY_COUNT, checksum ? "" : "!");
+
+    free(results);
+    free(ys);
+    free(xs);
+    arena_destroy(arena);
+}
+
+int main(int argc, char **argv) {
+    uint32_t max_units = 1000000;
+    if (argc > 1) max_units = (uint32_t)strtoul(argv[1], NULL, 10);
+
+    const float densities[] = {0.05f, 0.25f, 1.0f, 4.0f};
+
+    printf("=== SPATIAL GRID BENCHMARK (cell size %.1f) ===\n", CELL_SIZE);
+    printf("%10s %8s %12s %10s %12s %12s %12s %10s\n",
+           "units", "density", "rebuild_ms", "move_ns", "knn1_qps", "knn8_qps", "radius_qps", "avg_hits");
+
+    for (uint32_t units = 10000; units <= max_units; units *= 10) {
+        for (size_t d = 0; d < sizeof(densities) / sizeof(densities[0]); d++) {
+            run_case(units, densities[d]);
+        }
+    }
+    return 0;
+}
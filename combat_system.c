@@ -3,22 +3,26 @@
 //
 
 #include "combat_system.h"
+#include "battle_metrics.h"
 #include "components.h"
+#include "ecs_core/entity_lookup.h"
+#include "ecs_core/profiler.h"
+#include "ecs_core/parallel.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
 #include <stdbool.h>
+#include <math.h>
 
 
-// Use team-specific sets to find weakest, not full scan
+// Use the team index to find weakest, not full scan
 static Entity find_weakest_in_team_optimized(World *world, uint8_t team_id, int *out_health) {
-    SparseSet *team_set = (team_id == 0) ? world->team_a_storage : world->team_b_storage;
     Entity weakest = {UINT32_MAX, 0};
     int lowest_health = INT_MAX;
 
-    uint32_t *team_entities = team_set->dense_entities;
-    uint32_t team_count = team_set->dense_count;
+    uint32_t team_count;
+    const uint32_t *team_entities = field_index_bucket(world->team_index, team_id, &team_count);
 
     // Only iterate through the specific team's entities
     for (uint32_t i = 0; i < team_count; i++) {
@@ -41,260 +45,659 @@ static Entity find_weakest_in_team_optimized(World *world, uint8_t team_id, int
     return weakest;
 }
 
+// Offer a unit to a cache kept sorted weakest first: it goes after every
+// entry at least as weak, and a full cache drops its strongest
+static inline void weakest_cache_offer(WeakestCache *cache, Entity target, int health) {
+    uint32_t pos = cache->count;
+    while (pos > 0 && health < cache->healths[pos - 1]) pos--;
+    if (pos >= WEAKEST_CACHE_SIZE) return;
+
+    uint32_t last = cache->count < WEAKEST_CACHE_SIZE ? cache->count++ : WEAKEST_CACHE_SIZE - 1;
+    for (; last > pos; last--) {
+        cache->targets[last] = cache->targets[last - 1];
+        cache->healths[last] = cache->healths[last - 1];
+    }
+    cache->targets[pos] = target;
+    cache->healths[pos] = health;
+}
+
 //  Cache multiple weak targets per team
 static void update_weakest_cache_multi(World *world) {
     if (!world->needs_target_update) return;
-
-    // Reset caches
-    world->weakest_cache_a.count = 0;
-    world->weakest_cache_b.count = 0;
-
-    // Team A weakest targets
-    SparseSet *team_a = world->team_a_storage;
-    for (uint32_t i = 0; i < team_a->dense_count && world->weakest_cache_a.count < WEAKEST_CACHE_SIZE; i++) {
-        uint32_t entity_id = team_a->dense_entities[i];
-        uint32_t idx = world->combatant_storage->sparse[entity_id];
-        if (idx >= world->combatant_storage->dense_count) continue;
-
-        CombatantBundle *combatant = &((CombatantBundle*)world->combatant_storage->dense_data)[idx];
-        if (combatant->health > 0) {
-            // Insert into sorted cache
-            uint32_t insert_pos = world->weakest_cache_a.count;
-            for (uint32_t j = 0; j < world->weakest_cache_a.count; j++) {
-                if (combatant->health < world->weakest_cache_a.healths[j]) {
-                    insert_pos = j;
-                    // Shift others down
-                    for (uint32_t k = world->weakest_cache_a.count; k > j; k--) {
-                        if (k < WEAKEST_CACHE_SIZE) {
-                            world->weakest_cache_a.targets[k] = world->weakest_cache_a.targets[k-1];
-                            world->weakest_cache_a.healths[k] = world->weakest_cache_a.healths[k-1];
-                        }
-                    }
-                    break;
-                }
-            }
-            if (insert_pos < WEAKEST_CACHE_SIZE) {
-                world->weakest_cache_a.targets[insert_pos].id = entity_id;
-                world->weakest_cache_a.targets[insert_pos].generation = world->entity_manager->generation[entity_id];
-                world->weakest_cache_a.healths[insert_pos] = combatant->health;
-                if (world->weakest_cache_a.count < WEAKEST_CACHE_SIZE) {
-                    world->weakest_cache_a.count++;
-                }
+    PROFILE_FUNCTION();
+    PROFILE_COUNT(PROFILE_COUNTER_CACHE_REBUILDS, 1);
+
+    const SparseSet *combatants = world->combatant_storage;
+    const CombatantBundle *all_combatants = combatants->dense_data;
+    const uint32_t *generation = world->entity_manager->generation;
+    const uint32_t teams = world->team_count;
+
+    // Each team's candidates: its first living units in index order, sorted by health
+    WeakestCache candidates[MAX_TEAMS];
+    for (uint32_t t = 0; t < teams; t++) {
+        candidates[t].count = 0;
+        uint32_t member_count;
+        const uint32_t *members = field_index_bucket(world->team_index, t, &member_count);
+        for (uint32_t i = 0; i < member_count && candidates[t].count < WEAKEST_CACHE_SIZE; i++) {
+            uint32_t entity_id = members[i];
+            uint32_t idx = combatants->sparse[entity_id];
+            if (idx >= combatants->dense_count) continue;
+
+            const CombatantBundle *combatant = &all_combatants[idx];
+            if (combatant->health > 0) {
+                weakest_cache_offer(&candidates[t], (Entity){entity_id, generation[entity_id]}, combatant->health);
             }
         }
     }
 
-    // Team B weakest targets (same logic)
-    SparseSet *team_b = world->team_b_storage;
-    for (uint32_t i = 0; i < team_b->dense_count && world->weakest_cache_b.count < WEAKEST_CACHE_SIZE; i++) {
-        uint32_t entity_id = team_b->dense_entities[i];
-        uint32_t idx = world->combatant_storage->sparse[entity_id];
-        if (idx >= world->combatant_storage->dense_count) continue;
-
-        CombatantBundle *combatant = &((CombatantBundle*)world->combatant_storage->dense_data)[idx];
-        if (combatant->health > 0) {
-            uint32_t insert_pos = world->weakest_cache_b.count;
-            for (uint32_t j = 0; j < world->weakest_cache_b.count; j++) {
-                if (combatant->health < world->weakest_cache_b.healths[j]) {
-                    insert_pos = j;
-                    for (uint32_t k = world->weakest_cache_b.count; k > j; k--) {
-                        if (k < WEAKEST_CACHE_SIZE) {
-                            world->weakest_cache_b.targets[k] = world->weakest_cache_b.targets[k-1];
-                            world->weakest_cache_b.healths[k] = world->weakest_cache_b.healths[k-1];
-                        }
-                    }
-                    break;
-                }
-            }
-            if (insert_pos < WEAKEST_CACHE_SIZE) {
-                world->weakest_cache_b.targets[insert_pos].id = entity_id;
-                world->weakest_cache_b.targets[insert_pos].generation = world->entity_manager->generation[entity_id];
-                world->weakest_cache_b.healths[insert_pos] = combatant->health;
-                if (world->weakest_cache_b.count < WEAKEST_CACHE_SIZE) {
-                    world->weakest_cache_b.count++;
-                }
+    // A team targets the weakest candidates of every other team. They're merged
+    // starting from the next team up (wrapping around), so ties in health go
+    // to a different enemy for every team rather than always the lowest team_id.
+    for (uint32_t t = 0; t < teams; t++) {
+        WeakestCache *cache = &world->enemy_cache[t];
+        cache->count = 0;
+        for (uint32_t offset = 1; offset < teams; offset++) {
+            const uint32_t enemy = (t + offset) % teams;
+            for (uint32_t j = 0; j < candidates[enemy].count; j++) {
+                weakest_cache_offer(cache, candidates[enemy].targets[j], candidates[enemy].healths[j]);
             }
         }
     }
 
-    // Set primary weakest for backward compatibility
-    if (world->weakest_cache_a.count > 0) {
-        world->weakest_team_a = world->weakest_cache_a.targets[0];
-        world->weakest_team_a_health = world->weakest_cache_a.healths[0];
-    } else {
-        world->weakest_team_a = (Entity){UINT32_MAX, 0};
-        world->weakest_team_a_health = INT_MAX;
+    world->needs_target_update = false;
+}
+
+// Phases also run as resumable steps (see world_step): each call does up to
+// `budget` items of the phase's current pass, keeping its place in
+// world->turn_cursor, and returns true once the whole phase is done. The
+// plain phase functions step with an unlimited budget until that happens.
+
+// A unit picking a new target counts as this many items against the budget:
+// after a wave of deaths most of a slice may be nearest-enemy searches
+#define TARGET_SEARCH_COST 15
+
+// End of the next slice of a pass over count items
+static inline uint32_t slice_end(const TurnCursor *cursor, uint32_t count, uint32_t budget) {
+    return count - cursor->index > budget ? cursor->index + budget : count;
+}
+
+static inline void cursor_begin_stage(TurnCursor *cursor, uint32_t stage) {
+    cursor->stage = stage;
+    cursor->index = 0;
+}
+
+// The phase is complete: clear its state for the next one
+static inline bool cursor_phase_done(TurnCursor *cursor) {
+    const uint32_t phase = cursor->phase;
+    memset(cursor, 0, sizeof(*cursor));
+    cursor->phase = phase;
+    return true;
+}
+
+// Re-resolve the cached targets of dense slots [begin, end) after the
+// combatant storage changed shape
+static void refresh_stale_targets(World *world, uint32_t begin, uint32_t end) {
+    PROFILE_FUNCTION();
+    SparseSet *combatants = world->combatant_storage;
+    CombatantBundle *all_combatants = combatants->dense_data;
+    const uint32_t count = end - begin;
+
+    size_t checkpoint = arena_checkpoint(world->battle_arena);
+    Entity *targets = arena_alloc(world->battle_arena, sizeof(Entity) * count);
+    uint32_t *target_indices = arena_alloc(world->battle_arena, sizeof(uint32_t) * count);
+    uint8_t *target_valid = arena_alloc(world->battle_arena, sizeof(uint8_t) * count);
+
+    // Gather pass: collect every attacker's target handle (sequential read)
+    for (uint32_t i = 0; i < count; i++) {
+        targets[i] = all_combatants[begin + i].target.entity;
     }
 
-    if (world->weakest_cache_b.count > 0) {
-        world->weakest_team_b = world->weakest_cache_b.targets[0];
-        world->weakest_team_b_health = world->weakest_cache_b.healths[0];
-    } else {
-        world->weakest_team_b = (Entity){UINT32_MAX, 0};
-        world->weakest_team_b_health = INT_MAX;
+    // Validate and resolve all targets at once so the generation/sparse loads overlap
+    entity_resolve_batch(world->entity_manager, combatants,
+                         targets, count, target_indices, target_valid);
+
+    for (uint32_t i = 0; i < count; i++) {
+        resolved_handle_store(&all_combatants[begin + i].target, combatants, target_indices[i]);
     }
 
-    world->needs_target_update = false;
+    arena_restore(world->battle_arena, checkpoint);
 }
 
-void combat_system_target_acquisition(World *world) {
-    update_weakest_cache_multi(world);
+// Pick the nearest living unit of any other team through the spatial grid
+static Entity find_nearest_enemy(World *world, const CombatantBundle *bundle) {
+    uint32_t nearest_id;
 
-    CombatantBundle *all_combatants = world->combatant_storage->dense_data;
-    uint32_t count = world->combatant_storage->dense_count;
+    if (spatial_grid_query_nearest_excluding(world->spatial, bundle->position.x, bundle->position.y,
+                                             1, INFINITY, bundle->team_id, &nearest_id, NULL) == 0) {
+        return (Entity){UINT32_MAX, 0};
+    }
+    return (Entity){nearest_id, world->entity_manager->generation[nearest_id]};
+}
 
-    //  Distribute targets across multiple weak enemies
-    uint32_t team_a_target_idx = 0;
-    uint32_t team_b_target_idx = 0;
+// Combat events go to the journal unless it only records state hashes
+static inline JournalRing* event_journal(const World *world) {
+    return world->journal_state_only ? NULL : world->journal;
+}
 
-    for (uint32_t i = 0; i < count; i++) {
-        CombatantBundle *bundle = &all_combatants[i];
+// Give one combatant (dense index idx) a new target; its current one no longer resolves
+static void acquire_target(World *world, uint32_t idx, bool nearest_mode, uint32_t *enemy_cache_idx) {
+    CombatantBundle *bundle = &((CombatantBundle*)world->combatant_storage->dense_data)[idx];
+    Entity new_target = {UINT32_MAX, 0};
+
+    if (nearest_mode) {
+        new_target = find_nearest_enemy(world, bundle);
+    } else {
+        // Round-robin over the weakest units hostile to this team
+        const WeakestCache *cache = &world->enemy_cache[bundle->team_id];
+        if (cache->count > 0) {
+            new_target = cache->targets[enemy_cache_idx[bundle->team_id] % cache->count];
+            enemy_cache_idx[bundle->team_id]++;
+        }
+    }
+
+    bundle->target = resolved_handle_make(new_target);
+    resolved_handle_get(&bundle->target, world->entity_manager, world->combatant_storage);
+    bundle->is_attacking = (bundle->target.dense_index != UINT32_MAX);
+
+    if (world->state_hash) state_hash_mark(world->state_hash, idx);
 
-        if (bundle->target.id == UINT32_MAX ||
-            !entity_is_alive(world->entity_manager, bundle->target)) {
-
-            if (bundle->team_id == 0) {
-                // Team A attacks Team B
-                if (world->weakest_cache_b.count > 0) {
-                    bundle->target = world->weakest_cache_b.targets[team_b_target_idx % world->weakest_cache_b.count];
-                    team_b_target_idx++;
-                } else {
-                    bundle->target = (Entity){UINT32_MAX, 0};
-                }
-            } else {
-                // Team B attacks Team A
-                if (world->weakest_cache_a.count > 0) {
-                    bundle->target = world->weakest_cache_a.targets[team_a_target_idx % world->weakest_cache_a.count];
-                    team_a_target_idx++;
-                } else {
-                    bundle->target = (Entity){UINT32_MAX, 0};
-                }
+    JournalRing *journal = event_journal(world);
+    if (journal) {
+        journal_record(journal, world->turn_number, COMBAT_EVENT_TARGET,
+                       world->combatant_storage->dense_entities[idx], new_target.id,
+                       (int32_t)new_target.generation);
+    }
+}
+
+enum {
+    ACQUIRE_START = 0,
+    ACQUIRE_READY,    // cooldown mode: ready units with a dead target
+    ACQUIRE_REFRESH,  // every-turn mode, storage changed shape: re-resolve all handles
+    ACQUIRE_ALL       // every-turn mode: units with a dead target
+};
+
+bool combat_system_target_acquisition_step(World *world, uint32_t budget) {
+    PROFILE_FUNCTION();
+    TurnCursor *cursor = &world->turn_cursor;
+    const bool nearest_mode = (world->targeting_mode == TARGETING_NEAREST);
+
+    const EntityManager *em = world->entity_manager;
+    const SparseSet *combatants = world->combatant_storage;
+    CombatantBundle *all_combatants = combatants->dense_data;
+    uint32_t count = combatants->dense_count;
+
+    if (cursor->stage == ACQUIRE_START) {
+        if (!nearest_mode) update_weakest_cache_multi(world);
+
+        // Quiet turns (no removals since the last pass) skip the refresh entirely
+        if (world->schedule_mode == SCHEDULE_COOLDOWN) {
+            cursor_begin_stage(cursor, ACQUIRE_READY);
+        } else if (world->resolved_target_version != combatants->version) {
+            cursor_begin_stage(cursor, ACQUIRE_REFRESH);
+        } else {
+            cursor_begin_stage(cursor, ACQUIRE_ALL);
+        }
+    }
+
+    if (cursor->stage == ACQUIRE_READY) {
+        // Only units whose cooldown expired pick targets; their handles resolve lazily
+        const uint32_t begin = cursor->index;
+        uint32_t r = begin;
+        uint32_t acquired = 0;
+        for (uint32_t spent = 0; r < world->ready_count && spent < budget; r++, spent++) {
+            uint32_t idx = sparse_set_index_of(combatants, world->ready_entities[r]);
+            if (idx == UINT32_MAX) continue;
+
+            CombatantBundle *bundle = &all_combatants[idx];
+            if (resolved_handle_get(&bundle->target, em, combatants) == UINT32_MAX) {
+                acquire_target(world, idx, nearest_mode, cursor->enemy_cache_idx);
+                spent += TARGET_SEARCH_COST;
+                acquired++;
             }
+        }
+        PROFILE_COUNT(PROFILE_COUNTER_ENTITIES_PROCESSED, r - begin);
+        if (battle_metrics.enabled) metrics_add(battle_metrics.targets_acquired, acquired);
+        cursor->index = r;
+        return r == world->ready_count ? cursor_phase_done(cursor) : false;
+    }
+
+    if (cursor->stage == ACQUIRE_REFRESH) {
+        PROFILE_COUNT(PROFILE_COUNTER_CACHE_REBUILDS, cursor->index == 0);
+        const uint32_t end = slice_end(cursor, count, budget);
+        refresh_stale_targets(world, cursor->index, end);
+        cursor->index = end;
+        if (end < count) return false;
+
+        world->resolved_target_version = combatants->version;
+        cursor_begin_stage(cursor, ACQUIRE_ALL);
+        return false;
+    }
 
-            bundle->is_attacking = (bundle->target.id != UINT32_MAX);
+    //  Distribute targets across multiple weak enemies
+    const uint32_t begin = cursor->index;
+    uint32_t i = begin;
+    uint32_t acquired = 0;
+    for (uint32_t spent = 0; i < count && spent < budget; i++, spent++) {
+        CombatantBundle *bundle = &all_combatants[i];
+
+        // Every handle is fresh here, so this is a plain field read
+        if (bundle->target.dense_index == UINT32_MAX) {
+            acquire_target(world, i, nearest_mode, cursor->enemy_cache_idx);
+            spent += TARGET_SEARCH_COST;
+            acquired++;
         }
     }
+    PROFILE_COUNT(PROFILE_COUNTER_ENTITIES_PROCESSED, i - begin);
+    if (battle_metrics.enabled) metrics_add(battle_metrics.targets_acquired, acquired);
+    cursor->index = i;
+    return i == count ? cursor_phase_done(cursor) : false;
 }
 
-// Batch damage application with prefetching
-void combat_system_execute_attacks(World *world) {
+void combat_system_target_acquisition(World *world) {
+    while (!combat_system_target_acquisition_step(world, UINT32_MAX)) {}
+}
+
+// Advance the action clock and collect the units whose cooldown expires this
+// turn. One wheel advance, so it ignores the budget.
+bool combat_system_schedule_step(World *world, uint32_t budget) {
+    (void)budget;
+    PROFILE_FUNCTION();
+    if (world->schedule_mode != SCHEDULE_COOLDOWN) {
+        world->ready_count = 0;
+        return true;
+    }
+    world->ready_count = timing_wheel_advance(world->action_wheel, world->ready_entities);
+    return true;
+}
+
+void combat_system_schedule(World *world) {
+    combat_system_schedule_step(world, UINT32_MAX);
+}
+
+// Close the distance to the current target (nearest targeting only)
+bool combat_system_movement_step(World *world, uint32_t budget) {
+    if (world->targeting_mode != TARGETING_NEAREST) return true;
+    PROFILE_FUNCTION();
+
+    TurnCursor *cursor = &world->turn_cursor;
+    const EntityManager *em = world->entity_manager;
+    const SparseSet *combatants = world->combatant_storage;
+    CombatantBundle *all_combatants = combatants->dense_data;
+    uint32_t *dense_entities = combatants->dense_entities;
+    uint32_t count = combatants->dense_count;
+    StateHash *hash = world->state_hash;
+    SpatialGrid *grid = world->spatial;
+    const uint32_t end = slice_end(cursor, count, budget);
+    PROFILE_COUNT(PROFILE_COUNTER_ENTITIES_PROCESSED, end - cursor->index);
+
+    for (uint32_t i = cursor->index; i < end; i++) {
+        CombatantBundle *mover = &all_combatants[i];
+        if (!mover->is_attacking) continue;
+
+        uint32_t target_idx = resolved_handle_get(&mover->target, em, combatants);
+        if (target_idx >= count) continue;
+
+        const PositionComponent *goal = &all_combatants[target_idx].position;
+        float dx = goal->x - mover->position.x;
+        float dy = goal->y - mover->position.y;
+        float dist = sqrtf(dx * dx + dy * dy);
+        if (dist <= ATTACK_RANGE) continue;
+
+        // Step up to `speed` units, stopping just inside attack range
+        float step = dist - ATTACK_RANGE * 0.5f;
+        if (step > mover->speed) step = mover->speed;
+        mover->position.x += dx / dist * step;
+        mover->position.y += dy / dist * step;
+        if (hash) state_hash_mark(hash, i);
+        spatial_grid_move(grid, dense_entities[i], mover->position.x, mover->position.y);
+    }
+    cursor->index = end;
+    return end == count ? cursor_phase_done(cursor) : false;
+}
+
+void combat_system_movement(World *world) {
+    while (!combat_system_movement_step(world, UINT32_MAX)) {}
+}
+
+// Queue a combatant whose health dropped to zero (dense index i)
+static void queue_death(World *world, uint32_t i) {
+    uint32_t entity_id = world->combatant_storage->dense_entities[i];
+    Entity dead_entity = {entity_id, world->entity_manager->generation[entity_id]};
+    death_queue_push(world->death_queue, dead_entity);
+
+    JournalRing *journal = event_journal(world);
+    if (journal) {
+        const CombatantBundle *bundle = &((const CombatantBundle*)world->combatant_storage->dense_data)[i];
+        journal_record(journal, world->turn_number, COMBAT_EVENT_DEATH,
+                       entity_id, UINT32_MAX, bundle->health);
+    }
+}
+
+// Apply passes over fewer slots than this stay on the calling thread, where
+// they cost less than starting helper threads
+#define PARALLEL_APPLY_MIN 32768
+#define PARALLEL_APPLY_GRAIN 4096
+
+typedef struct {
+    World *world;
+    const uint32_t *damaged;  // slots to apply (cooldown mode), or NULL for positions themselves
+    uint32_t begin;           // first position of the pass
+} ApplyJob;
+
+// Positions [begin, end) of an apply pass. Deaths go through a per-chunk
+// producer keyed by position, so draining restores the serial queue order.
+static void apply_damage_chunk(void *ctx, uint32_t begin, uint32_t end) {
+    const ApplyJob *job = ctx;
+    World *world = job->world;
     CombatantBundle *all_combatants = world->combatant_storage->dense_data;
-    uint32_t *sparse = world->combatant_storage->sparse;
-    uint32_t count = world->combatant_storage->dense_count;
+    const uint32_t *dense_entities = world->combatant_storage->dense_entities;
+    const uint32_t *generation = world->entity_manager->generation;
+    int32_t *damage_accumulator = world->damage_accumulator;
+    StateHash *hash = world->state_hash;
+
+    DeathQueueProducer producer;
+    death_queue_producer_init(&producer, world->parallel_deaths);
+    for (uint32_t p = job->begin + begin; p < job->begin + end; p++) {
+        const uint32_t i = job->damaged ? job->damaged[p] : p;
+        if (damage_accumulator[i] <= 0) continue;
+
+        CombatantBundle *target = &all_combatants[i];
+        target->health -= damage_accumulator[i];
+        damage_accumulator[i] = 0;
+        if (hash) state_hash_mark_concurrent(hash, i);
+
+        if (target->health <= 0) {
+            const uint32_t entity_id = dense_entities[i];
+            death_queue_producer_push(&producer, (Entity){entity_id, generation[entity_id]}, p);
+        }
+    }
+    death_queue_producer_flush(&producer);
+}
 
-    // Use damage accumulator to reduce random memory access
-    size_t checkpoint = arena_checkpoint(world->battle_arena);
-    int32_t *damage_accumulator = arena_alloc(world->battle_arena, sizeof(int32_t) * count);
-    memset(damage_accumulator, 0, sizeof(int32_t) * count);
+// Apply positions [begin, end) of a pass on worker_threads threads and queue
+// the deaths exactly as the serial pass would. Returns false, having done
+// nothing, when the pass should stay serial: one thread, a small pass, or a
+// journal (its ring belongs to the battle's thread).
+static bool apply_damage_parallel(World *world, const uint32_t *damaged, uint32_t begin, uint32_t end) {
+    if (world->worker_threads <= 1 || end - begin < PARALLEL_APPLY_MIN || event_journal(world)) return false;
+
+    if (!world->parallel_deaths) {
+        ConcurrentDeathQueue *cq = malloc(sizeof(ConcurrentDeathQueue));
+        if (!cq) return false;
+        if (concurrent_death_queue_init(cq, world->combatant_storage->capacity) != 0) {
+            free(cq);
+            return false;
+        }
+        world->parallel_deaths = cq;
+    }
 
-    // First pass: Calculate all damage (read-only, cache-friendly)
-    for (uint32_t i = 0; i < count; i++) {
-        CombatantBundle *attacker = &all_combatants[i];
+    ApplyJob job = {world, damaged, begin};
+    parallel_for(end - begin, PARALLEL_APPLY_GRAIN, world->worker_threads, apply_damage_chunk, &job);
+    if (concurrent_death_queue_drain(world->parallel_deaths, world->death_queue) > 0) {
+        world->turn_cursor.needs_cache_update = true;
+    }
+    return true;
+}
 
-        if (!attacker->is_attacking || attacker->target.id == UINT32_MAX)
-            continue;
+enum {
+    ATTACK_START = 0,
+    ATTACK_ACCUMULATE,  // sum each target's damage into damage_accumulator
+    ATTACK_APPLY        // apply and reset the sums, queueing deaths
+};
+
+// Cooldown mode: only ready units attack, so cost scales with actions taken.
+// Targets hit go to damaged_indices, so the apply pass only visits those.
+static bool execute_scheduled_attacks(World *world, uint32_t budget) {
+    TurnCursor *cursor = &world->turn_cursor;
+    const EntityManager *em = world->entity_manager;
+    const SparseSet *combatants = world->combatant_storage;
+    CombatantBundle *all_combatants = combatants->dense_data;
+    uint32_t count = combatants->dense_count;
+    const bool check_range = (world->targeting_mode == TARGETING_NEAREST);
+    const float range_sq = ATTACK_RANGE * ATTACK_RANGE;
+    JournalRing *journal = event_journal(world);
+    StateHash *hash = world->state_hash;
+
+    TimingWheel *wheel = world->action_wheel;
+    const uint32_t this_turn = wheel->now - 1;
+
+    // Persistent accumulator stays zeroed between turns; only touched slots are reset
+    int32_t *damage_accumulator = world->damage_accumulator;
+    uint32_t *damaged = world->damaged_indices;
+
+    if (cursor->stage == ATTACK_ACCUMULATE) {
+        const uint32_t end = slice_end(cursor, world->ready_count, budget);
+        PROFILE_COUNT(PROFILE_COUNTER_ENTITIES_PROCESSED, end - cursor->index);
+        uint32_t damaged_count = cursor->damaged_count;
+
+        for (uint32_t r = cursor->index; r < end; r++) {
+            uint32_t entity_id = world->ready_entities[r];
+            uint32_t attacker_idx = sparse_set_index_of(combatants, entity_id);
+            if (attacker_idx == UINT32_MAX) continue; // died since it was scheduled
+
+            CombatantBundle *attacker = &all_combatants[attacker_idx];
+
+            // Next action after the cooldown, whether or not this one lands
+            uint32_t interval = (uint32_t)(attacker->attack_cooldown + 0.5f);
+            if (interval < 1) interval = 1;
+            timing_wheel_schedule(wheel, entity_id, this_turn + interval);
+
+            if (!attacker->is_attacking) continue;
+
+            uint32_t target_idx = resolved_handle_get(&attacker->target, em, combatants);
+            if (target_idx >= count) continue;
+
+            CombatantBundle *target = &all_combatants[target_idx];
+            if (target->health <= 0) continue;
+
+            if (check_range) {
+                float dx = target->position.x - attacker->position.x;
+                float dy = target->position.y - attacker->position.y;
+                if (dx * dx + dy * dy > range_sq) continue; // still closing in
+            }
 
-        if (!entity_is_alive(world->entity_manager, attacker->target))
-            continue;
+            int damage = attacker->attack - target->defense;
+            if (damage < 1) damage = 1;
 
-        uint32_t target_idx = sparse[attacker->target.id];
-        if (target_idx >= count) continue;
+            if (damage_accumulator[target_idx] == 0) damaged[damaged_count++] = target_idx;
+            damage_accumulator[target_idx] += damage;
 
-        CombatantBundle *target = &all_combatants[target_idx];
-        if (target->health <= 0) continue;
+            if (journal) {
+                journal_record(journal, world->turn_number, COMBAT_EVENT_HIT,
+                               entity_id, combatants->dense_entities[target_idx], damage);
+            }
+        }
 
-        // Calculate damage
-        int damage = attacker->attack - target->defense;
-        if (damage < 1) damage = 1;
+        cursor->damaged_count = damaged_count;
+        cursor->index = end;
+        if (end < world->ready_count) return false;
+        cursor_begin_stage(cursor, ATTACK_APPLY);
+        return false;
+    }
 
-        // Accumulate damage for this target
-        damage_accumulator[target_idx] += damage;
+    const uint32_t end = slice_end(cursor, cursor->damaged_count, budget);
+    const bool parallel = apply_damage_parallel(world, damaged, cursor->index, end);
+    for (uint32_t d = parallel ? end : cursor->index; d < end; d++) {
+        uint32_t i = damaged[d];
+        CombatantBundle *target = &all_combatants[i];
+        target->health -= damage_accumulator[i];
+        damage_accumulator[i] = 0;
+        if (hash) state_hash_mark(hash, i);
+
+        if (target->health <= 0) {
+            queue_death(world, i);
+            cursor->needs_cache_update = true;
+        }
     }
+    cursor->index = end;
+    if (end < cursor->damaged_count) return false;
 
-    // Second pass: Apply damage and process deaths (single write pass)
-    bool needs_cache_update = false;
+    if (cursor->needs_cache_update) world->needs_target_update = true;
+    return cursor_phase_done(cursor);
+}
 
-    for (uint32_t i = 0; i < count; i++) {
+// Batch damage application using cached target indices
+bool combat_system_execute_attacks_step(World *world, uint32_t budget) {
+    PROFILE_FUNCTION();
+    TurnCursor *cursor = &world->turn_cursor;
+    if (cursor->stage == ATTACK_START) cursor_begin_stage(cursor, ATTACK_ACCUMULATE);
+    if (world->schedule_mode == SCHEDULE_COOLDOWN) {
+        return execute_scheduled_attacks(world, budget);
+    }
+
+    const EntityManager *em = world->entity_manager;
+    const SparseSet *combatants = world->combatant_storage;
+    CombatantBundle *all_combatants = combatants->dense_data;
+    uint32_t count = combatants->dense_count;
+    const bool check_range = (world->targeting_mode == TARGETING_NEAREST);
+    const float range_sq = ATTACK_RANGE * ATTACK_RANGE;
+    JournalRing *journal = event_journal(world);
+    StateHash *hash = world->state_hash;
+
+    // Use damage accumulator to reduce random memory access; it is zero
+    // between turns, and the apply pass resets what it consumes
+    int32_t *damage_accumulator = world->damage_accumulator;
+
+    if (cursor->stage == ATTACK_ACCUMULATE) {
+        // First pass: Calculate all damage (read-only, cache-friendly)
+        const uint32_t end = slice_end(cursor, count, budget);
+        PROFILE_COUNT(PROFILE_COUNTER_ENTITIES_PROCESSED, end - cursor->index);
+        for (uint32_t i = cursor->index; i < end; i++) {
+            CombatantBundle *attacker = &all_combatants[i];
+            if (!attacker->is_attacking) continue;
+
+            // Fresh handles skip both the generation check and the sparse lookup
+            uint32_t target_idx = resolved_handle_get(&attacker->target, em, combatants);
+            if (target_idx >= count) continue;
+
+            CombatantBundle *target = &all_combatants[target_idx];
+            if (target->health <= 0) continue;
+
+            if (check_range) {
+                float dx = target->position.x - attacker->position.x;
+                float dy = target->position.y - attacker->position.y;
+                if (dx * dx + dy * dy > range_sq) continue; // still closing in
+            }
+
+            // Calculate damage
+            int damage = attacker->attack - target->defense;
+            if (damage < 1) damage = 1;
+
+            // Accumulate damage for this target
+            damage_accumulator[target_idx] += damage;
+
+            if (journal) {
+                journal_record(journal, world->turn_number, COMBAT_EVENT_HIT,
+                               combatants->dense_entities[i], combatants->dense_entities[target_idx], damage);
+            }
+        }
+        cursor->index = end;
+        if (end < count) return false;
+        cursor_begin_stage(cursor, ATTACK_APPLY);
+        return false;
+    }
+
+    // Second pass: Apply damage and process deaths (single write pass)
+    const uint32_t end = slice_end(cursor, count, budget);
+    const bool parallel = apply_damage_parallel(world, NULL, cursor->index, end);
+    for (uint32_t i = parallel ? end : cursor->index; i < end; i++) {
         if (damage_accumulator[i] > 0) {
             CombatantBundle *target = &all_combatants[i];
             target->health -= damage_accumulator[i];
+            damage_accumulator[i] = 0;
+            if (hash) state_hash_mark(hash, i);
 
             if (target->health <= 0) {
-                // Get entity ID from dense array
-                uint32_t entity_id = world->combatant_storage->dense_entities[i];
-                Entity dead_entity = {entity_id, world->entity_manager->generation[entity_id]};
-                death_queue_push(world->death_queue, dead_entity);
-
-                // Clear attackers targeting this entity
-                for (uint32_t j = 0; j < count; j++) {
-                    if (all_combatants[j].target.id == entity_id) {
-                        all_combatants[j].target = (Entity){UINT32_MAX, 0};
-                        all_combatants[j].is_attacking = false;
-                    }
-                }
-
-                needs_cache_update = true;
+                queue_death(world, i);
+
+                // Attackers of this entity are not cleared here: removing it bumps the
+                // storage version, so their handles re-resolve as dead next turn
+
+                cursor->needs_cache_update = true;
             }
         }
     }
+    cursor->index = end;
+    if (end < count) return false;
 
-    world->needs_target_update = needs_cache_update;
-    arena_restore(world->battle_arena, checkpoint);
+    world->needs_target_update = cursor->needs_cache_update;
+    return cursor_phase_done(cursor);
 }
 
-// Batch process deaths more efficiently
-void combat_system_process_deaths(World *world) {
-    if (world->death_queue->count == 0) return;
-
-    // Pre-allocate batch removal array
-    size_t checkpoint = arena_checkpoint(world->battle_arena);
-    uint32_t *dead_ids = arena_alloc(world->battle_arena, sizeof(uint32_t) * world->death_queue->count);
+void combat_system_execute_attacks(World *world) {
+    while (!combat_system_execute_attacks_step(world, UINT32_MAX)) {}
+}
 
-    // Collect all dead entity IDs
-    for (size_t i = 0; i < world->death_queue->count; i++) {
-        dead_ids[i] = world->death_queue->entities[i].id;
+// Batch process deaths more efficiently
+bool combat_system_process_deaths_step(World *world, uint32_t budget) {
+    DeathQueue *dq = world->death_queue;
+    TurnCursor *cursor = &world->turn_cursor;
+    if (battle_metrics.enabled && cursor->index == 0) {
+        metrics_add(battle_metrics.deaths, dq->count);
+        metrics_record(battle_metrics.turn_deaths, dq->count);
     }
+    if (dq->count == 0) return true;
+    PROFILE_FUNCTION();
+
+    const uint32_t count = (uint32_t)dq->count;
+    const uint32_t end = slice_end(cursor, count, budget);
+    PROFILE_COUNT(PROFILE_COUNTER_DEATHS, end - cursor->index);
 
     // Batch destroy entities
-    entity_destroy_batch(world->entity_manager, world->death_queue->entities, world->death_queue->count);
+    entity_destroy_batch(world->entity_manager, dq->entities + cursor->index, end - cursor->index);
 
     // Remove from all storages in a single pass
     // This is more cache-friendly than multiple passes
-    for (size_t i = 0; i < world->death_queue->count; i++) {
-        uint32_t entity_id = dead_ids[i];
+    for (uint32_t i = cursor->index; i < end; i++) {
+        uint32_t entity_id = dq->entities[i].id;
 
-        // Remove from combatant storage
+        // Remove from combatant storage (and with it the team index); the last
+        // combatant moves into the hole
         if (entity_id < world->combatant_storage->capacity) {
+            if (world->state_hash) {
+                const uint32_t hole = sparse_set_index_of(world->combatant_storage, entity_id);
+                if (hole != UINT32_MAX) state_hash_mark(world->state_hash, hole);
+            }
             sparse_set_remove(world->combatant_storage, entity_id);
         }
 
-        // Remove from team storages
-        if (entity_id < world->team_a_storage->capacity) {
-            sparse_set_remove(world->team_a_storage, entity_id);
+        // Drop any pending action
+        if (world->schedule_mode == SCHEDULE_COOLDOWN) {
+            timing_wheel_cancel(world->action_wheel, entity_id);
         }
-        if (entity_id < world->team_b_storage->capacity) {
-            sparse_set_remove(world->team_b_storage, entity_id);
+
+        // Remove from the spatial grid (no-op for entities that were never inserted)
+        if (world->targeting_mode == TARGETING_NEAREST) {
+            spatial_grid_remove(world->spatial, entity_id);
         }
     }
+    cursor->index = end;
+    if (end < count) return false;
 
-    arena_restore(world->battle_arena, checkpoint);
-    death_queue_clear(world->death_queue);
+    death_queue_clear(dq);
+    return cursor_phase_done(cursor);
+}
+
+void combat_system_process_deaths(World *world) {
+    while (!combat_system_process_deaths_step(world, UINT32_MAX)) {}
 }
 
 bool combat_system_check_victory(World *world) {
-    uint32_t team_a_alive = world->team_a_storage->dense_count;
-    uint32_t team_b_alive = world->team_b_storage->dense_count;
-
-    if (team_a_alive == 0 || team_b_alive == 0) {
-        printf("\n=== BATTLE COMPLETE ===\n");
-        if (team_a_alive > 0) {
-            printf("Team A wins with %u survivors!\n", team_a_alive);
-        } else if (team_b_alive > 0) {
-            printf("Team B wins with %u survivors!\n", team_b_alive);
-        } else {
-            printf("It's a draw - mutual destruction!\n");
-        }
-        return true;
+    PROFILE_FUNCTION();
+    // Over once no two teams have units left
+    uint32_t teams_alive = 0;
+    for (uint32_t t = 0; t < world->team_count; t++) {
+        if (field_index_count(world->team_index, t) > 0) teams_alive++;
     }
-    return false;
-}
\ No newline at end of file
+    return teams_alive <= 1;
+}
+
+const char* combat_event_name(uint32_t type) {
+    switch (type) {
+        case COMBAT_EVENT_TARGET: return "target";
+        case COMBAT_EVENT_HIT: return "hit";
+        case COMBAT_EVENT_DEATH: return "death";
+        case COMBAT_EVENT_STATE_HASH: return "state_hash";
+        default: return "unknown";
+    }
+}
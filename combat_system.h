@@ -7,9 +7,29 @@
 
 #include "world.h"
 
+// Events recorded into world->journal when it is set
+typedef enum {
+    COMBAT_EVENT_TARGET = 1, // subject picked object as its target (value: object's generation)
+    COMBAT_EVENT_HIT,        // subject hit object for value damage
+    COMBAT_EVENT_DEATH,      // subject died with value health
+    COMBAT_EVENT_STATE_HASH  // end-of-turn state hash: subject alive count, object high 32 bits, value low 32 bits
+} CombatEventType;
+
+void combat_system_schedule(World *world);
 void combat_system_target_acquisition(World *world);
+void combat_system_movement(World *world);
 void combat_system_execute_attacks(World *world);
 void combat_system_process_deaths(World *world);
+
+// The same phases in resumable form: process up to budget items (units, ready
+// entries or deaths) from where world->turn_cursor left off and return true
+// once the phase is complete. A phase must finish before the next one starts.
+bool combat_system_schedule_step(World *world, uint32_t budget);
+bool combat_system_target_acquisition_step(World *world, uint32_t budget);
+bool combat_system_movement_step(World *world, uint32_t budget);
+bool combat_system_execute_attacks_step(World *world, uint32_t budget);
+bool combat_system_process_deaths_step(World *world, uint32_t budget);
 bool combat_system_check_victory(World *world);
+const char* combat_event_name(uint32_t type);
 
 #endif //SPARSE_STORAGE_LEARNING_COMBAT_SYSTEM_H
\ No newline at end of file
@@ -6,6 +6,12 @@
 #define SPARSE_STORAGE_LEARNING_COMPONENTS_H
 #include <stdbool.h>
 #include "ecs_core/entity_manager.h"
+#include "ecs_core/resolved_handle.h"
+
+typedef struct {
+    float x;
+    float y;
+} PositionComponent;
 
 // Reordered for better cache alignment and access patterns
 typedef struct {
@@ -16,15 +22,17 @@ typedef struct {
     uint8_t team_id;      // 1 byte
     bool is_attacking;    // 1 byte
     uint8_t _padding[2];  // 2 bytes padding for alignment
-    Entity target;        // 8 bytes
-    // Total: 24 bytes (fits well in cache)
+    ResolvedHandle target;// 16 bytes (handle + cached dense index)
+    // Total: 32 bytes (half a cache line)
 
     // Cold data - rarely accessed during combat
     int max_health;       // 4 bytes
     float speed;          // 4 bytes
     float attack_cooldown;// 4 bytes
     uint32_t unit_number; // 4 bytes
-    char name[32];        // 32 bytes
+    PositionComponent position; // 8 bytes (only read in nearest targeting mode)
+    // Total: 56 bytes. Names are derived from team_id and unit_number on demand
+    // (unit_format_name), so they take no space here
 } CombatantBundle;
 
 // Simplified component structures for clarity
@@ -8,11 +8,30 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <linux/memfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define ARENA_HAVE_MEMFD 1
+#endif
+
+// Page map entries read per pread
+#define PAGEMAP_BATCH 512
+
+struct ArenaImage {
+    int fd;         // memfd holding the shared contents
+    uint32_t refs;  // arenas mapping it; forks drop theirs on any thread
+};
+
 Arena* arena_create(size_t size) {
     Arena *arena = malloc(sizeof(Arena));
     if (!arena) return NULL;
 
-    arena->buffer = malloc(size);
+    // Zeroed for deterministic behavior; calloc gets fresh zero pages from the OS
+    // for large buffers, so capacity that's never touched is never committed
+    arena->buffer = calloc(1, size);
     if (!arena->buffer) {
         free(arena);
         return NULL;
@@ -20,12 +39,217 @@ Arena* arena_create(size_t size) {
 
     arena->size = size;
     arena->offset = 0;
+    arena->high_water = 0;
     arena->next = NULL;
+    arena->backing = ARENA_HEAP;
+    arena->image = NULL;
+
+    return arena;
+}
 
-    // Zero the memory for deterministic behavior
-    memset(arena->buffer, 0, size);
+#ifdef ARENA_HAVE_MEMFD
+static ArenaImage* image_create(size_t size) {
+    ArenaImage *image = malloc(sizeof(ArenaImage));
+    if (!image) return NULL;
 
+    // A fresh memfd reads as zeros and only commits pages once written
+    image->fd = (int)syscall(SYS_memfd_create, "arena", MFD_CLOEXEC);
+    if (image->fd < 0 || ftruncate(image->fd, (off_t)size) != 0) {
+        if (image->fd >= 0) close(image->fd);
+        free(image);
+        return NULL;
+    }
+    image->refs = 1;
+    return image;
+}
+
+static void image_release(ArenaImage *image) {
+    if (__atomic_sub_fetch(&image->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        close(image->fd);
+        free(image);
+    }
+}
+
+static int write_all(int fd, const uint8_t *data, size_t length, size_t offset) {
+    while (length > 0) {
+        const ssize_t n = pwrite(fd, data, length, (off_t)offset);
+        if (n <= 0) return -1;
+        data += n;
+        length -= (size_t)n;
+        offset += (size_t)n;
+    }
+    return 0;
+}
+
+// Map the arena's image privately over its buffer, dropping any private copies
+static int arena_map_private(Arena *arena) {
+    void *buffer = mmap(arena->buffer, arena->size, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_FIXED, arena->image->fd, 0);
+    if (buffer == MAP_FAILED) return -1;
+    arena->backing = ARENA_PRIVATE;
+    return 0;
+}
+
+// A page of a private file mapping that has been written is anonymous memory:
+// present without the file/shared flag (bit 61), or swapped out (bit 62)
+static inline int pagemap_is_private(uint64_t entry) {
+    return (int)((entry >> 62) & 1) || ((entry >> 63) & 1 && !((entry >> 61) & 1));
+}
+
+// Calls fn for each run of private pages in the first limit bytes of a
+// private arena. Stops at the first non-zero return from fn and returns it;
+// -1 if the page map can't be read.
+typedef int (*PrivateRunFn)(Arena *arena, size_t offset, size_t length, void *ctx);
+
+static int arena_private_runs(Arena *arena, size_t limit, PrivateRunFn fn, void *ctx) {
+    const int fd = open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    const size_t first = (uintptr_t)arena->buffer / page;
+    const size_t pages = (limit + page - 1) / page;
+    uint64_t entries[PAGEMAP_BATCH];
+    size_t run = SIZE_MAX;
+    int rc = 0;
+
+    for (size_t done = 0; done < pages && rc == 0; done += PAGEMAP_BATCH) {
+        const size_t batch = pages - done < PAGEMAP_BATCH ? pages - done : PAGEMAP_BATCH;
+        const size_t bytes = batch * sizeof(uint64_t);
+        if (pread(fd, entries, bytes, (off_t)((first + done) * sizeof(uint64_t))) != (ssize_t)bytes) {
+            rc = -1;
+            break;
+        }
+        for (size_t i = 0; i < batch && rc == 0; i++) {
+            const int is_private = pagemap_is_private(entries[i]);
+            if (is_private && run == SIZE_MAX) {
+                run = done + i;
+            } else if (!is_private && run != SIZE_MAX) {
+                rc = fn(arena, run * page, (done + i - run) * page, ctx);
+                run = SIZE_MAX;
+            }
+        }
+    }
+    if (rc == 0 && run != SIZE_MAX) {
+        const size_t end = pages * page < arena->size ? pages * page : arena->size;
+        rc = fn(arena, run * page, end - run * page, ctx);
+    }
+
+    close(fd);
+    return rc;
+}
+
+static int count_run(Arena *arena, size_t offset, size_t length, void *ctx) {
+    (void)arena;
+    (void)offset;
+    *(size_t*)ctx += length;
+    return 0;
+}
+
+static int found_run(Arena *arena, size_t offset, size_t length, void *ctx) {
+    (void)arena;
+    (void)offset;
+    (void)length;
+    (void)ctx;
+    return 1;
+}
+
+static int write_back_run(Arena *arena, size_t offset, size_t length, void *ctx) {
+    *(size_t*)ctx += length;
+    return write_all(arena->image->fd, arena->buffer + offset, length, offset) == 0 ? 0 : -1;
+}
+
+// Make the arena a private view of an image holding its current contents
+// (up to offset; past it is free space and may read back stale)
+static int arena_sync_image(Arena *arena) {
+    if (arena->backing == ARENA_SHARED) return arena_map_private(arena);
+
+    if (__atomic_load_n(&arena->image->refs, __ATOMIC_ACQUIRE) == 1) {
+        // Nothing else maps the image: write back only the pages we copied
+        size_t written = 0;
+        const int rc = arena_private_runs(arena, arena->offset, write_back_run, &written);
+        if (rc != 0 && write_all(arena->image->fd, arena->buffer, arena->offset, 0) != 0) return -1;
+        return rc == 0 && written == 0 ? 0 : arena_map_private(arena);
+    }
+
+    // Forks still see the image; keep sharing it if we haven't written since
+    if (arena_private_runs(arena, arena->offset, found_run, NULL) == 0) return 0;
+
+    ArenaImage *image = image_create(arena->size);
+    if (!image) return -1;
+    if (write_all(image->fd, arena->buffer, arena->offset, 0) != 0) {
+        image_release(image);
+        return -1;
+    }
+    ArenaImage *old = arena->image;
+    arena->image = image;
+    if (arena_map_private(arena) != 0) {
+        arena->image = old;
+        image_release(image);
+        return -1;
+    }
+    image_release(old);
+    return 0;
+}
+#endif
+
+Arena* arena_create_forkable(size_t size) {
+#ifdef ARENA_HAVE_MEMFD
+    Arena *arena = malloc(sizeof(Arena));
+    ArenaImage *image = arena ? image_create(size) : NULL;
+    void *buffer = image ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, image->fd, 0) : MAP_FAILED;
+    if (buffer != MAP_FAILED) {
+        arena->buffer = buffer;
+        arena->size = size;
+        arena->offset = 0;
+        arena->high_water = 0;
+        arena->next = NULL;
+        arena->backing = ARENA_SHARED;
+        arena->image = image;
+        return arena;
+    }
+    if (image) image_release(image);
+    free(arena);
+#endif
+    return arena_create(size);
+}
+
+Arena* arena_fork(Arena *parent) {
+#ifdef ARENA_HAVE_MEMFD
+    if (parent->backing == ARENA_HEAP || arena_sync_image(parent) != 0) return NULL;
+
+    Arena *arena = malloc(sizeof(Arena));
+    if (!arena) return NULL;
+    void *buffer = mmap(NULL, parent->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, parent->image->fd, 0);
+    if (buffer == MAP_FAILED) {
+        free(arena);
+        return NULL;
+    }
+    __atomic_add_fetch(&parent->image->refs, 1, __ATOMIC_ACQ_REL);
+
+    arena->buffer = buffer;
+    arena->size = parent->size;
+    arena->offset = parent->offset;
+    arena->high_water = parent->high_water;
+    arena->next = NULL;
+    arena->backing = ARENA_PRIVATE;
+    arena->image = parent->image;
     return arena;
+#else
+    (void)parent;
+    return NULL;
+#endif
+}
+
+size_t arena_private_bytes(const Arena *arena) {
+    if (arena->backing == ARENA_SHARED) return 0;
+#ifdef ARENA_HAVE_MEMFD
+    size_t bytes = 0;
+    if (arena->backing == ARENA_PRIVATE &&
+        arena_private_runs((Arena*)arena, arena->size, count_run, &bytes) == 0) {
+        return bytes;
+    }
+#endif
+    return arena->size;
 }
 
 void* arena_alloc(Arena *arena, size_t size) {
@@ -50,18 +274,28 @@ void* arena_alloc_aligned(Arena *arena, size_t size, size_t alignment) {
 
     // Update offset to point past this allocation
     arena->offset = aligned_offset + size;
+    if (arena->offset > arena->high_water) arena->high_water = arena->offset;
 
     return ptr;
 }
 
 void arena_reset(Arena *arena) {
     arena->offset = 0;
+    arena->high_water = 0;
     // Optionally clear memory for deterministic behavior
     // memset(arena->buffer, 0, arena->size);
 }
 
 void arena_destroy(Arena *arena) {
     if (arena) {
+#ifdef ARENA_HAVE_MEMFD
+        if (arena->image) {
+            munmap(arena->buffer, arena->size);
+            image_release(arena->image);
+            free(arena);
+            return;
+        }
+#endif
         free(arena->buffer);
         free(arena);
     }
@@ -14,6 +14,19 @@
  */
 
 #include <stdint.h>
+#include <stddef.h>
+
+/** Shared file behind a forkable arena (opaque, reference counted) */
+typedef struct ArenaImage ArenaImage;
+
+/**
+ * @brief Where an arena's buffer comes from
+ */
+typedef enum {
+    ARENA_HEAP = 0,  /**< calloc'd buffer; can't be forked */
+    ARENA_SHARED,    /**< Shared mapping of its image, writes land in the image */
+    ARENA_PRIVATE    /**< Copy-on-write view of its image, written pages become private copies */
+} ArenaBacking;
 
 /**
  * @brief Linear memory allocator with checkpoint/restore functionality
@@ -23,12 +36,17 @@
  * but the entire arena can be reset or restored to a previous checkpoint.
  *
  * @note Memory is automatically zeroed on creation for deterministic behavior
+ * @note The buffer comes from calloc, so large arenas only commit the pages
+ *       that are actually touched (see memory_resident_bytes())
  */
 typedef struct Arena {
     uint8_t *buffer;      /**< Pointer to the allocated memory buffer */
     size_t size;          /**< Total size of the buffer in bytes */
     size_t offset;        /**< Current allocation offset within the buffer */
+    size_t high_water;    /**< Largest offset reached since creation or the last arena_reset() */
     struct Arena *next;   /**< Pointer to next arena in chain (for future chaining support) */
+    ArenaBacking backing; /**< ARENA_HEAP unless created by arena_create_forkable() or arena_fork() */
+    ArenaImage *image;    /**< Image mapped by forkable arenas, NULL for heap arenas */
 } Arena;
 
 /**
@@ -39,6 +57,46 @@ typedef struct Arena {
  */
 Arena* arena_create(size_t size);
 
+/**
+ * @brief Create an arena that arena_fork() can share copy-on-write
+ * @param size Size of the memory buffer in bytes
+ * @return Pointer to the created Arena, or NULL on failure
+ * @note The buffer is a shared mapping of an anonymous in-memory file
+ *       (memfd), zeroed and committed on touch like arena_create()'s
+ * @note Falls back to a heap arena where memfd isn't available; such
+ *       arenas work the same but arena_fork() refuses them
+ */
+Arena* arena_create_forkable(size_t size);
+
+/**
+ * @brief Create a copy-on-write view of a forkable arena
+ * @param parent Arena created by arena_create_forkable() or arena_fork()
+ * @return New arena with the same contents, offset and size at a different
+ *         address, or NULL if parent isn't forkable or mapping fails
+ * @note Parent and fork share every page until one of them writes it; from
+ *       then on each sees only its own writes. Pointers into parent->buffer
+ *       must be rebased onto the fork's buffer by the caller.
+ * @note The first fork only switches the parent to a private view of its
+ *       image, so it costs page-table setup, not a copy. Further forks reuse
+ *       the image while the parent hasn't written since; otherwise the pages
+ *       it wrote are written back into the image when no fork still shares
+ *       it, or the used part of the buffer is copied into a new image when
+ *       one does.
+ * @note Not thread-safe against concurrent use of parent; forks may be used
+ *       and destroyed on any thread.
+ */
+Arena* arena_fork(Arena *parent);
+
+/**
+ * @brief Bytes of a copy-on-write view that no longer share its image
+ * @param arena Arena to inspect
+ * @return Bytes in pages the arena has written since it last (re)mapped its
+ *         image; 0 for shared arenas, the buffer size for heap arenas or
+ *         when the page map can't be read
+ * @note Reads /proc/self/pagemap, O(size / page size)
+ */
+size_t arena_private_bytes(const Arena *arena);
+
 /**
  * @brief Allocate memory from the arena with default 8-byte alignment
  * @param arena Pointer to the Arena to allocate from
@@ -63,6 +121,7 @@ void* arena_alloc_aligned(Arena *arena, size_t size, size_t alignment);
  * @param arena Pointer to the Arena to reset
  * @note This invalidates all previously allocated pointers from this arena
  * @note Memory is not cleared - use with caution if deterministic state is required
+ * @note Also restarts the high-water mark, so it tracks the peak of one use cycle
  */
 void arena_reset(Arena *arena);
 
@@ -70,6 +129,8 @@ void arena_reset(Arena *arena);
  * @brief Destroy the arena and free all associated memory
  * @param arena Pointer to the Arena to destroy
  * @note This frees both the arena structure and its buffer
+ * @note Destroying a forked arena only drops its view; the image lives on
+ *       while its parent or other forks map it
  */
 void arena_destroy(Arena *arena);
 
@@ -4,11 +4,13 @@
 
 #include "death_queue.h"
 #include <stdlib.h>
+#include <string.h>
 
 #include "storage_manager.h"
 
 void death_queue_init(DeathQueue *dq, size_t initial_capacity) {
     dq->count = 0;
+    dq->peak_count = 0;
     dq->capacity = (initial_capacity > 0) ? initial_capacity : 64;
     dq->entities = malloc(sizeof(Entity) * dq->capacity);
 }
@@ -16,7 +18,7 @@ void death_queue_init(DeathQueue *dq, size_t initial_capacity) {
 void death_queue_free(DeathQueue *dq) {
     free(dq->entities);
     dq->entities = NULL;
-    dq->count = dq->capacity = 0;
+    dq->count = dq->capacity = dq->peak_count = 0;
 }
 
 void death_queue_push(DeathQueue *dq, Entity e) {
@@ -26,6 +28,7 @@ void death_queue_push(DeathQueue *dq, Entity e) {
         dq->entities = realloc(dq->entities, sizeof(Entity) * dq->capacity);
     }
     dq->entities[dq->count++] = e;
+    if (dq->count > dq->peak_count) dq->peak_count = dq->count;
 }
 
 void death_queue_clear(DeathQueue *dq) {
@@ -46,4 +49,85 @@ void process_deaths(DeathQueue *dq, StorageManager *sm, EntityManager *em, Arena
 
     // Clear the queue after processing all destructions
     death_queue_clear(dq);
-}
\ No newline at end of file
+}
+
+int concurrent_death_queue_init(ConcurrentDeathQueue *cq, size_t capacity) {
+    cq->capacity = capacity;
+    cq->reserved = 0;
+    cq->dropped = 0;
+    cq->entries = malloc(sizeof(OrderedDeath) * (capacity > 0 ? capacity : 1));
+    cq->scratch = malloc(sizeof(OrderedDeath) * (capacity > 0 ? capacity : 1));
+    if (!cq->entries || !cq->scratch) {
+        concurrent_death_queue_free(cq);
+        return -1;
+    }
+    return 0;
+}
+
+void concurrent_death_queue_free(ConcurrentDeathQueue *cq) {
+    free(cq->entries);
+    free(cq->scratch);
+    cq->entries = cq->scratch = NULL;
+    cq->capacity = cq->reserved = 0;
+}
+
+int death_queue_producer_flush(DeathQueueProducer *producer) {
+    const size_t count = producer->count;
+    if (count == 0) return 0;
+    ConcurrentDeathQueue *cq = producer->queue;
+    producer->count = 0;
+
+    // The only shared write: claim [start, start + count)
+    const size_t start = __atomic_fetch_add(&cq->reserved, count, __ATOMIC_RELAXED);
+    size_t fits = start < cq->capacity ? cq->capacity - start : 0;
+    if (fits > count) fits = count;
+    memcpy(cq->entries + start, producer->buffer, sizeof(OrderedDeath) * fits);
+
+    if (fits < count) {
+        __atomic_fetch_add(&cq->dropped, count - fits, __ATOMIC_RELAXED);
+        return -1;
+    }
+    return 0;
+}
+
+// Sort key: order first, then entity ID
+static inline uint64_t death_key(const OrderedDeath *d) {
+    return (uint64_t)d->order << 32 | d->entity.id;
+}
+
+size_t concurrent_death_queue_drain(ConcurrentDeathQueue *cq, DeathQueue *dq) {
+    // Producers joined before the drain, which orders their writes before these reads
+    size_t count = __atomic_load_n(&cq->reserved, __ATOMIC_ACQUIRE);
+    if (count > cq->capacity) count = cq->capacity;
+
+    // LSD radix sort by byte, skipping bytes every key shares (typically all
+    // but two or three); stable, so the result only depends on the keys
+    OrderedDeath *src = cq->entries, *dst = cq->scratch;
+    uint64_t all_or = 0, all_and = ~0ull;
+    for (size_t i = 0; i < count; i++) {
+        const uint64_t key = death_key(&src[i]);
+        all_or |= key;
+        all_and &= key;
+    }
+    for (uint32_t shift = 0; shift < 64; shift += 8) {
+        if ((((all_or ^ all_and) >> shift) & 0xFF) == 0) continue;
+
+        size_t offsets[256] = {0};
+        for (size_t i = 0; i < count; i++) offsets[(death_key(&src[i]) >> shift) & 0xFF]++;
+        size_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            const size_t n = offsets[b];
+            offsets[b] = sum;
+            sum += n;
+        }
+        for (size_t i = 0; i < count; i++) dst[offsets[(death_key(&src[i]) >> shift) & 0xFF]++] = src[i];
+
+        OrderedDeath *t = src;
+        src = dst;
+        dst = t;
+    }
+
+    for (size_t i = 0; i < count; i++) death_queue_push(dq, src[i].entity);
+    cq->reserved = 0;
+    return count;
+}
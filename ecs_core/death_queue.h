@@ -27,6 +27,7 @@ typedef struct {
     Entity *entities;  /**< Dynamic array of entity handles pending destruction */
     size_t count;      /**< Number of entities currently queued for destruction */
     size_t capacity;   /**< Allocated capacity for the entities array */
+    size_t peak_count; /**< Largest count since init (survives death_queue_clear()) */
 } DeathQueue;
 
 /**
@@ -69,4 +70,97 @@ void death_queue_clear(DeathQueue *dq);
  */
 void process_deaths(DeathQueue *dq, StorageManager *sm, EntityManager *em, Arena *arena);
 
+/** Deaths a producer buffers before reserving space for them in the shared queue */
+#define DEATH_QUEUE_PRODUCER_BATCH 64
+
+/**
+ * @brief A queued death plus the caller's sort key
+ */
+typedef struct {
+    Entity entity;   /**< Entity handle pending destruction */
+    uint32_t order;  /**< Position in the drained batch (e.g. the dense index the unit died at) */
+} OrderedDeath;
+
+/**
+ * @brief Fixed-capacity death queue that many threads can fill at once
+ *
+ * Producers (see DeathQueueProducer) claim ranges of slots with one atomic
+ * add on `reserved` and copy their deaths in; nothing else is shared, and the
+ * storage is allocated once at init, so it never reallocates. Draining sorts
+ * by (order, entity ID), which makes the batch independent of how the
+ * producers were scheduled, and moves it into a plain DeathQueue for
+ * process_deaths() or the combat systems.
+ *
+ * @note Size it for the most deaths one drain can see (normally the entity
+ *       capacity: an entity dies at most once). Pushes beyond it are dropped
+ *       and counted.
+ */
+typedef struct {
+    OrderedDeath *entries;  /**< capacity slots */
+    OrderedDeath *scratch;  /**< Sort buffer for draining, capacity slots */
+    size_t capacity;
+    size_t reserved;        /**< Slots claimed since the last drain, may exceed capacity (atomic) */
+    size_t dropped;         /**< Deaths that didn't fit since init (atomic) */
+} ConcurrentDeathQueue;
+
+/**
+ * @brief One thread's handle on a ConcurrentDeathQueue
+ *
+ * Buffers up to DEATH_QUEUE_PRODUCER_BATCH deaths locally and reserves space
+ * for them in one go. Each thread uses its own producer; it lives on the
+ * stack for the duration of a parallel section.
+ */
+typedef struct {
+    ConcurrentDeathQueue *queue;
+    uint32_t count;
+    OrderedDeath buffer[DEATH_QUEUE_PRODUCER_BATCH];
+} DeathQueueProducer;
+
+/**
+ * @brief Initialize the queue with room for capacity deaths per drain
+ * @return 0 on success, -1 if the allocation failed
+ */
+int concurrent_death_queue_init(ConcurrentDeathQueue *cq, size_t capacity);
+
+/**
+ * @brief Free the queue's allocated memory
+ */
+void concurrent_death_queue_free(ConcurrentDeathQueue *cq);
+
+/**
+ * @brief Start producing into cq from the calling thread
+ */
+static inline void death_queue_producer_init(DeathQueueProducer *producer, ConcurrentDeathQueue *cq) {
+    producer->queue = cq;
+    producer->count = 0;
+}
+
+/**
+ * @brief Move the producer's buffered deaths into the shared queue
+ * @return 0 on success, -1 if the queue was full and some were dropped
+ */
+int death_queue_producer_flush(DeathQueueProducer *producer);
+
+/**
+ * @brief Queue an entity for destruction from the producer's thread
+ * @param producer The thread's producer
+ * @param e Entity handle to queue
+ * @param order Sort key for the drained batch; unique keys give a fully
+ *              deterministic order, equal keys fall back to the entity ID
+ * @note Buffered until the producer fills up or death_queue_producer_flush()
+ *       is called; flush before the parallel section ends.
+ */
+static inline void death_queue_producer_push(DeathQueueProducer *producer, Entity e, uint32_t order) {
+    if (producer->count == DEATH_QUEUE_PRODUCER_BATCH) death_queue_producer_flush(producer);
+    producer->buffer[producer->count++] = (OrderedDeath){e, order};
+}
+
+/**
+ * @brief Sort everything queued since the last drain and append it to dq
+ * @param cq The shared queue; every producer must have flushed, and none may push during the drain
+ * @param dq Destination, consumed by process_deaths() or the combat systems
+ * @return Number of deaths appended
+ */
+size_t concurrent_death_queue_drain(ConcurrentDeathQueue *cq, DeathQueue *dq);
+
 #endif //SPARSE_STORAGE_LEARNING_DEATH_QUEUE_H
\ No newline at end of file
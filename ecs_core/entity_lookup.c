@@ -0,0 +1,45 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "entity_lookup.h"
+
+uint32_t entity_resolve_batch(const EntityManager *em, const SparseSet *set,
+                              const Entity *handles, const uint32_t count,
+                              uint32_t *out_dense, uint8_t *out_valid) {
+    const uint32_t *generation = em->generation;
+    const uint32_t *sparse = set->sparse;
+    const uint32_t em_capacity = em->capacity;
+    const uint32_t set_capacity = set->capacity;
+    uint32_t resolved = 0;
+
+    // Warm up the pipeline: issue loads for the first handles before resolving any
+    const uint32_t warmup = count < ENTITY_LOOKUP_PREFETCH_DISTANCE ? count : ENTITY_LOOKUP_PREFETCH_DISTANCE;
+    for (uint32_t i = 0; i < warmup; i++) {
+        const uint32_t id = handles[i].id;
+        if (id < em_capacity) ECS_PREFETCH(&generation[id]);
+        if (id < set_capacity) ECS_PREFETCH(&sparse[id]);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        // Keep PREFETCH_DISTANCE handles in flight ahead of the one being resolved
+        if (i + ENTITY_LOOKUP_PREFETCH_DISTANCE < count) {
+            const uint32_t ahead = handles[i + ENTITY_LOOKUP_PREFETCH_DISTANCE].id;
+            if (ahead < em_capacity) ECS_PREFETCH(&generation[ahead]);
+            if (ahead < set_capacity) ECS_PREFETCH(&sparse[ahead]);
+        }
+
+        const Entity e = handles[i];
+        uint32_t index = UINT32_MAX;
+        if (e.id < em_capacity && generation[e.id] == e.generation && e.id < set_capacity) {
+            index = sparse[e.id];
+        }
+
+        const uint8_t valid = index != UINT32_MAX;
+        out_dense[i] = index;
+        out_valid[i] = valid;
+        resolved += valid;
+    }
+
+    return resolved;
+}
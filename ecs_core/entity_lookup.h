@@ -0,0 +1,101 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_ENTITY_LOOKUP_H
+#define SPARSE_STORAGE_LEARNING_ENTITY_LOOKUP_H
+
+/**
+ * @file entity_lookup.h
+ * @brief Inline fast paths for handle validation and sparse-index resolution
+ *
+ * Combat systems validate a handle and then map its ID to a dense index for
+ * every combatant on every turn. The out-of-line entity_is_alive() and
+ * sparse_set_get() cost a call per lookup; these static inline variants let
+ * the compiler fold the checks into the calling loop. For whole arrays of
+ * handles, entity_resolve_batch() software-prefetches generation[] and
+ * sparse[] ahead of use so the random loads overlap instead of stalling
+ * one after another.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "entity_manager.h"
+#include "sparse_set_storage.h"
+
+/** How many handles ahead entity_resolve_batch() prefetches */
+#define ENTITY_LOOKUP_PREFETCH_DISTANCE 16
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ECS_PREFETCH(addr) __builtin_prefetch((addr), 0, 1)
+#define ECS_LIKELY(x) __builtin_expect(!!(x), 1)
+#define ECS_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#else
+#define ECS_PREFETCH(addr) ((void)(addr))
+#define ECS_LIKELY(x) (x)
+#define ECS_UNLIKELY(x) (x)
+#endif
+
+/**
+ * @brief Inline handle validation
+ * @param em Pointer to the EntityManager
+ * @param e Entity handle to validate
+ * @return 1 if the entity is alive, 0 otherwise
+ * @note Unlike entity_is_alive(), IDs outside the manager's capacity (including
+ *       the UINT32_MAX "no entity" sentinel) are rejected instead of read out of bounds
+ */
+static inline int entity_is_alive_fast(const EntityManager *em, Entity e) {
+    return e.id < em->capacity && em->generation[e.id] == e.generation;
+}
+
+/**
+ * @brief Inline lookup of an entity's dense index
+ * @param set Pointer to the SparseSet
+ * @param entity Entity ID to look up
+ * @return Dense index, or UINT32_MAX if the entity is not in the set
+ */
+static inline uint32_t sparse_set_index_of(const SparseSet *set, uint32_t entity) {
+    return entity < set->capacity ? set->sparse[entity] : UINT32_MAX;
+}
+
+/**
+ * @brief Inline variant of sparse_set_get()
+ * @param set Pointer to the SparseSet
+ * @param entity Entity ID to look up
+ * @return Pointer to component data, or NULL if absent or the set is index-only
+ */
+static inline void* sparse_set_get_fast(const SparseSet *set, uint32_t entity) {
+    const uint32_t index = sparse_set_index_of(set, entity);
+    if (index == UINT32_MAX || set->comp_size == 0) return NULL;
+    return (char*)set->dense_data + (size_t)index * set->comp_size;
+}
+
+/**
+ * @brief Validate a handle and resolve it to a dense index in one step
+ * @param em Pointer to the EntityManager that issued the handle
+ * @param set Pointer to the SparseSet to resolve into
+ * @param e Entity handle to resolve
+ * @return Dense index, or UINT32_MAX if the handle is stale or the entity is not in the set
+ */
+static inline uint32_t entity_resolve(const EntityManager *em, const SparseSet *set, Entity e) {
+    if (!entity_is_alive_fast(em, e)) return UINT32_MAX;
+    return sparse_set_index_of(set, e.id);
+}
+
+/**
+ * @brief Validate and resolve an array of handles with software prefetching
+ * @param em Pointer to the EntityManager that issued the handles
+ * @param set Pointer to the SparseSet to resolve into
+ * @param handles Array of handles to resolve (invalid/sentinel handles are allowed)
+ * @param count Number of handles
+ * @param out_dense Output dense indices, UINT32_MAX for handles that did not resolve
+ * @param out_valid Output validity mask, 1 where out_dense holds a usable index
+ * @return Number of handles that resolved
+ * @note out_dense and out_valid must each hold count elements
+ */
+uint32_t entity_resolve_batch(const EntityManager *em, const SparseSet *set,
+                              const Entity *handles, uint32_t count,
+                              uint32_t *out_dense, uint8_t *out_valid);
+
+#endif //SPARSE_STORAGE_LEARNING_ENTITY_LOOKUP_H
@@ -4,6 +4,7 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include "entity_manager.h"
 /**
  * @note uint32_t provides consistency across platforms with exactly 32 bits
@@ -13,6 +14,7 @@
 void entity_manager_init(EntityManager *em, const uint32_t capacity) {
     em->capacity = capacity;
     em->living_count = 0;
+    em->peak_living = 0;
 
     // Use calloc for generation array to ensure initial values are 0
     em->generation = calloc(capacity, sizeof(uint32_t));
@@ -30,6 +32,16 @@ void entity_manager_init(EntityManager *em, const uint32_t capacity) {
     em->free_count = capacity;
 }
 
+void entity_manager_copy(EntityManager *em, const EntityManager *src) {
+    *em = *src;
+    em->generation = malloc(sizeof(uint32_t) * src->capacity);
+    em->free_ids = malloc(sizeof(uint32_t) * src->capacity);
+    memcpy(em->generation, src->generation, sizeof(uint32_t) * src->capacity);
+
+    // Slots past free_count are never read before being pushed
+    memcpy(em->free_ids, src->free_ids, sizeof(uint32_t) * src->free_count);
+}
+
 Entity entity_create(EntityManager *em) {
     if (em->free_count == 0) {
         return (Entity){ UINT32_MAX, 0}; // Return invalid entity handle
@@ -40,11 +52,28 @@ Entity entity_create(EntityManager *em) {
     const uint32_t id = em->free_ids[--em->free_count];
 
     em->living_count++;
+    if (em->living_count > em->peak_living) em->peak_living = em->living_count;
 
     // Return handle with ID and current generation for that ID
     return (Entity){id, em->generation[id]};
 }
 
+uint32_t entity_create_batch(EntityManager *em, uint32_t count, uint32_t *out_ids) {
+    if (count > em->free_count) {
+        count = em->free_count;
+    }
+
+    // Popping one at a time walks the top of the free stack downwards
+    for (uint32_t i = 0; i < count; i++) {
+        out_ids[i] = em->free_ids[em->free_count - 1 - i];
+    }
+
+    em->free_count -= count;
+    em->living_count += count;
+    if (em->living_count > em->peak_living) em->peak_living = em->living_count;
+    return count;
+}
+
 void entity_destroy(EntityManager *em, Entity e) {
     const uint32_t id = e.id;
 
@@ -81,5 +110,6 @@ void entity_manager_free(EntityManager *em) {
         em->capacity = 0;
         em->living_count = 0;
         em->free_count = 0;
+        em->peak_living = 0;
     }
 }
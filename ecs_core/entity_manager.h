@@ -50,6 +50,7 @@ typedef struct {
     uint32_t capacity;    /**< Maximum number of entities supported */
     uint32_t living_count; /**< Number of currently active entities */
     uint32_t free_count;  /**< Number of IDs available in the free stack */
+    uint32_t peak_living; /**< Largest living_count since init */
 } EntityManager;
 
 /**
@@ -60,6 +61,15 @@ typedef struct {
  */
 void entity_manager_init(EntityManager *em, uint32_t capacity);
 
+/**
+ * @brief Initialize an entity manager as a copy of another
+ * @param em Pointer to the EntityManager to initialize
+ * @param src Entity manager to copy
+ * @note Copies the generations and only the occupied part of the free stack,
+ *       so it's cheaper than entity_manager_init() followed by a full copy
+ */
+void entity_manager_copy(EntityManager *em, const EntityManager *src);
+
 /**
  * @brief Create a new entity and return its handle
  * @param em Pointer to the EntityManager
@@ -68,6 +78,17 @@ void entity_manager_init(EntityManager *em, uint32_t capacity);
  */
 Entity entity_create(EntityManager *em);
 
+/**
+ * @brief Create up to count entities in one call
+ * @param em Pointer to the EntityManager
+ * @param count Number of entities to create
+ * @param out_ids Receives the new entity IDs (at least count slots)
+ * @return Number of entities created (less than count only when at capacity)
+ * @note IDs come out in the same order as count calls to entity_create();
+ *       the handle for out_ids[i] is {out_ids[i], em->generation[out_ids[i]]}
+ */
+uint32_t entity_create_batch(EntityManager *em, uint32_t count, uint32_t *out_ids);
+
 /**
  * @brief Destroy an entity and invalidate its handle
  * @param em Pointer to the EntityManager
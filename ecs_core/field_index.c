@@ -0,0 +1,232 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "field_index.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+int field_index_init(FieldIndex *index, SparseSet *source, const size_t key_offset, const size_t key_size,
+                     const uint32_t bucket_count, Arena *arena) {
+    if (source->comp_size == 0 || key_offset + key_size > source->comp_size ||
+        (key_size != 1 && key_size != 2 && key_size != 4) ||
+        bucket_count == 0 || bucket_count > FIELD_INDEX_MAX_BUCKETS) {
+        return -1;
+    }
+
+    index->source = source;
+    index->key_offset = key_offset;
+    index->key_size = key_size;
+    index->bucket_count = bucket_count;
+    sparse_set_init(&index->members, source->capacity, 0, arena);
+    index->members.index_owned = true;
+
+    // Every bucket starts empty at slot 0, with all the slack after the last one
+    memset(index->bucket_start, 0, sizeof(index->bucket_start));
+    memset(index->bucket_size, 0, sizeof(index->bucket_size));
+    index->bucket_start[bucket_count] = source->capacity;
+
+    // Attach, then index what the set already holds in dense order
+    index->next = source->indices;
+    source->indices = index;
+    for (uint32_t i = 0; i < source->dense_count; i++) {
+        field_index_update(index, source->dense_entities[i]);
+    }
+    return 0;
+}
+
+uint32_t field_index_key(const FieldIndex *index, const void *component) {
+    const uint8_t *field = (const uint8_t*)component + index->key_offset;
+    switch (index->key_size) {
+        case 1: return *field;
+        case 2: { uint16_t k; memcpy(&k, field, sizeof(k)); return k; }
+        default: { uint32_t k; memcpy(&k, field, sizeof(k)); return k; }
+    }
+}
+
+// Bucket whose range (live entities plus slack) holds dense index pos
+static uint32_t bucket_of(const FieldIndex *index, const uint32_t pos) {
+    uint32_t lo = 0, hi = index->bucket_count;
+    while (hi - lo > 1) {
+        const uint32_t mid = (lo + hi) / 2;
+        if (index->bucket_start[mid] <= pos) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static uint32_t slack_after(const FieldIndex *index, const uint32_t b) {
+    return index->bucket_start[b + 1] - index->bucket_start[b] - index->bucket_size[b];
+}
+
+static void place(FieldIndex *index, const uint32_t pos, const uint32_t entity) {
+    index->members.dense_entities[pos] = entity;
+    index->members.sparse[entity] = pos;
+}
+
+// The members set's dense range ends with the last bucket's live entities
+static void update_extent(FieldIndex *index) {
+    SparseSet *m = &index->members;
+    const uint32_t last = index->bucket_count - 1;
+    m->dense_count = index->bucket_start[last] + index->bucket_size[last];
+    if (m->dense_count > m->peak_count) m->peak_count = m->dense_count;
+}
+
+static void insert(FieldIndex *index, const uint32_t entity, const uint32_t key) {
+    SparseSet *m = &index->members;
+
+    if (slack_after(index, key) == 0) {
+        // Borrow a slot from the nearest bucket with slack, later ones first:
+        // each bucket in between moves its first entity past its end (or,
+        // from the left, its last before its start) and shifts by one
+        uint32_t c = key + 1;
+        while (c < index->bucket_count && slack_after(index, c) == 0) c++;
+
+        if (c < index->bucket_count) {
+            for (uint32_t b = c; b > key; b--) {
+                const uint32_t first = index->bucket_start[b];
+                if (index->bucket_size[b] > 0) place(index, first + index->bucket_size[b], m->dense_entities[first]);
+                index->bucket_start[b]++;
+            }
+        } else {
+            c = key;
+            while (c-- > 0 && slack_after(index, c) == 0) {}
+            for (uint32_t b = c + 1; b <= key; b++) {
+                const uint32_t last = index->bucket_start[b] + index->bucket_size[b] - 1;
+                if (index->bucket_size[b] > 0) place(index, index->bucket_start[b] - 1, m->dense_entities[last]);
+                index->bucket_start[b]--;
+            }
+        }
+        m->version++;
+    }
+
+    place(index, index->bucket_start[key] + index->bucket_size[key]++, entity);
+    update_extent(index);
+}
+
+void field_index_remove(FieldIndex *index, const uint32_t entity) {
+    SparseSet *m = &index->members;
+    if (entity >= m->capacity) return;
+    const uint32_t pos = m->sparse[entity];
+    if (pos == UINT32_MAX) return;
+
+    // Swap-and-pop within the bucket; the freed slot becomes its slack
+    const uint32_t key = bucket_of(index, pos);
+    const uint32_t last = index->bucket_start[key] + --index->bucket_size[key];
+    if (last != pos) place(index, pos, m->dense_entities[last]);
+    m->dense_entities[last] = UINT32_MAX;
+    m->sparse[entity] = UINT32_MAX;
+
+    m->version++;
+    update_extent(index);
+}
+
+void field_index_update(FieldIndex *index, const uint32_t entity) {
+    const void *component = sparse_set_get(index->source, entity);
+    if (!component) {
+        field_index_remove(index, entity);
+        return;
+    }
+
+    const uint32_t key = field_index_key(index, component);
+    const uint32_t pos = index->members.sparse[entity];
+    if (pos != UINT32_MAX) {
+        if (key < index->bucket_count && bucket_of(index, pos) == key) return;
+        field_index_remove(index, entity);
+    }
+    if (key < index->bucket_count) insert(index, entity, key);
+}
+
+// Lay the buckets out back to back, each with room for extra[b] more
+// entities, moving their members; the slack all ends up after the last one.
+// Buckets moving left go in ascending order and those moving right in
+// descending order, so none lands on one that hasn't moved yet.
+static void make_room(FieldIndex *index, const uint32_t *extra) {
+    SparseSet *m = &index->members;
+    const uint32_t old_extent = m->dense_count;
+    uint32_t new_start[FIELD_INDEX_MAX_BUCKETS];
+    uint32_t end = 0;
+    for (uint32_t b = 0; b < index->bucket_count; b++) {
+        new_start[b] = end;
+        end += index->bucket_size[b] + extra[b];
+    }
+
+    for (uint32_t b = 0; b < index->bucket_count; b++) {
+        if (new_start[b] >= index->bucket_start[b]) continue;
+        for (uint32_t i = 0; i < index->bucket_size[b]; i++) {
+            place(index, new_start[b] + i, m->dense_entities[index->bucket_start[b] + i]);
+        }
+        index->bucket_start[b] = new_start[b];
+    }
+    for (uint32_t b = index->bucket_count; b-- > 0;) {
+        if (new_start[b] <= index->bucket_start[b]) continue;
+        for (uint32_t i = index->bucket_size[b]; i-- > 0;) {
+            place(index, new_start[b] + i, m->dense_entities[index->bucket_start[b] + i]);
+        }
+        index->bucket_start[b] = new_start[b];
+    }
+
+    // Slots the move vacated past the new end become slack
+    for (uint32_t i = end; i < old_extent; i++) m->dense_entities[i] = UINT32_MAX;
+    m->version++;
+}
+
+void field_index_update_dense(FieldIndex *index, const uint32_t dense_begin, const uint32_t count) {
+    const SparseSet *source = index->source;
+    const SparseSet *m = &index->members;
+    const uint8_t *components = source->dense_data;
+
+    // Counting pass: re-key entities already indexed, count the fresh ones per key
+    uint32_t extra[FIELD_INDEX_MAX_BUCKETS] = {0};
+    for (uint32_t i = dense_begin; i < dense_begin + count; i++) {
+        const uint32_t entity = source->dense_entities[i];
+        if (m->sparse[entity] != UINT32_MAX) {
+            field_index_update(index, entity);
+            continue;
+        }
+        const uint32_t key = field_index_key(index, components + (size_t)i * source->comp_size);
+        if (key < index->bucket_count) extra[key]++;
+    }
+    bool fits = true;
+    for (uint32_t b = 0; b < index->bucket_count; b++) fits = fits && extra[b] <= slack_after(index, b);
+
+    // One move of the existing members at most, then every fresh entity is
+    // appended to its bucket in dense order
+    if (!fits) make_room(index, extra);
+    uint32_t next[FIELD_INDEX_MAX_BUCKETS];
+    for (uint32_t b = 0; b < index->bucket_count; b++) {
+        next[b] = index->bucket_start[b] + index->bucket_size[b];
+        index->bucket_size[b] += extra[b];
+    }
+    for (uint32_t i = dense_begin; i < dense_begin + count; i++) {
+        const uint32_t entity = source->dense_entities[i];
+        if (m->sparse[entity] != UINT32_MAX) continue;
+        const uint32_t key = field_index_key(index, components + (size_t)i * source->comp_size);
+        if (key < index->bucket_count) place(index, next[key]++, entity);
+    }
+    update_extent(index);
+}
+
+void field_index_recount(FieldIndex *index) {
+    const SparseSet *m = &index->members;
+    memset(index->bucket_size, 0, sizeof(index->bucket_size));
+    for (uint32_t b = 0; b < index->bucket_count; b++) index->bucket_start[b] = UINT32_MAX;
+    index->bucket_start[index->bucket_count] = m->capacity;
+
+    // A bucket's live entities start its range; the slots in between hold UINT32_MAX
+    for (uint32_t i = 0; i < m->dense_count; i++) {
+        const uint32_t entity = m->dense_entities[i];
+        if (entity >= m->capacity || m->sparse[entity] != i) continue;
+        const void *component = sparse_set_get(index->source, entity);
+        const uint32_t key = component ? field_index_key(index, component) : UINT32_MAX;
+        if (key >= index->bucket_count) continue;
+        if (index->bucket_size[key]++ == 0) index->bucket_start[key] = i;
+    }
+
+    uint32_t end = 0;
+    for (uint32_t b = 0; b < index->bucket_count; b++) {
+        if (index->bucket_size[b] == 0) index->bucket_start[b] = end;
+        end = index->bucket_start[b] + index->bucket_size[b];
+    }
+}
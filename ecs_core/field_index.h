@@ -0,0 +1,143 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_FIELD_INDEX_H
+#define SPARSE_STORAGE_LEARNING_FIELD_INDEX_H
+
+/**
+ * @file field_index.h
+ * @brief Secondary index grouping a SparseSet's entities by a component field
+ *
+ * A FieldIndex is declared once on a component set with the offset and size
+ * of an integer field (FIELD_INDEX_KEY) and a number of buckets. From then on
+ * the set keeps it up to date itself: sparse_set_add() indexes new entities
+ * and re-keys updated ones, sparse_set_remove() drops them, and
+ * sparse_set_notify_written() covers components written in place, such as
+ * the slots sparse_set_add_batch() hands out.
+ *
+ * Members live in the dense array of an index-only SparseSet, one contiguous
+ * range per bucket in key order, so "every entity with key k" is
+ * field_index_bucket() and costs O(bucket), not a scan of the set. A bucket
+ * behaves like a SparseSet of its own: removal moves its last entity into
+ * the hole and leaves the freed slot as slack after the bucket, touching no
+ * other bucket, so a bucket's order only depends on its own history. Inserts
+ * append into that slack; a bucket without any borrows a slot from the
+ * nearest bucket that has some by shifting the buckets in between one slot
+ * over, one move each (which rotates those buckets by one).
+ *
+ * Because members is an ordinary SparseSet it can be registered with a
+ * StorageManager like any storage, so snapshots, forks and memory reports
+ * carry it; its dense_count covers the slack between buckets, whose slots
+ * hold UINT32_MAX. It is marked index_owned, so sparse_set_add() and
+ * sparse_set_remove() on it (e.g. a StorageManager removing a dead entity
+ * from every storage) are no-ops; only the source set's hooks move its
+ * entities, whatever order the sets are registered in.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "sparse_set_storage.h"
+
+/** Largest bucket count an index supports */
+#define FIELD_INDEX_MAX_BUCKETS 256
+
+/** Offset and size arguments for field_index_init(), e.g. FIELD_INDEX_KEY(CombatantBundle, team_id) */
+#define FIELD_INDEX_KEY(type, field) offsetof(type, field), sizeof(((type*)0)->field)
+
+/**
+ * @brief Buckets of a source set's entities keyed by one component field
+ */
+typedef struct FieldIndex {
+    SparseSet *source;        /**< Component set the keys are read from */
+    SparseSet members;        /**< Index-only set of indexed entities, grouped by key */
+    size_t key_offset;        /**< Byte offset of the key field in the component */
+    size_t key_size;          /**< Key field size: 1, 2 or 4 bytes, read as unsigned */
+    uint32_t bucket_count;    /**< Keys 0 .. bucket_count - 1 are indexed; others are left out */
+    uint32_t bucket_start[FIELD_INDEX_MAX_BUCKETS + 1]; /**< First dense index per bucket; the last entry is the capacity */
+    uint32_t bucket_size[FIELD_INDEX_MAX_BUCKETS];      /**< Entities per bucket */
+    struct FieldIndex *next;  /**< Next index on the same source set */
+} FieldIndex;
+
+/**
+ * @brief Declare an index on a component set and index what it already holds
+ * @param index FieldIndex to initialize; must stay at this address while attached
+ * @param source Component set to index (not index-only)
+ * @param key_offset Offset of the key field within the component
+ * @param key_size Size of the key field: 1, 2 or 4
+ * @param bucket_count Number of keys indexed, at most FIELD_INDEX_MAX_BUCKETS
+ * @param arena Arena for the members set, usually the source set's
+ * @return 0 on success, -1 for an unsupported key or bucket count
+ * @note Attaches to source until sparse_set_init() re-initializes it;
+ *       declare the index again afterwards.
+ */
+int field_index_init(FieldIndex *index, SparseSet *source, size_t key_offset, size_t key_size,
+                     uint32_t bucket_count, Arena *arena);
+
+/**
+ * @brief Entities with a given key
+ * @param index Pointer to the FieldIndex
+ * @param key Key to look up
+ * @param count Set to the number of entities in the bucket (0 for keys out of range)
+ * @return Entity IDs of the bucket, contiguous; valid until the index changes
+ */
+static inline const uint32_t* field_index_bucket(const FieldIndex *index, uint32_t key, uint32_t *count) {
+    if (key >= index->bucket_count) {
+        *count = 0;
+        return index->members.dense_entities;
+    }
+    *count = index->bucket_size[key];
+    return index->members.dense_entities + index->bucket_start[key];
+}
+
+/**
+ * @brief Number of entities with a given key
+ */
+static inline uint32_t field_index_count(const FieldIndex *index, uint32_t key) {
+    return key < index->bucket_count ? index->bucket_size[key] : 0;
+}
+
+/**
+ * @brief Key a component currently has
+ */
+uint32_t field_index_key(const FieldIndex *index, const void *component);
+
+/**
+ * @brief Index an entity, or move it to the bucket its key now selects
+ * @param index Pointer to the FieldIndex
+ * @param entity Entity ID, which must be in the source set
+ * @note Called by the source set's hooks; entities whose key is out of range
+ *       are dropped from the index.
+ */
+void field_index_update(FieldIndex *index, uint32_t entity);
+
+/**
+ * @brief Index (or re-key) the source set's entities in a run of dense slots
+ * @param index Pointer to the FieldIndex
+ * @param dense_begin First dense index of the run in the source set
+ * @param count Number of slots
+ * @note What sparse_set_notify_written() calls. Entities not yet indexed are
+ *       counted per key, the buckets are laid out back to back once if their
+ *       slack can't take them, and each is appended to its bucket in dense
+ *       order: O(count + members) for a whole army, where one
+ *       field_index_update() per entity could shift buckets for every one.
+ */
+void field_index_update_dense(FieldIndex *index, uint32_t dense_begin, uint32_t count);
+
+/**
+ * @brief Drop an entity from the index; a no-op if it isn't indexed
+ */
+void field_index_remove(FieldIndex *index, uint32_t entity);
+
+/**
+ * @brief Recompute the bucket bounds from the members set
+ * @param index Pointer to the FieldIndex
+ * @note For when the members set's arrays were replaced wholesale (e.g. by a
+ *       snapshot load). Members keep their slots; an empty bucket is placed
+ *       right after the one before it.
+ */
+void field_index_recount(FieldIndex *index);
+
+#endif //SPARSE_STORAGE_LEARNING_FIELD_INDEX_H
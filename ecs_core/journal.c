@@ -0,0 +1,440 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "journal.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define JOURNAL_MAGIC "ECSJRNL\0"
+#define JOURNAL_FOOTER_MAGIC "JRNLEND\0"
+#define JOURNAL_HEADER_BYTES 16
+#define JOURNAL_FOOTER_BYTES 16
+#define JOURNAL_MAX_EVENT_BYTES 32   // five varints, each at most five bytes
+#define JOURNAL_IDLE_SLEEP_NS 200000 // writer poll interval while every ring is empty
+
+enum {
+    JOURNAL_BLOCK_DATA = 1,
+    JOURNAL_BLOCK_INDEX = 2
+};
+
+typedef struct {
+    uint8_t kind;
+    uint8_t ring;
+    uint16_t reserved;
+    uint32_t payload_bytes;
+    uint32_t event_count;   // events for data blocks, entries for index blocks
+    uint32_t first_turn;
+    uint32_t last_turn;
+} JournalBlockHeader;
+
+// Index block payload: u64 offset of the previous index block (0 if none), then entries
+typedef struct {
+    uint64_t offset;
+    uint32_t first_turn;
+    uint32_t last_turn;
+} JournalIndexEntry;
+
+// One open data block per ring; only the writer thread touches these
+typedef struct {
+    uint8_t buf[JOURNAL_BLOCK_BYTES + JOURNAL_MAX_EVENT_BYTES];
+    size_t len;
+    uint32_t count;
+    uint32_t first_turn;
+    uint32_t last_turn;
+    uint32_t prev_turn;
+    uint32_t prev_subject;
+    uint32_t prev_object;
+} BlockEncoder;
+
+struct Journal {
+    FILE *file;
+    uint32_t ring_count;
+    JournalRing *rings;
+    BlockEncoder *encoders;
+    JournalIndexEntry pending[JOURNAL_INDEX_INTERVAL]; // data blocks since the last index
+    uint32_t pending_count;
+    uint64_t last_index_offset;
+    uint64_t offset;        // bytes written (atomic)
+    int stop;               // set by journal_close (atomic)
+    int error;
+    pthread_t thread;
+};
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static inline size_t put_varint(uint8_t *out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+// Returns bytes consumed, 0 if the varint runs past end or is too long
+static inline size_t get_varint(const uint8_t *in, const uint8_t *end, uint64_t *out) {
+    uint64_t v = 0;
+    for (size_t n = 0; n < 10 && in + n < end; n++) {
+        v |= (uint64_t)(in[n] & 0x7f) << (7 * n);
+        if (!(in[n] & 0x80)) {
+            *out = v;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+static void journal_write(Journal *journal, const void *data, size_t size) {
+    if (fwrite(data, 1, size, journal->file) != size) journal->error = 1;
+    __atomic_store_n(&journal->offset, journal->offset + size, __ATOMIC_RELAXED);
+}
+
+static void write_index_block(Journal *journal) {
+    if (journal->pending_count == 0) return;
+
+    JournalBlockHeader header = {
+        .kind = JOURNAL_BLOCK_INDEX,
+        .payload_bytes = (uint32_t)(sizeof(uint64_t) + sizeof(JournalIndexEntry) * journal->pending_count),
+        .event_count = journal->pending_count,
+        .first_turn = journal->pending[0].first_turn,
+        .last_turn = journal->pending[journal->pending_count - 1].last_turn,
+    };
+
+    const uint64_t offset = journal->offset;
+    journal_write(journal, &header, sizeof(header));
+    journal_write(journal, &journal->last_index_offset, sizeof(uint64_t));
+    journal_write(journal, journal->pending, sizeof(JournalIndexEntry) * journal->pending_count);
+    journal->last_index_offset = offset;
+    journal->pending_count = 0;
+}
+
+static void flush_block(Journal *journal, uint32_t ring) {
+    BlockEncoder *enc = &journal->encoders[ring];
+    if (enc->count == 0) return;
+
+    JournalBlockHeader header = {
+        .kind = JOURNAL_BLOCK_DATA,
+        .ring = (uint8_t)ring,
+        .payload_bytes = (uint32_t)enc->len,
+        .event_count = enc->count,
+        .first_turn = enc->first_turn,
+        .last_turn = enc->last_turn,
+    };
+
+    journal->pending[journal->pending_count++] = (JournalIndexEntry){
+        journal->offset, enc->first_turn, enc->last_turn
+    };
+    journal_write(journal, &header, sizeof(header));
+    journal_write(journal, enc->buf, enc->len);
+
+    enc->len = 0;
+    enc->count = 0;
+    enc->prev_turn = 0;
+    enc->prev_subject = 0;
+    enc->prev_object = 0;
+
+    if (journal->pending_count == JOURNAL_INDEX_INTERVAL) write_index_block(journal);
+}
+
+static void encode_event(Journal *journal, uint32_t ring, const JournalEvent *event) {
+    BlockEncoder *enc = &journal->encoders[ring];
+    if (enc->count == 0) {
+        enc->first_turn = event->turn;
+        enc->last_turn = event->turn;
+    }
+
+    uint8_t *out = enc->buf + enc->len;
+    const bool turn_changed = enc->count == 0 || event->turn != enc->prev_turn;
+    size_t n = put_varint(out, ((uint64_t)event->type << 1) | turn_changed);
+    if (turn_changed) n += put_varint(out + n, zigzag((int32_t)(event->turn - enc->prev_turn)));
+    n += put_varint(out + n, zigzag((int32_t)(event->subject - enc->prev_subject)));
+    n += put_varint(out + n, zigzag((int32_t)(event->object - enc->prev_object)));
+    n += put_varint(out + n, zigzag(event->value));
+
+    enc->len += n;
+    enc->count++;
+    enc->prev_turn = event->turn;
+    enc->prev_subject = event->subject;
+    enc->prev_object = event->object;
+    if (event->turn > enc->last_turn) enc->last_turn = event->turn;
+    if (event->turn < enc->first_turn) enc->first_turn = event->turn;
+
+    if (enc->len >= JOURNAL_BLOCK_BYTES) flush_block(journal, ring);
+}
+
+static uint64_t drain_ring(Journal *journal, uint32_t r) {
+    JournalRing *ring = &journal->rings[r];
+    const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    const uint64_t tail = ring->tail;
+
+    for (uint64_t i = tail; i < head; i++) {
+        encode_event(journal, r, &ring->events[i & (JOURNAL_RING_CAPACITY - 1)]);
+    }
+
+    // Hand the slots back to the producer
+    __atomic_store_n(&ring->tail, head, __ATOMIC_RELEASE);
+    return head - tail;
+}
+
+static void* journal_writer_main(void *arg) {
+    Journal *journal = arg;
+    const struct timespec idle = {0, JOURNAL_IDLE_SLEEP_NS};
+
+    for (;;) {
+        // Read the flag first: a pass that starts after stop and finds nothing is the last one
+        const int stopping = __atomic_load_n(&journal->stop, __ATOMIC_ACQUIRE);
+        uint64_t drained = 0;
+        for (uint32_t r = 0; r < journal->ring_count; r++) {
+            drained += drain_ring(journal, r);
+        }
+        if (drained == 0) {
+            if (stopping) break;
+            nanosleep(&idle, NULL);
+        }
+    }
+    return NULL;
+}
+
+Journal* journal_open(const char *path, uint32_t ring_count) {
+    if (ring_count == 0 || ring_count > JOURNAL_MAX_RINGS) return NULL;
+
+    Journal *journal = calloc(1, sizeof(Journal));
+    if (!journal) return NULL;
+    journal->ring_count = ring_count;
+    journal->rings = calloc(ring_count, sizeof(JournalRing));
+    journal->encoders = calloc(ring_count, sizeof(BlockEncoder));
+    journal->file = fopen(path, "wb");
+    if (!journal->rings || !journal->encoders || !journal->file) goto fail;
+
+    for (uint32_t r = 0; r < ring_count; r++) {
+        journal->rings[r].events = malloc(sizeof(JournalEvent) * JOURNAL_RING_CAPACITY);
+        if (!journal->rings[r].events) goto fail;
+    }
+
+    const uint32_t header[2] = {JOURNAL_VERSION, 0};
+    journal_write(journal, JOURNAL_MAGIC, 8);
+    journal_write(journal, header, sizeof(header));
+
+    if (pthread_create(&journal->thread, NULL, journal_writer_main, journal) != 0) goto fail;
+    return journal;
+
+fail:
+    if (journal->file) fclose(journal->file);
+    if (journal->rings) {
+        for (uint32_t r = 0; r < ring_count; r++) free(journal->rings[r].events);
+    }
+    free(journal->rings);
+    free(journal->encoders);
+    free(journal);
+    return NULL;
+}
+
+JournalRing* journal_ring(Journal *journal, uint32_t index) {
+    return index < journal->ring_count ? &journal->rings[index] : NULL;
+}
+
+uint64_t journal_bytes_written(const Journal *journal) {
+    return __atomic_load_n(&journal->offset, __ATOMIC_RELAXED);
+}
+
+void journal_ring_wait(JournalRing *ring) {
+    while (ring->head - (ring->cached_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE))
+           >= JOURNAL_RING_CAPACITY) {
+        sched_yield();
+    }
+}
+
+int journal_close(Journal *journal) {
+    if (!journal) return 0;
+
+    __atomic_store_n(&journal->stop, 1, __ATOMIC_RELEASE);
+    pthread_join(journal->thread, NULL);
+
+    // The writer is gone; close the open blocks, then the last index and the footer
+    for (uint32_t r = 0; r < journal->ring_count; r++) {
+        flush_block(journal, r);
+    }
+    write_index_block(journal);
+    journal_write(journal, &journal->last_index_offset, sizeof(uint64_t));
+    journal_write(journal, JOURNAL_FOOTER_MAGIC, 8);
+
+    int rc = journal->error ? -1 : 0;
+    if (fclose(journal->file) != 0) rc = -1;
+    for (uint32_t r = 0; r < journal->ring_count; r++) {
+        free(journal->rings[r].events);
+    }
+    free(journal->rings);
+    free(journal->encoders);
+    free(journal);
+    return rc;
+}
+
+struct JournalReader {
+    FILE *file;
+    uint64_t data_end;          // footer offset, or the file size for unclosed journals
+    uint64_t last_index_offset; // 0 without a footer
+    uint8_t *payload;
+    size_t payload_capacity;
+    const uint8_t *cursor;
+    const uint8_t *end;
+    uint32_t remaining;         // events left in the current block
+    uint32_t ring;
+    uint32_t min_turn;          // events before this are skipped after a seek
+    uint32_t prev_turn;
+    uint32_t prev_subject;
+    uint32_t prev_object;
+};
+
+static int reader_seek(JournalReader *reader, uint64_t offset) {
+    reader->remaining = 0;
+    return fseeko(reader->file, (off_t)offset, SEEK_SET) == 0 ? 0 : -1;
+}
+
+JournalReader* journal_reader_open(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    char magic[8];
+    uint32_t header[2];
+    if (fread(magic, 1, 8, file) != 8 || memcmp(magic, JOURNAL_MAGIC, 8) != 0 ||
+        fread(header, sizeof(uint32_t), 2, file) != 2 || header[0] != JOURNAL_VERSION) {
+        fclose(file);
+        return NULL;
+    }
+
+    JournalReader *reader = calloc(1, sizeof(JournalReader));
+    if (!reader) {
+        fclose(file);
+        return NULL;
+    }
+    reader->file = file;
+
+    fseeko(file, 0, SEEK_END);
+    const uint64_t size = (uint64_t)ftello(file);
+    reader->data_end = size;
+
+    // A footer is only there if the journal was closed cleanly
+    uint64_t footer_index;
+    char footer_magic[8];
+    if (size >= JOURNAL_HEADER_BYTES + JOURNAL_FOOTER_BYTES &&
+        fseeko(file, (off_t)(size - JOURNAL_FOOTER_BYTES), SEEK_SET) == 0 &&
+        fread(&footer_index, sizeof(footer_index), 1, file) == 1 &&
+        fread(footer_magic, 1, 8, file) == 8 && memcmp(footer_magic, JOURNAL_FOOTER_MAGIC, 8) == 0) {
+        reader->data_end = size - JOURNAL_FOOTER_BYTES;
+        reader->last_index_offset = footer_index;
+    }
+
+    reader_seek(reader, JOURNAL_HEADER_BYTES);
+    return reader;
+}
+
+// Read the next block header and payload; returns 1, 0 at the end, -1 if corrupt
+static int reader_load_block(JournalReader *reader, JournalBlockHeader *header) {
+    const uint64_t offset = (uint64_t)ftello(reader->file);
+    if (offset + sizeof(*header) > reader->data_end) return 0;
+    if (fread(header, sizeof(*header), 1, reader->file) != 1) return 0;
+    if (offset + sizeof(*header) + header->payload_bytes > reader->data_end) return 0; // torn tail
+
+    if (header->payload_bytes > reader->payload_capacity) {
+        uint8_t *grown = realloc(reader->payload, header->payload_bytes);
+        if (!grown) return -1;
+        reader->payload = grown;
+        reader->payload_capacity = header->payload_bytes;
+    }
+    if (fread(reader->payload, 1, header->payload_bytes, reader->file) != header->payload_bytes) return -1;
+    return 1;
+}
+
+int journal_reader_seek_turn(JournalReader *reader, uint32_t turn) {
+    reader->min_turn = turn;
+    uint64_t target = UINT64_MAX;
+
+    // Walk the index chain back from the footer; the earliest block that
+    // reaches the turn is where every ring's events for it start
+    for (uint64_t index = reader->last_index_offset; index != 0;) {
+        JournalBlockHeader header;
+        if (reader_seek(reader, index) != 0 || reader_load_block(reader, &header) != 1 ||
+            header.kind != JOURNAL_BLOCK_INDEX ||
+            header.payload_bytes != sizeof(uint64_t) + sizeof(JournalIndexEntry) * header.event_count) {
+            return -1;
+        }
+
+        const JournalIndexEntry *entries = (const JournalIndexEntry*)(reader->payload + sizeof(uint64_t));
+        for (uint32_t i = 0; i < header.event_count; i++) {
+            if (entries[i].last_turn >= turn && entries[i].offset < target) target = entries[i].offset;
+        }
+        memcpy(&index, reader->payload, sizeof(uint64_t));
+    }
+
+    if (reader->last_index_offset == 0) target = JOURNAL_HEADER_BYTES; // no index: scan from the start
+    if (target == UINT64_MAX) target = reader->data_end;               // nothing that late
+    return reader_seek(reader, target);
+}
+
+int journal_reader_next(JournalReader *reader, JournalEvent *out) {
+    for (;;) {
+        while (reader->remaining == 0) {
+            JournalBlockHeader header;
+            const int rc = reader_load_block(reader, &header);
+            if (rc != 1) return rc;
+            if (header.kind != JOURNAL_BLOCK_DATA) continue;
+
+            reader->cursor = reader->payload;
+            reader->end = reader->payload + header.payload_bytes;
+            reader->remaining = header.event_count;
+            reader->ring = header.ring;
+            reader->prev_turn = 0;
+            reader->prev_subject = 0;
+            reader->prev_object = 0;
+        }
+
+        uint64_t tag, subject, object, value, turn_delta = 0;
+        size_t n;
+        if (!(n = get_varint(reader->cursor, reader->end, &tag))) return -1;
+        reader->cursor += n;
+        if ((tag & 1) && !(n = get_varint(reader->cursor, reader->end, &turn_delta))) return -1;
+        if (tag & 1) reader->cursor += n;
+        if (!(n = get_varint(reader->cursor, reader->end, &subject))) return -1;
+        reader->cursor += n;
+        if (!(n = get_varint(reader->cursor, reader->end, &object))) return -1;
+        reader->cursor += n;
+        if (!(n = get_varint(reader->cursor, reader->end, &value))) return -1;
+        reader->cursor += n;
+        reader->remaining--;
+
+        reader->prev_turn += (uint32_t)unzigzag((uint32_t)turn_delta);
+        reader->prev_subject += (uint32_t)unzigzag((uint32_t)subject);
+        reader->prev_object += (uint32_t)unzigzag((uint32_t)object);
+
+        if (reader->prev_turn < reader->min_turn) continue;
+        out->turn = reader->prev_turn;
+        out->type = (uint32_t)(tag >> 1);
+        out->subject = reader->prev_subject;
+        out->object = reader->prev_object;
+        out->value = unzigzag((uint32_t)value);
+        return 1;
+    }
+}
+
+uint32_t journal_reader_ring(const JournalReader *reader) {
+    return reader->ring;
+}
+
+void journal_reader_close(JournalReader *reader) {
+    if (!reader) return;
+    fclose(reader->file);
+    free(reader->payload);
+    free(reader);
+}
@@ -0,0 +1,171 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_JOURNAL_H
+#define SPARSE_STORAGE_LEARNING_JOURNAL_H
+
+/**
+ * @file journal.h
+ * @brief Streaming binary event journal with a background writer thread
+ *
+ * Producers append fixed-size events to their own single-producer ring; a
+ * writer thread drains every ring, delta- and varint-encodes the events into
+ * self-contained blocks and appends them to the file. Every
+ * JOURNAL_INDEX_INTERVAL data blocks it also writes an index block listing
+ * their offsets and turn ranges, and a footer points at the last index, so a
+ * reader can seek to a turn without decoding everything before it.
+ *
+ * File layout (native byte order):
+ *   file header   "ECSJRNL\0", u32 version, u32 reserved
+ *   block*        JournalBlockHeader + payload
+ *   footer        u64 offset of the last index block, "JRNLEND\0"
+ *
+ * Event encoding inside a data block, with every delta reset at block start:
+ *   varint (type << 1 | turn_changed)
+ *   [varint turn delta]            only if turn_changed
+ *   zigzag varint subject delta    vs. the previous event's subject
+ *   zigzag varint object delta     vs. the previous event's object
+ *   zigzag varint value
+ *
+ * Event types are opaque here; the caller assigns them (see combat_system.h).
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define JOURNAL_VERSION 1
+
+/** Events buffered per producer ring; a full ring makes its producer wait */
+#ifndef JOURNAL_RING_CAPACITY
+#define JOURNAL_RING_CAPACITY (1u << 16)
+#endif
+
+/** Encoded payload size at which a data block is closed */
+#define JOURNAL_BLOCK_BYTES (64u * 1024u)
+
+/** Data blocks between index blocks */
+#define JOURNAL_INDEX_INTERVAL 32
+
+/** Upper bound on producer rings per journal */
+#define JOURNAL_MAX_RINGS 64
+
+/**
+ * @brief One recorded event
+ */
+typedef struct {
+    uint32_t turn;     /**< Turn the event happened in; non-decreasing per ring keeps deltas small */
+    uint32_t type;     /**< Caller-defined event type */
+    uint32_t subject;  /**< Acting entity ID */
+    uint32_t object;   /**< Entity acted upon, UINT32_MAX if none */
+    int32_t value;     /**< Type-specific payload (damage, health, ...) */
+} JournalEvent;
+
+/**
+ * @brief Single-producer ring; only its owning thread may record into it
+ */
+typedef struct {
+    JournalEvent *events;
+    uint64_t head;          /**< Events ever recorded (written by the producer) */
+    uint64_t cached_tail;   /**< Producer's last view of tail, refreshed when the ring looks full */
+    char _pad0[48];
+    uint64_t tail;          /**< Events ever drained (written by the writer thread) */
+    char _pad1[56];
+} JournalRing;
+
+typedef struct Journal Journal;
+
+/**
+ * @brief Create a journal file and start its writer thread
+ * @param path File to create (truncated if it exists)
+ * @param ring_count Producer rings, one per recording thread (1..JOURNAL_MAX_RINGS)
+ * @return The journal, or NULL if the file or thread couldn't be created
+ */
+Journal* journal_open(const char *path, uint32_t ring_count);
+
+/**
+ * @brief Producer ring by index
+ * @param journal Open journal
+ * @param index Ring index below the ring_count passed to journal_open()
+ */
+JournalRing* journal_ring(Journal *journal, uint32_t index);
+
+/**
+ * @brief Drain every ring, write the final blocks, index and footer, and free the journal
+ * @param journal Journal to close; producers must have stopped recording
+ * @return 0 on success, -1 if any write failed
+ */
+int journal_close(Journal *journal);
+
+/**
+ * @brief Bytes written to the file so far (approximate while the writer is running)
+ */
+uint64_t journal_bytes_written(const Journal *journal);
+
+/**
+ * @brief Wait until the writer thread frees space in a full ring
+ * @note Slow path of journal_record(); not meant to be called directly
+ */
+void journal_ring_wait(JournalRing *ring);
+
+/**
+ * @brief Append an event to a ring
+ * @param ring Ring owned by the calling thread
+ * @note Never drops events: if the writer falls a whole ring behind, the producer waits
+ */
+static inline void journal_record(JournalRing *ring, uint32_t turn, uint32_t type,
+                                  uint32_t subject, uint32_t object, int32_t value) {
+    const uint64_t head = ring->head;
+    if (head - ring->cached_tail >= JOURNAL_RING_CAPACITY) {
+        ring->cached_tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+        if (head - ring->cached_tail >= JOURNAL_RING_CAPACITY) journal_ring_wait(ring);
+    }
+
+    JournalEvent *event = &ring->events[head & (JOURNAL_RING_CAPACITY - 1)];
+    event->turn = turn;
+    event->type = type;
+    event->subject = subject;
+    event->object = object;
+    event->value = value;
+
+    // Publish after the event is fully written
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Sequential reader over a journal file
+ */
+typedef struct JournalReader JournalReader;
+
+/**
+ * @brief Open a journal for reading, positioned at the first event
+ * @return The reader, or NULL if the file is missing or not a journal
+ * @note Works on journals that were never closed (e.g. after a crash): every
+ *       complete block is readable, seeking just falls back to a scan
+ */
+JournalReader* journal_reader_open(const char *path);
+
+/**
+ * @brief Position the reader at the first event with turn >= the given turn
+ * @return 0 on success, -1 on a read error
+ * @note Uses the index blocks to skip straight to the right data block
+ */
+int journal_reader_seek_turn(JournalReader *reader, uint32_t turn);
+
+/**
+ * @brief Read the next event
+ * @return 1 if an event was read, 0 at the end of the journal, -1 on a corrupt block
+ * @note Events of one ring come back in recording order; blocks of different
+ *       rings are interleaved in the order the writer drained them
+ */
+int journal_reader_next(JournalReader *reader, JournalEvent *out);
+
+/**
+ * @brief Ring the most recently read event was recorded into
+ */
+uint32_t journal_reader_ring(const JournalReader *reader);
+
+void journal_reader_close(JournalReader *reader);
+
+#endif //SPARSE_STORAGE_LEARNING_JOURNAL_H
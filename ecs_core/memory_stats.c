@@ -0,0 +1,66 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "memory_stats.h"
+#include <stdint.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#define MEMORY_STATS_HAVE_MINCORE 1
+#endif
+
+#define MINCORE_BATCH_PAGES 256
+
+size_t memory_resident_bytes(const void *addr, size_t size) {
+    if (!addr || size == 0) return 0;
+
+#ifdef MEMORY_STATS_HAVE_MINCORE
+    const uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+    const uintptr_t start = (uintptr_t)addr & ~(page - 1);
+    const uintptr_t end = ((uintptr_t)addr + size + page - 1) & ~(page - 1);
+    const size_t pages = (end - start) / page;
+
+#ifdef __APPLE__
+    char vec[MINCORE_BATCH_PAGES];
+#else
+    unsigned char vec[MINCORE_BATCH_PAGES];
+#endif
+
+    size_t resident_pages = 0;
+    for (size_t done = 0; done < pages; done += MINCORE_BATCH_PAGES) {
+        const size_t batch = pages - done < MINCORE_BATCH_PAGES ? pages - done : MINCORE_BATCH_PAGES;
+        if (mincore((void*)(start + done * page), batch * page, vec) != 0) {
+            return size; // unknown: assume all of it
+        }
+        for (size_t i = 0; i < batch; i++) {
+            resident_pages += vec[i] & 1;
+        }
+    }
+
+    // Partial pages at the ends count fully in mincore; never report more than the range
+    const size_t resident = resident_pages * page;
+    return resident < size ? resident : size;
+#else
+    return size;
+#endif
+}
+
+void memory_regions_print(const MemoryRegion *regions, size_t count, FILE *out) {
+    size_t reserved = 0, committed = 0, used = 0, high_water = 0;
+
+    fprintf(out, "%-24s %14s %14s %14s %14s\n", "region", "reserved", "committed", "used", "high_water");
+    for (size_t i = 0; i < count; i++) {
+        const MemoryRegion *r = &regions[i];
+        fprintf(out, "%s%-*s %14zu %14zu %14zu %14zu\n", r->nested ? "  " : "",
+                r->nested ? 22 : 24, r->name, r->reserved, r->committed, r->used, r->high_water);
+        if (r->nested) continue;
+
+        reserved += r->reserved;
+        committed += r->committed;
+        used += r->used;
+        high_water += r->high_water;
+    }
+    fprintf(out, "%-24s %14zu %14zu %14zu %14zu\n", "total", reserved, committed, used, high_water);
+}
@@ -0,0 +1,52 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_MEMORY_STATS_H
+#define SPARSE_STORAGE_LEARNING_MEMORY_STATS_H
+
+/**
+ * @file memory_stats.h
+ * @brief Footprint accounting shared by the memory reports
+ *
+ * A MemoryRegion describes one block of memory at three levels: what was
+ * reserved (asked of the allocator), what is committed (pages the OS actually
+ * backs, which is less than reserved for calloc'd or untouched buffers) and
+ * what is used by live data, plus the peak of the latter.
+ */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/**
+ * @brief One line of a memory report
+ */
+typedef struct {
+    const char *name;   /**< Label, e.g. "arena.battle" or "set.combatants" */
+    size_t reserved;    /**< Bytes allocated for this region */
+    size_t committed;   /**< Bytes of it resident in memory right now */
+    size_t used;        /**< Bytes holding live data */
+    size_t high_water;  /**< Peak of used since the region was last reset */
+    bool nested;        /**< Lives inside an earlier region (e.g. an arena); excluded from totals */
+} MemoryRegion;
+
+/**
+ * @brief Bytes of [addr, addr + size) currently resident in physical memory
+ * @param addr Start of the range (any alignment)
+ * @param size Length of the range in bytes
+ * @return Resident bytes, or size where residency can't be queried
+ * @note Uses mincore(); costs one syscall per 1 MB or so, so meant for reports
+ *       rather than hot paths
+ */
+size_t memory_resident_bytes(const void *addr, size_t size);
+
+/**
+ * @brief Print a table of regions followed by totals over the non-nested ones
+ * @param regions Regions to print
+ * @param count Number of regions
+ * @param out Destination stream
+ */
+void memory_regions_print(const MemoryRegion *regions, size_t count, FILE *out);
+
+#endif //SPARSE_STORAGE_LEARNING_MEMORY_STATS_H
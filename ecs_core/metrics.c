@@ -0,0 +1,449 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "metrics.h"
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define SUB_COUNT (1u << METRICS_HISTOGRAM_SUB_BITS)
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+typedef enum {
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM,
+    METRIC_TYPE_COUNT
+} MetricType;
+
+typedef struct {
+    const char *name;
+    const char *labels;
+    const char *help;
+    double scale;
+} MetricInfo;
+
+// One per recording thread; only the owner writes, readers sum over all shards
+typedef struct MetricsShard {
+    uint64_t counters[METRICS_MAX_COUNTERS];
+    uint64_t histogram_sum[METRICS_MAX_HISTOGRAMS];
+    uint64_t histogram_buckets[METRICS_MAX_HISTOGRAMS][METRICS_HISTOGRAM_BUCKETS];
+    int in_use;                     // 0 once the owning thread exits (atomic)
+    struct MetricsShard *next;
+} MetricsShard;
+
+static const uint32_t type_capacity[METRIC_TYPE_COUNT] = {
+    METRICS_MAX_COUNTERS, METRICS_MAX_GAUGES, METRICS_MAX_HISTOGRAMS,
+};
+static const char *const type_names[METRIC_TYPE_COUNT] = {"counter", "gauge", "histogram"};
+
+// Entries are filled before the count that covers them is published (atomic)
+static MetricInfo registry[METRIC_TYPE_COUNT][METRICS_MAX_COUNTERS > METRICS_MAX_GAUGES
+                                              ? METRICS_MAX_COUNTERS : METRICS_MAX_GAUGES];
+static uint32_t registered[METRIC_TYPE_COUNT];
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int64_t gauges[METRICS_MAX_GAUGES];     // atomic
+
+static MetricsShard *shard_list;               // every shard ever created, newest first (atomic)
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t shard_key;
+static __thread MetricsShard *thread_shard;
+
+// The owner is the only writer, so a relaxed load and store is enough to
+// keep readers from seeing torn values; no locked instruction needed
+static inline void shard_add(uint64_t *slot, uint64_t value) {
+    __atomic_store_n(slot, __atomic_load_n(slot, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED);
+}
+
+static void shard_release(void *arg) {
+    MetricsShard *shard = arg;
+    __atomic_store_n(&shard->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void key_init(void) {
+    pthread_key_create(&shard_key, shard_release);
+}
+
+// Short-lived threads take over shards of exited ones, so the number of
+// shards tracks peak concurrency and the exited threads' counts are kept
+static MetricsShard* shard_acquire(void) {
+    pthread_once(&key_once, key_init);
+
+    MetricsShard *shard = __atomic_load_n(&shard_list, __ATOMIC_ACQUIRE);
+    for (; shard; shard = shard->next) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&shard->in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (!shard) {
+        shard = calloc(1, sizeof(MetricsShard));
+        if (!shard) return NULL;
+        shard->in_use = 1;
+
+        MetricsShard *head = __atomic_load_n(&shard_list, __ATOMIC_RELAXED);
+        do {
+            shard->next = head;
+        } while (!__atomic_compare_exchange_n(&shard_list, &head, shard, 1,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    pthread_setspecific(shard_key, shard);
+    thread_shard = shard;
+    return shard;
+}
+
+static MetricId metric_register(MetricType type, const char *name, const char *labels, const char *help,
+                                double scale) {
+    pthread_mutex_lock(&registry_lock);
+    const uint32_t count = registered[type];
+    MetricId id = METRIC_INVALID;
+    for (uint32_t i = 0; i < count; i++) {
+        const MetricInfo *info = &registry[type][i];
+        if (strcmp(info->name, name) == 0 &&
+            (info->labels == labels || (info->labels && labels && strcmp(info->labels, labels) == 0))) {
+            id = i;
+            break;
+        }
+    }
+    if (id == METRIC_INVALID && count < type_capacity[type]) {
+        registry[type][count] = (MetricInfo){name, labels, help, scale};
+        __atomic_store_n(&registered[type], count + 1, __ATOMIC_RELEASE);
+        id = count;
+    }
+    pthread_mutex_unlock(&registry_lock);
+    return id;
+}
+
+MetricId metrics_counter(const char *name, const char *labels, const char *help) {
+    return metric_register(METRIC_COUNTER, name, labels, help, 1.0);
+}
+
+MetricId metrics_gauge(const char *name, const char *labels, const char *help) {
+    return metric_register(METRIC_GAUGE, name, labels, help, 1.0);
+}
+
+MetricId metrics_histogram(const char *name, const char *labels, const char *help, double scale) {
+    return metric_register(METRIC_HISTOGRAM, name, labels, help, scale);
+}
+
+// Log-linear bucket: values below SUB_COUNT get one each, then every power
+// of two 2^e is split into SUB_COUNT buckets of 2^(e - SUB_BITS)
+static inline uint32_t bucket_of(uint64_t value) {
+    if (value < SUB_COUNT) return (uint32_t)value;
+    const uint32_t e = 63 - (uint32_t)__builtin_clzll(value);
+    if (e > METRICS_HISTOGRAM_MAX_EXP) return METRICS_HISTOGRAM_BUCKETS - 1;
+    return ((e - METRICS_HISTOGRAM_SUB_BITS + 1) << METRICS_HISTOGRAM_SUB_BITS) +
+           (uint32_t)(value >> (e - METRICS_HISTOGRAM_SUB_BITS)) - SUB_COUNT;
+}
+
+// One past the largest value in a bucket
+static uint64_t bucket_limit(uint32_t bucket) {
+    if (bucket < SUB_COUNT) return bucket + 1;
+    const uint32_t e = (bucket >> METRICS_HISTOGRAM_SUB_BITS) + METRICS_HISTOGRAM_SUB_BITS - 1;
+    const uint64_t sub = bucket & (SUB_COUNT - 1);
+    return (SUB_COUNT + sub + 1) << (e - METRICS_HISTOGRAM_SUB_BITS);
+}
+
+void metrics_add(MetricId counter, uint64_t value) {
+    if (counter >= METRICS_MAX_COUNTERS) return;
+    MetricsShard *shard = thread_shard;
+    if (!shard && !(shard = shard_acquire())) return;
+    shard_add(&shard->counters[counter], value);
+}
+
+void metrics_set(MetricId gauge, int64_t value) {
+    if (gauge >= METRICS_MAX_GAUGES) return;
+    __atomic_store_n(&gauges[gauge], value, __ATOMIC_RELAXED);
+}
+
+void metrics_record(MetricId histogram, uint64_t value) {
+    if (histogram >= METRICS_MAX_HISTOGRAMS) return;
+    MetricsShard *shard = thread_shard;
+    if (!shard && !(shard = shard_acquire())) return;
+    shard_add(&shard->histogram_buckets[histogram][bucket_of(value)], 1);
+    shard_add(&shard->histogram_sum[histogram], value);
+}
+
+uint64_t metrics_counter_total(MetricId counter) {
+    if (counter >= METRICS_MAX_COUNTERS) return 0;
+    uint64_t total = 0;
+    for (MetricsShard *s = __atomic_load_n(&shard_list, __ATOMIC_ACQUIRE); s; s = s->next) {
+        total += __atomic_load_n(&s->counters[counter], __ATOMIC_RELAXED);
+    }
+    return total;
+}
+
+// Buckets summed over every shard; returns the total count
+static uint64_t histogram_merge(MetricId histogram, uint64_t *buckets, uint64_t *sum) {
+    memset(buckets, 0, sizeof(uint64_t) * METRICS_HISTOGRAM_BUCKETS);
+    uint64_t count = 0;
+    if (sum) *sum = 0;
+    for (MetricsShard *s = __atomic_load_n(&shard_list, __ATOMIC_ACQUIRE); s; s = s->next) {
+        const uint64_t *src = s->histogram_buckets[histogram];
+        for (uint32_t b = 0; b < METRICS_HISTOGRAM_BUCKETS; b++) {
+            const uint64_t n = __atomic_load_n(&src[b], __ATOMIC_RELAXED);
+            buckets[b] += n;
+            count += n;
+        }
+        if (sum) *sum += __atomic_load_n(&s->histogram_sum[histogram], __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+uint64_t metrics_histogram_count(MetricId histogram) {
+    if (histogram >= METRICS_MAX_HISTOGRAMS) return 0;
+    uint64_t buckets[METRICS_HISTOGRAM_BUCKETS];
+    return histogram_merge(histogram, buckets, NULL);
+}
+
+uint64_t metrics_histogram_quantile(MetricId histogram, double q) {
+    if (histogram >= METRICS_MAX_HISTOGRAMS) return 0;
+    uint64_t buckets[METRICS_HISTOGRAM_BUCKETS];
+    const uint64_t count = histogram_merge(histogram, buckets, NULL);
+    if (count == 0) return 0;
+
+    // Nearest rank
+    uint64_t rank = (uint64_t)(q * (double)count + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    uint64_t seen = 0;
+    for (uint32_t b = 0; b < METRICS_HISTOGRAM_BUCKETS; b++) {
+        seen += buckets[b];
+        if (seen >= rank) return bucket_limit(b) - 1;
+    }
+    return bucket_limit(METRICS_HISTOGRAM_BUCKETS - 1) - 1;
+}
+
+// name{labels,extra} or name{extra}, or plain name
+static void write_series(FILE *out, const char *name, const char *suffix, const char *labels, const char *extra) {
+    fprintf(out, "%s%s", name, suffix);
+    if (labels || extra) {
+        fprintf(out, "{%s%s%s}", labels ? labels : "", labels && extra ? "," : "", extra ? extra : "");
+    }
+    fputc(' ', out);
+}
+
+static void write_metric(FILE *out, MetricType type, MetricId id, const MetricInfo *info) {
+    if (type == METRIC_COUNTER) {
+        write_series(out, info->name, "", info->labels, NULL);
+        fprintf(out, "%llu\n", (unsigned long long)metrics_counter_total(id));
+        return;
+    }
+    if (type == METRIC_GAUGE) {
+        write_series(out, info->name, "", info->labels, NULL);
+        fprintf(out, "%lld\n", (long long)__atomic_load_n(&gauges[id], __ATOMIC_RELAXED));
+        return;
+    }
+
+    uint64_t buckets[METRICS_HISTOGRAM_BUCKETS];
+    uint64_t sum;
+    const uint64_t count = histogram_merge(id, buckets, &sum);
+
+    // Cumulative counts at every power of two
+    uint64_t cumulative = 0;
+    uint32_t b = 0;
+    for (uint32_t k = 0; k <= METRICS_HISTOGRAM_MAX_EXP + 1; k++) {
+        const uint64_t bound = 1ull << k;
+        while (b < METRICS_HISTOGRAM_BUCKETS && bucket_limit(b) <= bound) cumulative += buckets[b++];
+        char le[48];
+        snprintf(le, sizeof(le), "le=\"%.9g\"", (double)bound * info->scale);
+        write_series(out, info->name, "_bucket", info->labels, le);
+        fprintf(out, "%llu\n", (unsigned long long)cumulative);
+    }
+    write_series(out, info->name, "_bucket", info->labels, "le=\"+Inf\"");
+    fprintf(out, "%llu\n", (unsigned long long)count);
+    write_series(out, info->name, "_sum", info->labels, NULL);
+    fprintf(out, "%.9g\n", (double)sum * info->scale);
+    write_series(out, info->name, "_count", info->labels, NULL);
+    fprintf(out, "%llu\n", (unsigned long long)count);
+}
+
+int metrics_write_prometheus(FILE *out) {
+    for (int type = 0; type < METRIC_TYPE_COUNT; type++) {
+        const uint32_t count = __atomic_load_n(&registered[type], __ATOMIC_ACQUIRE);
+        const MetricInfo *infos = registry[type];
+
+        // Series of one name must be contiguous, whatever order they were registered in
+        for (uint32_t i = 0; i < count; i++) {
+            bool seen = false;
+            for (uint32_t j = 0; j < i && !seen; j++) seen = strcmp(infos[j].name, infos[i].name) == 0;
+            if (seen) continue;
+
+            fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", infos[i].name, infos[i].help ? infos[i].help : "",
+                    infos[i].name, type_names[type]);
+            for (uint32_t k = i; k < count; k++) {
+                if (k == i || strcmp(infos[k].name, infos[i].name) == 0) {
+                    write_metric(out, (MetricType)type, k, &infos[k]);
+                }
+            }
+        }
+    }
+    return ferror(out) ? -1 : 0;
+}
+
+static struct {
+    pthread_t thread;
+    int fd;
+    int stop;               // atomic
+    bool running;
+    char unix_path[sizeof(((struct sockaddr_un*)0)->sun_path)];
+} exporter = {.fd = -1};
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        const ssize_t written = send(fd, data, len, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return 0;
+}
+
+static void serve_scrape(int fd) {
+    // Read the request head so the client doesn't see a reset, then ignore it
+    const struct timeval timeout = {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    char request[4096];
+    size_t used = 0;
+    while (used < sizeof(request) - 1) {
+        const ssize_t got = recv(fd, request + used, sizeof(request) - 1 - used, 0);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        used += (size_t)got;
+        request[used] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) break;
+    }
+
+    char *body = NULL;
+    size_t body_len = 0;
+    FILE *out = open_memstream(&body, &body_len);
+    if (!out) return;
+    const int rc = metrics_write_prometheus(out);
+    fclose(out);
+
+    char head[256];
+    const int head_len = rc == 0
+        ? snprintf(head, sizeof(head), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                       "Content-Length: %zu\r\nConnection: close\r\n\r\n", body_len)
+        : snprintf(head, sizeof(head), "HTTP/1.0 500 Internal Server Error\r\nContent-Length: 0\r\n\r\n");
+    if (write_all(fd, head, (size_t)head_len) == 0 && rc == 0) {
+        write_all(fd, body, body_len);
+    }
+    free(body);
+}
+
+static void* exporter_main(void *arg) {
+    (void)arg;
+    // Wake up now and then to notice metrics_exporter_stop()
+    while (!__atomic_load_n(&exporter.stop, __ATOMIC_ACQUIRE)) {
+        struct pollfd pfd = {exporter.fd, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        const int client = accept(exporter.fd, NULL, NULL);
+        if (client < 0) continue;
+        serve_scrape(client);
+        close(client);
+    }
+    return NULL;
+}
+
+static int listen_on(const char *address) {
+    if (strncmp(address, "unix:", 5) == 0) {
+        const char *path = address + 5;
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        if (path[0] == '\0' || strlen(path) >= sizeof(addr.sun_path)) return -1;
+        strcpy(addr.sun_path, path);
+
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        unlink(path);
+        if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+            close(fd);
+            return -1;
+        }
+        strcpy(exporter.unix_path, path);
+        return fd;
+    }
+
+    // [host:]port
+    char host[64] = "127.0.0.1";
+    const char *colon = strrchr(address, ':');
+    const char *port_text = address;
+    if (colon) {
+        const size_t host_len = (size_t)(colon - address);
+        if (host_len >= sizeof(host)) return -1;
+        if (host_len > 0) {
+            memcpy(host, address, host_len);
+            host[host_len] = '\0';
+        }
+        port_text = colon + 1;
+    }
+    char *end;
+    const unsigned long port = strtoul(port_text, &end, 10);
+    if (*port_text == '\0' || *end != '\0' || port == 0 || port > 65535) return -1;
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) return -1;
+
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int metrics_exporter_start(const char *address) {
+    if (exporter.running) return -1;
+    exporter.unix_path[0] = '\0';
+    if ((exporter.fd = listen_on(address)) < 0) return -1;
+
+    __atomic_store_n(&exporter.stop, 0, __ATOMIC_RELEASE);
+    if (pthread_create(&exporter.thread, NULL, exporter_main, NULL) != 0) {
+        close(exporter.fd);
+        if (exporter.unix_path[0]) unlink(exporter.unix_path);
+        exporter.fd = -1;
+        return -1;
+    }
+    exporter.running = true;
+    return 0;
+}
+
+void metrics_exporter_stop(void) {
+    if (!exporter.running) return;
+    __atomic_store_n(&exporter.stop, 1, __ATOMIC_RELEASE);
+    pthread_join(exporter.thread, NULL);
+    close(exporter.fd);
+    if (exporter.unix_path[0]) unlink(exporter.unix_path);
+    exporter.fd = -1;
+    exporter.running = false;
+}
+
+void metrics_exporter_unlink(void) {
+    if (exporter.running && exporter.unix_path[0]) unlink(exporter.unix_path);
+}
@@ -0,0 +1,137 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_METRICS_H
+#define SPARSE_STORAGE_LEARNING_METRICS_H
+
+/**
+ * @file metrics.h
+ * @brief Process-wide metrics registry with a Prometheus text exporter
+ *
+ * Metrics are registered once by name (plus an optional label set) and then
+ * updated through the returned id. Counters and histograms are sharded per
+ * thread: each thread adds to its own shard with plain loads and stores, so
+ * updates take no locks and no atomic read-modify-writes, and a reader sums
+ * the shards. Shards of exited threads are kept (their counts still count)
+ * and handed to the next new thread, as the profiler does with its rings.
+ * Gauges hold a single last-written value.
+ *
+ * Histograms are HDR-style log-linear: every power of two is split into
+ * 2^METRICS_HISTOGRAM_SUB_BITS equal buckets, so any recorded value is known
+ * to within 1/2^METRICS_HISTOGRAM_SUB_BITS of itself from 0 up to
+ * 2^(METRICS_HISTOGRAM_MAX_EXP + 1); larger values land in the last bucket.
+ *
+ * metrics_exporter_start() serves metrics_write_prometheus() over HTTP on a
+ * Unix socket or a loopback TCP port from a background thread, for
+ * Prometheus (or curl) to scrape.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/** Registry capacity per metric type */
+#define METRICS_MAX_COUNTERS 32
+#define METRICS_MAX_GAUGES 32
+#define METRICS_MAX_HISTOGRAMS 16
+
+/** Linear buckets per power of two, as a power of two (16: within 6.25%) */
+#define METRICS_HISTOGRAM_SUB_BITS 4
+/** Largest power of two histograms resolve; 2^40 ns is about 18 minutes */
+#define METRICS_HISTOGRAM_MAX_EXP 40
+#define METRICS_HISTOGRAM_BUCKETS \
+    ((METRICS_HISTOGRAM_MAX_EXP - METRICS_HISTOGRAM_SUB_BITS + 2) << METRICS_HISTOGRAM_SUB_BITS)
+
+/** Returned by registration when the registry is full */
+#define METRIC_INVALID UINT32_MAX
+
+typedef uint32_t MetricId;
+
+/**
+ * @brief Register a monotonically increasing counter, or find it if already registered
+ * @param name Prometheus metric name, e.g. "ecs_turns_total"; must outlive the registry (use literals)
+ * @param labels Label set without braces, e.g. "team=\"a\"", or NULL; must outlive the registry
+ * @param help One-line description; the first registration of a name provides it
+ * @return Id for metrics_add(), or METRIC_INVALID if the registry is full
+ * @note Thread-safe; registering the same name and labels again returns the same id.
+ */
+MetricId metrics_counter(const char *name, const char *labels, const char *help);
+
+/**
+ * @brief Register a gauge (see metrics_counter())
+ */
+MetricId metrics_gauge(const char *name, const char *labels, const char *help);
+
+/**
+ * @brief Register a histogram (see metrics_counter())
+ * @param scale Factor from recorded values to exported ones, e.g. 1e-9 to
+ *              record nanoseconds and export seconds
+ */
+MetricId metrics_histogram(const char *name, const char *labels, const char *help, double scale);
+
+/**
+ * @brief Add to a counter on the calling thread's shard
+ * @note Ignores METRIC_INVALID, so failed registrations need no checks at call sites.
+ */
+void metrics_add(MetricId counter, uint64_t value);
+
+/**
+ * @brief Set a gauge
+ */
+void metrics_set(MetricId gauge, int64_t value);
+
+/**
+ * @brief Record one value into a histogram on the calling thread's shard
+ */
+void metrics_record(MetricId histogram, uint64_t value);
+
+/**
+ * @brief Sum of a counter over every shard
+ */
+uint64_t metrics_counter_total(MetricId counter);
+
+/**
+ * @brief Values recorded into a histogram over every shard
+ */
+uint64_t metrics_histogram_count(MetricId histogram);
+
+/**
+ * @brief Approximate quantile of a histogram over every shard
+ * @param q Quantile in [0, 1]
+ * @return Largest value of the bucket holding the quantile, in recorded
+ *         units; 0 if nothing was recorded
+ */
+uint64_t metrics_histogram_quantile(MetricId histogram, double q);
+
+/**
+ * @brief Write every registered metric in Prometheus text exposition format 0.0.4
+ * @param out Destination stream
+ * @return 0 on success, -1 on a write error
+ * @note Safe to call while other threads update metrics. Histogram buckets
+ *       are exported at powers of two only; a value exactly on a bound
+ *       counts towards the next one.
+ */
+int metrics_write_prometheus(FILE *out);
+
+/**
+ * @brief Serve the metrics over HTTP from a background thread
+ * @param address "unix:/path/to/socket" (replaced if it exists), or
+ *                "[host:]port" for TCP; host defaults to 127.0.0.1
+ * @return 0 once listening, -1 on a bad address, a socket error or an exporter already running
+ * @note Every request, whatever its path, gets the full metrics page.
+ */
+int metrics_exporter_start(const char *address);
+
+/**
+ * @brief Stop the exporter thread and close (and for Unix sockets, unlink) its socket
+ */
+void metrics_exporter_stop(void);
+
+/**
+ * @brief Remove the exporter's Unix socket file, if it has one, leaving the thread running
+ * @note Async-signal-safe, for handlers that _exit() without metrics_exporter_stop().
+ */
+void metrics_exporter_unlink(void);
+
+#endif //SPARSE_STORAGE_LEARNING_METRICS_H
@@ -0,0 +1,61 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "parallel.h"
+#include <pthread.h>
+
+typedef struct {
+    ParallelRangeFn fn;
+    void *ctx;
+    uint32_t count;
+    uint32_t grain;
+    uint32_t chunks;
+    uint32_t next_chunk; // shared work counter
+} ParallelJob;
+
+static void* parallel_worker(void *arg) {
+    ParallelJob *job = arg;
+
+    for (;;) {
+        const uint32_t chunk = __atomic_fetch_add(&job->next_chunk, 1, __ATOMIC_RELAXED);
+        if (chunk >= job->chunks) break;
+
+        const uint32_t begin = chunk * job->grain;
+        const uint32_t end = job->count - begin < job->grain ? job->count : begin + job->grain;
+        job->fn(job->ctx, begin, end);
+    }
+    return NULL;
+}
+
+void parallel_for(uint32_t count, uint32_t grain, uint32_t threads, ParallelRangeFn fn, void *ctx) {
+    if (count == 0) return;
+    if (grain == 0) grain = count;
+
+    ParallelJob job = {
+        .fn = fn,
+        .ctx = ctx,
+        .count = count,
+        .grain = grain,
+        .chunks = (uint32_t)(((uint64_t)count + grain - 1) / grain),
+        .next_chunk = 0,
+    };
+
+    // Never start more helpers than there are chunks for them to take
+    uint32_t helpers = threads > 1 ? threads - 1 : 0;
+    if (helpers > job.chunks - 1) helpers = job.chunks - 1;
+    if (helpers > PARALLEL_MAX_THREADS) helpers = PARALLEL_MAX_THREADS;
+
+    pthread_t handles[PARALLEL_MAX_THREADS];
+    uint32_t started = 0;
+    for (; started < helpers; started++) {
+        if (pthread_create(&handles[started], NULL, parallel_worker, &job) != 0) break;
+    }
+
+    // The caller works too, so the loop completes even if no helper started
+    parallel_worker(&job);
+
+    for (uint32_t i = 0; i < started; i++) {
+        pthread_join(handles[i], NULL);
+    }
+}
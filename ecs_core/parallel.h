@@ -0,0 +1,44 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_PARALLEL_H
+#define SPARSE_STORAGE_LEARNING_PARALLEL_H
+
+/**
+ * @file parallel.h
+ * @brief Minimal fork-join parallel loop over an index range
+ *
+ * Splits [0, count) into fixed-size chunks and hands them out to a short-lived
+ * group of pthreads plus the calling thread. Chunk boundaries depend only on
+ * the grain, never on the thread count, so work that derives its inputs from
+ * the chunk (e.g. one RNG stream per chunk) produces the same result however
+ * many threads run it.
+ */
+
+#include <stdint.h>
+
+/** Upper bound on helper threads started by one parallel_for() call */
+#define PARALLEL_MAX_THREADS 64
+
+/**
+ * @brief Chunk callback
+ * @param ctx User context passed through from parallel_for()
+ * @param begin First index of the chunk
+ * @param end One past the last index of the chunk
+ */
+typedef void (*ParallelRangeFn)(void *ctx, uint32_t begin, uint32_t end);
+
+/**
+ * @brief Run fn over [0, count) in chunks of grain indices
+ * @param count Number of indices
+ * @param grain Chunk size; every chunk except possibly the last has exactly this many indices
+ * @param threads Total threads to use, including the caller (0 or 1 runs inline)
+ * @param fn Chunk callback; chunks may run concurrently and in any order
+ * @param ctx User context for fn
+ * @note Returns once every chunk has run. If a helper thread can't be started
+ *       the remaining threads pick up its share.
+ */
+void parallel_for(uint32_t count, uint32_t grain, uint32_t threads, ParallelRangeFn fn, void *ctx);
+
+#endif //SPARSE_STORAGE_LEARNING_PARALLEL_H
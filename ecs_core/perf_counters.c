@@ -0,0 +1,153 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "perf_counters.h"
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char *const counter_names[PERF_COUNTER_COUNT] = {
+    "cycles",
+    "instructions",
+    "branch_misses",
+    "l1d_misses",
+    "llc_misses",
+    "dtlb_misses",
+};
+
+const char* perf_counter_name(PerfCounterId id) {
+    return (unsigned)id < PERF_COUNTER_COUNT ? counter_names[id] : "unknown";
+}
+
+static void perf_counters_clear(PerfCounters *pc) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        pc->fds[c] = -1;
+        pc->group_of[c] = 0;
+        pc->slot_of[c] = 0;
+    }
+    for (int g = 0; g < PERF_GROUP_COUNT; g++) {
+        pc->leader[g] = -1;
+        pc->members[g] = 0;
+    }
+}
+
+#ifdef __linux__
+
+typedef struct {
+    uint32_t type;
+    uint64_t config;
+    int group;
+} PerfCounterSpec;
+
+#define PERF_CACHE_READ_MISS(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+// Indexed by PerfCounterId. Group 0 is core pipeline events, group 1 memory events.
+static const PerfCounterSpec counter_specs[PERF_COUNTER_COUNT] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 0},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 0},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, 0},
+    {PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_L1D), 1},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, 1},
+    {PERF_TYPE_HW_CACHE, PERF_CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB), 1},
+};
+
+static int perf_event_open(struct perf_event_attr *attr, int group_fd) {
+    // This thread, any CPU
+    return (int)syscall(__NR_perf_event_open, attr, 0, -1, group_fd, 0);
+}
+
+int perf_counters_open(PerfCounters *pc) {
+    perf_counters_clear(pc);
+    int opened = 0;
+
+    for (int g = 0; g < PERF_GROUP_COUNT; g++) {
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            if (counter_specs[c].group != g) continue;
+
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = counter_specs[c].type;
+            attr.config = counter_specs[c].config;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.disabled = pc->leader[g] == -1; // members follow their leader
+
+            // A refused counter just drops out; the next one can still lead the group
+            const int fd = perf_event_open(&attr, pc->leader[g]);
+            if (fd < 0) continue;
+
+            if (pc->leader[g] == -1) pc->leader[g] = fd;
+            pc->fds[c] = fd;
+            pc->group_of[c] = g;
+            pc->slot_of[c] = pc->members[g]++;
+            opened++;
+        }
+
+        if (pc->leader[g] != -1) {
+            ioctl(pc->leader[g], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(pc->leader[g], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+    }
+    return opened;
+}
+
+void perf_counters_read(const PerfCounters *pc, PerfSample *out) {
+    memset(out, 0, sizeof(*out));
+
+    for (int g = 0; g < PERF_GROUP_COUNT; g++) {
+        if (pc->leader[g] == -1) continue;
+
+        // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+        uint64_t buf[3 + PERF_COUNTER_COUNT];
+        const ssize_t bytes = read(pc->leader[g], buf, sizeof(buf));
+        if (bytes < (ssize_t)(3 * sizeof(uint64_t)) || buf[2] == 0) continue;
+
+        // Scale up when the kernel multiplexed this group off the PMU for a while
+        const double scale = (double)buf[1] / (double)buf[2];
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            if (pc->fds[c] == -1 || pc->group_of[c] != g || (uint64_t)pc->slot_of[c] >= buf[0]) continue;
+            out->values[c] = (uint64_t)((double)buf[3 + pc->slot_of[c]] * scale);
+            out->valid[c] = true;
+        }
+    }
+}
+
+void perf_counters_close(PerfCounters *pc) {
+    // Members first, leaders last
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        const int fd = pc->fds[c];
+        if (fd != -1 && fd != pc->leader[pc->group_of[c]]) close(fd);
+    }
+    for (int g = 0; g < PERF_GROUP_COUNT; g++) {
+        if (pc->leader[g] != -1) close(pc->leader[g]);
+    }
+    perf_counters_clear(pc);
+}
+
+#else
+
+int perf_counters_open(PerfCounters *pc) {
+    perf_counters_clear(pc);
+    return 0;
+}
+
+void perf_counters_read(const PerfCounters *pc, PerfSample *out) {
+    (void)pc;
+    memset(out, 0, sizeof(*out));
+}
+
+void perf_counters_close(PerfCounters *pc) {
+    perf_counters_clear(pc);
+}
+
+#endif
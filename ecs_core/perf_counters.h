@@ -0,0 +1,84 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_PERF_COUNTERS_H
+#define SPARSE_STORAGE_LEARNING_PERF_COUNTERS_H
+
+/**
+ * @file perf_counters.h
+ * @brief Hardware performance counters for the calling thread (Linux perf_event_open)
+ *
+ * Opens two counter groups, {cycles, instructions, branch misses} and
+ * {L1D read misses, LLC misses, dTLB read misses}, so each group's members
+ * are counted over exactly the same interval. Reads are scaled when the
+ * kernel multiplexes groups. Any counter the kernel or hardware refuses
+ * (containers, VMs, perf_event_paranoid) is marked unavailable, and on
+ * non-Linux builds none are; callers just check PerfSample::valid.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**
+ * @brief Counters opened by perf_counters_open()
+ */
+typedef enum {
+    PERF_COUNTER_CYCLES = 0,
+    PERF_COUNTER_INSTRUCTIONS,
+    PERF_COUNTER_BRANCH_MISSES,
+    PERF_COUNTER_L1D_MISSES,
+    PERF_COUNTER_LLC_MISSES,
+    PERF_COUNTER_DTLB_MISSES,
+    PERF_COUNTER_COUNT
+} PerfCounterId;
+
+#define PERF_GROUP_COUNT 2
+
+/**
+ * @brief Open counter file descriptors (one leader per group)
+ */
+typedef struct {
+    int fds[PERF_COUNTER_COUNT];             /**< -1 for counters that couldn't be opened */
+    int group_of[PERF_COUNTER_COUNT];        /**< Group each counter belongs to */
+    int slot_of[PERF_COUNTER_COUNT];         /**< Position within its group's read buffer */
+    int leader[PERF_GROUP_COUNT];            /**< Leader fd per group, -1 if the group is empty */
+    int members[PERF_GROUP_COUNT];           /**< Counters opened per group */
+} PerfCounters;
+
+/**
+ * @brief One reading of every counter
+ */
+typedef struct {
+    uint64_t values[PERF_COUNTER_COUNT]; /**< Counts since open, scaled for multiplexing */
+    bool valid[PERF_COUNTER_COUNT];      /**< False for unavailable counters */
+} PerfSample;
+
+/**
+ * @brief Open and start all counters for the calling thread
+ * @param pc Pointer to the PerfCounters to initialize
+ * @return Number of counters opened; 0 means hardware counters are unavailable
+ * @note User-space only (kernel excluded), so it works at perf_event_paranoid 2
+ * @note Threads started afterwards (e.g. parallel_for helpers) are not counted
+ */
+int perf_counters_open(PerfCounters *pc);
+
+/**
+ * @brief Read every open counter
+ * @param pc Pointer to the PerfCounters
+ * @param out Receives the values; subtract two samples to measure an interval
+ */
+void perf_counters_read(const PerfCounters *pc, PerfSample *out);
+
+/**
+ * @brief Close every counter
+ * @param pc Pointer to the PerfCounters
+ */
+void perf_counters_close(PerfCounters *pc);
+
+/**
+ * @brief Short snake_case name of a counter, e.g. "l1d_misses"
+ */
+const char* perf_counter_name(PerfCounterId id);
+
+#endif //SPARSE_STORAGE_LEARNING_PERF_COUNTERS_H
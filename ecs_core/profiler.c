@@ -0,0 +1,192 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "profiler.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef enum {
+    PROFILE_EVENT_BEGIN,
+    PROFILE_EVENT_END,
+    PROFILE_EVENT_COUNTER
+} ProfileEventType;
+
+typedef struct {
+    uint64_t ts_ns;
+    const char *name;
+    int64_t value;      // running counter total for PROFILE_EVENT_COUNTER
+    uint32_t type;
+} ProfileEvent;
+
+// One per recording thread. Only the owner writes events; readers see up to `head`.
+typedef struct ProfileRing {
+    ProfileEvent *events;
+    uint64_t head;                          // events ever written (atomic)
+    int64_t counters[PROFILE_COUNTER_COUNT];
+    uint32_t tid;
+    int in_use;                             // 0 once the owning thread exits (atomic)
+    struct ProfileRing *next;
+} ProfileRing;
+
+static const char *const counter_names[PROFILE_COUNTER_COUNT] = {
+    "entities_processed",
+    "deaths",
+    "cache_rebuilds",
+};
+
+static ProfileRing *ring_list;     // every ring ever created, newest first (atomic)
+static uint32_t next_tid = 1;
+static uint64_t epoch_ns;          // trace timestamps are relative to this
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t ring_key;
+static __thread ProfileRing *thread_ring;
+
+static uint64_t profiler_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Runs when a recording thread exits: keep its events, let a later thread reuse the ring
+static void ring_release(void *arg) {
+    ProfileRing *ring = arg;
+    __atomic_store_n(&ring->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void key_init(void) {
+    pthread_key_create(&ring_key, ring_release);
+    __atomic_store_n(&epoch_ns, profiler_now_ns(), __ATOMIC_RELAXED);
+}
+
+// Short-lived threads (e.g. parallel_for helpers) pick up rings of exited ones,
+// so the number of rings tracks peak concurrency rather than threads created
+static ProfileRing* ring_acquire(void) {
+    pthread_once(&key_once, key_init);
+
+    ProfileRing *ring = __atomic_load_n(&ring_list, __ATOMIC_ACQUIRE);
+    for (; ring; ring = ring->next) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&ring->in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (!ring) {
+        ring = calloc(1, sizeof(ProfileRing));
+        if (!ring) return NULL;
+        ring->events = malloc(sizeof(ProfileEvent) * PROFILER_RING_CAPACITY);
+        if (!ring->events) {
+            free(ring);
+            return NULL;
+        }
+        ring->in_use = 1;
+        ring->tid = __atomic_fetch_add(&next_tid, 1, __ATOMIC_RELAXED);
+
+        ProfileRing *head = __atomic_load_n(&ring_list, __ATOMIC_RELAXED);
+        do {
+            ring->next = head;
+        } while (!__atomic_compare_exchange_n(&ring_list, &head, ring, 1,
+                                              __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+
+    pthread_setspecific(ring_key, ring);
+    thread_ring = ring;
+    return ring;
+}
+
+static inline void ring_push(uint32_t type, const char *name, int64_t value) {
+    ProfileRing *ring = thread_ring;
+    if (!ring && !(ring = ring_acquire())) return;
+
+    const uint64_t head = ring->head;
+    ProfileEvent *event = &ring->events[head % PROFILER_RING_CAPACITY];
+    event->ts_ns = profiler_now_ns();
+    event->name = name;
+    event->value = value;
+    event->type = type;
+
+    // Publish after the event is fully written
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void profiler_begin(const char *name) {
+    ring_push(PROFILE_EVENT_BEGIN, name, 0);
+}
+
+void profiler_end(const char *name) {
+    ring_push(PROFILE_EVENT_END, name, 0);
+}
+
+void profiler_counter_add(ProfileCounter counter, int64_t value) {
+    ProfileRing *ring = thread_ring;
+    if (!ring && !(ring = ring_acquire())) return;
+
+    ring->counters[counter] += value;
+    ring_push(PROFILE_EVENT_COUNTER, counter_names[counter], ring->counters[counter]);
+}
+
+int64_t profiler_counter_total(ProfileCounter counter) {
+    int64_t total = 0;
+    for (ProfileRing *ring = __atomic_load_n(&ring_list, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+        total += ring->counters[counter];
+    }
+    return total;
+}
+
+void profiler_reset(void) {
+    for (ProfileRing *ring = __atomic_load_n(&ring_list, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+        __atomic_store_n(&ring->head, 0, __ATOMIC_RELEASE);
+        for (int c = 0; c < PROFILE_COUNTER_COUNT; c++) {
+            ring->counters[c] = 0;
+        }
+    }
+    __atomic_store_n(&epoch_ns, profiler_now_ns(), __ATOMIC_RELAXED);
+}
+
+int profiler_write_chrome_trace(FILE *out) {
+    const uint64_t epoch = __atomic_load_n(&epoch_ns, __ATOMIC_RELAXED);
+    int first = 1;
+
+    fprintf(out, "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n");
+
+    for (ProfileRing *ring = __atomic_load_n(&ring_list, __ATOMIC_ACQUIRE); ring; ring = ring->next) {
+        const uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        if (head == 0) continue;
+
+        fprintf(out, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, "
+                     "\"args\": {\"name\": \"thread %u\"}}",
+                first ? "" : ",\n", ring->tid, ring->tid);
+        first = 0;
+
+        // Only the newest PROFILER_RING_CAPACITY events survive; after a
+        // wrap, drop the ends of zones whose begins were overwritten
+        const uint64_t start = head > PROFILER_RING_CAPACITY ? head - PROFILER_RING_CAPACITY : 0;
+        uint32_t depth = 0;
+        for (uint64_t i = start; i < head; i++) {
+            const ProfileEvent *event = &ring->events[i % PROFILER_RING_CAPACITY];
+            const double ts_us = event->ts_ns >= epoch ? (double)(event->ts_ns - epoch) / 1000.0 : 0.0;
+
+            if (event->type == PROFILE_EVENT_COUNTER) {
+                fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"C\", \"ts\": %.3f, \"pid\": 1, \"tid\": %u, "
+                             "\"args\": {\"value\": %lld}}",
+                        event->name, ts_us, ring->tid, (long long)event->value);
+            } else {
+                if (event->type == PROFILE_EVENT_BEGIN) {
+                    depth++;
+                } else if (depth == 0) {
+                    continue;
+                } else {
+                    depth--;
+                }
+                fprintf(out, ",\n{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %.3f, \"pid\": 1, \"tid\": %u}",
+                        event->name, event->type == PROFILE_EVENT_BEGIN ? 'B' : 'E', ts_us, ring->tid);
+            }
+        }
+    }
+
+    fprintf(out, "\n]}\n");
+    return ferror(out) ? -1 : 0;
+}
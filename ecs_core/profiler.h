@@ -0,0 +1,113 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_PROFILER_H
+#define SPARSE_STORAGE_LEARNING_PROFILER_H
+
+/**
+ * @file profiler.h
+ * @brief Lightweight zone profiler with Chrome trace export
+ *
+ * Zones record timestamped begin/end events into a per-thread ring buffer;
+ * each thread writes only its own ring, so recording takes no locks. Counters
+ * accumulate per thread and are also written to the ring so their values
+ * show up on the timeline. profiler_write_chrome_trace() dumps every ring as
+ * Chrome/Perfetto trace_event JSON (open it in ui.perfetto.dev or
+ * chrome://tracing).
+ *
+ * The PROFILE_* macros only do anything when ECS_PROFILE is defined (the
+ * ECS_ENABLE_PROFILER CMake option); otherwise they compile to nothing.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+/** Events kept per thread; older events are overwritten once a ring is full */
+#ifndef PROFILER_RING_CAPACITY
+#define PROFILER_RING_CAPACITY (1u << 18)
+#endif
+
+/**
+ * @brief Named counters shared by all threads
+ */
+typedef enum {
+    PROFILE_COUNTER_ENTITIES_PROCESSED = 0, /**< Units visited by a combat system */
+    PROFILE_COUNTER_DEATHS,                 /**< Entities destroyed */
+    PROFILE_COUNTER_CACHE_REBUILDS,         /**< Target caches rebuilt or re-resolved */
+    PROFILE_COUNTER_COUNT
+} ProfileCounter;
+
+/**
+ * @brief Record the start of a zone on the calling thread
+ * @param name Zone name; must outlive the profiler (use string literals)
+ */
+void profiler_begin(const char *name);
+
+/**
+ * @brief Record the end of the innermost open zone on the calling thread
+ * @param name Same name passed to profiler_begin()
+ */
+void profiler_end(const char *name);
+
+/**
+ * @brief Add to a counter on the calling thread
+ * @param counter Counter to update
+ * @param value Amount to add
+ */
+void profiler_counter_add(ProfileCounter counter, int64_t value);
+
+/**
+ * @brief Sum of a counter over every thread that has recorded anything
+ * @param counter Counter to read
+ * @return Total since the last profiler_reset()
+ */
+int64_t profiler_counter_total(ProfileCounter counter);
+
+/**
+ * @brief Discard all recorded events and zero the counters
+ * @note Only call while no other thread is recording
+ */
+void profiler_reset(void);
+
+/**
+ * @brief Write every thread's events as Chrome trace_event JSON
+ * @param out Destination stream
+ * @return 0 on success, -1 on a write error
+ * @note Only call while no other thread is recording. Once a ring has
+ *       wrapped, end events whose begin was overwritten are left out.
+ */
+int profiler_write_chrome_trace(FILE *out);
+
+#ifdef ECS_PROFILE
+
+typedef struct {
+    const char *name;
+} ProfileZone;
+
+static inline void profile_zone_close(ProfileZone *zone) {
+    profiler_end(zone->name);
+}
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+/** Profile from here to the end of the enclosing scope */
+#define PROFILE_ZONE(name) \
+    ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__) __attribute__((cleanup(profile_zone_close))) = {(name)}; \
+    profiler_begin(name)
+
+/** Profile the rest of the current function under its own name */
+#define PROFILE_FUNCTION() PROFILE_ZONE(__func__)
+
+#define PROFILE_COUNT(counter, value) profiler_counter_add((counter), (int64_t)(value))
+
+#else
+
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_COUNT(counter, value) ((void)0)
+
+#endif
+
+#endif //SPARSE_STORAGE_LEARNING_PROFILER_H
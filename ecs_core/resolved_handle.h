@@ -0,0 +1,88 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_RESOLVED_HANDLE_H
+#define SPARSE_STORAGE_LEARNING_RESOLVED_HANDLE_H
+
+/**
+ * @file resolved_handle.h
+ * @brief Entity handles that cache their dense index in a specific SparseSet
+ *
+ * Following a plain Entity handle costs two dependent random loads: the
+ * generation check and the sparse[] lookup. A ResolvedHandle remembers the
+ * dense index it resolved to together with the set's structural version at
+ * that moment. While the set has not been structurally modified the cached
+ * index is used directly; after a removal it is re-resolved lazily.
+ *
+ * @note A fresh stamp only proves the set is unchanged, not that the entity
+ *       is alive. This relies on destroyed entities being removed from the
+ *       set in the same step (as process_deaths() and the World do).
+ */
+
+#include <stdint.h>
+
+#include "entity_manager.h"
+#include "sparse_set_storage.h"
+#include "entity_lookup.h"
+
+/**
+ * @brief Entity handle plus its cached dense index in one SparseSet
+ */
+typedef struct {
+    Entity entity;        /**< The underlying generational handle */
+    uint32_t dense_index; /**< Cached dense index, UINT32_MAX if the handle did not resolve */
+    uint32_t stamp;       /**< SparseSet version the index was resolved against, 0 if never resolved */
+} ResolvedHandle;
+
+/**
+ * @brief Wrap an Entity in an unresolved handle
+ * @param e Entity handle to wrap (may be the UINT32_MAX sentinel)
+ * @return ResolvedHandle that will resolve on first use
+ */
+static inline ResolvedHandle resolved_handle_make(Entity e) {
+    return (ResolvedHandle){e, UINT32_MAX, 0};
+}
+
+/**
+ * @brief Handle that refers to no entity
+ */
+static inline ResolvedHandle resolved_handle_none(void) {
+    return resolved_handle_make((Entity){UINT32_MAX, 0});
+}
+
+/**
+ * @brief Check whether the cached index is still valid for the set
+ * @param h Pointer to the ResolvedHandle
+ * @param set SparseSet the handle resolves into
+ * @return 1 if dense_index can be used without re-resolving
+ */
+static inline int resolved_handle_is_fresh(const ResolvedHandle *h, const SparseSet *set) {
+    return h->stamp == set->version;
+}
+
+/**
+ * @brief Store the result of an external (e.g. batched) resolution
+ * @param h Pointer to the ResolvedHandle to update
+ * @param set SparseSet the index was resolved against
+ * @param dense_index Resolved dense index, or UINT32_MAX if the handle is stale
+ */
+static inline void resolved_handle_store(ResolvedHandle *h, const SparseSet *set, uint32_t dense_index) {
+    h->dense_index = dense_index;
+    h->stamp = set->version;
+}
+
+/**
+ * @brief Get the dense index, re-resolving only if the set changed structurally
+ * @param h Pointer to the ResolvedHandle (updated in place when stale)
+ * @param em EntityManager that issued the handle
+ * @param set SparseSet to resolve into
+ * @return Dense index, or UINT32_MAX if the entity is dead or not in the set
+ */
+static inline uint32_t resolved_handle_get(ResolvedHandle *h, const EntityManager *em, const SparseSet *set) {
+    if (ECS_LIKELY(h->stamp == set->version)) return h->dense_index;
+    resolved_handle_store(h, set, entity_resolve(em, set, h->entity));
+    return h->dense_index;
+}
+
+#endif //SPARSE_STORAGE_LEARNING_RESOLVED_HANDLE_H
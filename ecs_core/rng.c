@@ -0,0 +1,110 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "rng.h"
+
+#define RNG_LANES 4
+
+static uint64_t splitmix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void rng_seed(Rng *rng, uint64_t seed) {
+    uint64_t sm = seed;
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = splitmix64(&sm);
+    }
+    // splitmix64 never yields four zeros in a row, but be explicit about the invariant
+    if ((rng->s[0] | rng->s[1] | rng->s[2] | rng->s[3]) == 0) rng->s[0] = 1;
+}
+
+void rng_seed_stream(Rng *rng, uint64_t seed, uint64_t stream) {
+    // Hash the stream id first so adjacent ids land far apart in seed space
+    uint64_t mix = stream;
+    rng_seed(rng, seed ^ splitmix64(&mix));
+}
+
+void rng_jump(Rng *rng) {
+    static const uint64_t JUMP[] = {
+        0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull,
+        0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+    };
+
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (JUMP[i] & (1ull << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            rng_next(rng);
+        }
+    }
+
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+void rng_fill_u32(Rng *rng, uint32_t *out, size_t count) {
+    // Short fills aren't worth setting up lanes for
+    if (count < 2 * RNG_LANES * 8) {
+        size_t i = 0;
+        for (; i + 1 < count; i += 2) {
+            const uint64_t v = rng_next(rng);
+            out[i] = (uint32_t)(v >> 32);
+            out[i + 1] = (uint32_t)v;
+        }
+        if (i < count) out[i] = rng_next_u32(rng);
+        return;
+    }
+
+    // Structure-of-arrays lanes: lane k starts k jumps ahead of the caller's state
+    uint64_t s0[RNG_LANES], s1[RNG_LANES], s2[RNG_LANES], s3[RNG_LANES];
+    Rng lane = *rng;
+    for (int k = 0; k < RNG_LANES; k++) {
+        s0[k] = lane.s[0];
+        s1[k] = lane.s[1];
+        s2[k] = lane.s[2];
+        s3[k] = lane.s[3];
+        rng_jump(&lane);
+    }
+
+    // Each step yields 2 x 32 bits per lane. The multiplies by 5 and 9 are written
+    // as shift-adds so the loop vectorizes without 64-bit vector multiplies.
+    size_t i = 0;
+    for (; i + 2 * RNG_LANES <= count; i += 2 * RNG_LANES) {
+        for (int k = 0; k < RNG_LANES; k++) {
+            const uint64_t x5 = (s1[k] << 2) + s1[k];
+            const uint64_t r = (x5 << 7) | (x5 >> 57);
+            const uint64_t result = (r << 3) + r;
+            const uint64_t t = s1[k] << 17;
+
+            s2[k] ^= s0[k];
+            s3[k] ^= s1[k];
+            s1[k] ^= s2[k];
+            s0[k] ^= s3[k];
+            s2[k] ^= t;
+            s3[k] = (s3[k] << 45) | (s3[k] >> 19);
+
+            out[i + 2 * k] = (uint32_t)(result >> 32);
+            out[i + 2 * k + 1] = (uint32_t)result;
+        }
+    }
+
+    // Continue from lane 0 so the caller's generator moves past what was used
+    rng->s[0] = s0[0];
+    rng->s[1] = s1[0];
+    rng->s[2] = s2[0];
+    rng->s[3] = s3[0];
+    for (; i < count; i++) {
+        out[i] = rng_next_u32(rng);
+    }
+}
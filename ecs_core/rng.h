@@ -0,0 +1,121 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_RNG_H
+#define SPARSE_STORAGE_LEARNING_RNG_H
+
+/**
+ * @file rng.h
+ * @brief Fast deterministic random streams (xoshiro256**) for per-world use
+ *
+ * Each Rng is a self-contained 256-bit state, so worlds and threads never
+ * share a generator. Independent sequences come from either jump-ahead
+ * (rng_jump() skips 2^128 outputs) or keyed stream seeding
+ * (rng_seed_stream()), which lets work be split into fixed-size blocks whose
+ * random values do not depend on which thread draws them. rng_fill_u32()
+ * runs four interleaved generators so bulk fills vectorize.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief xoshiro256** generator state
+ * @note Never all zero; rng_seed() guarantees this
+ */
+typedef struct {
+    uint64_t s[4]; /**< Generator state */
+} Rng;
+
+/**
+ * @brief Seed a generator by expanding a 64-bit seed with splitmix64
+ * @param rng Pointer to the Rng to seed
+ * @param seed Any 64-bit value (0 is fine)
+ */
+void rng_seed(Rng *rng, uint64_t seed);
+
+/**
+ * @brief Seed stream number `stream` of a seed
+ * @param rng Pointer to the Rng to seed
+ * @param seed Base seed shared by all streams
+ * @param stream Stream identifier (e.g. team and block index)
+ * @note Streams with different identifiers are statistically independent,
+ *       and seeding one costs the same regardless of the identifier
+ */
+void rng_seed_stream(Rng *rng, uint64_t seed, uint64_t stream);
+
+/**
+ * @brief Advance the generator by 2^128 outputs
+ * @param rng Pointer to the Rng
+ * @note Use to hand out up to 2^128 non-overlapping subsequences from one seed
+ */
+void rng_jump(Rng *rng);
+
+/**
+ * @brief Fill an array with uniformly distributed 32-bit values
+ * @param rng Pointer to the Rng (advanced past the values used)
+ * @param out Output array
+ * @param count Number of values to write
+ * @note Runs four jump-separated lanes in lockstep so the loop vectorizes;
+ *       the output sequence differs from repeated rng_next_u32() calls but is
+ *       fully determined by the Rng state
+ */
+void rng_fill_u32(Rng *rng, uint32_t *out, size_t count);
+
+static inline uint64_t rng_rotl(const uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+/**
+ * @brief Next 64-bit output
+ * @param rng Pointer to the Rng
+ * @return Uniform 64-bit value
+ */
+static inline uint64_t rng_next(Rng *rng) {
+    uint64_t *s = rng->s;
+    const uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rng_rotl(s[3], 45);
+
+    return result;
+}
+
+/**
+ * @brief Next 32-bit output (upper half of the 64-bit output)
+ */
+static inline uint32_t rng_next_u32(Rng *rng) {
+    return (uint32_t)(rng_next(rng) >> 32);
+}
+
+/**
+ * @brief Map a uniform 32-bit value into [0, n) without division
+ * @param r Uniform 32-bit value (e.g. from rng_fill_u32())
+ * @param n Exclusive upper bound
+ * @return Value in [0, n)
+ */
+static inline uint32_t rng_bound(uint32_t r, uint32_t n) {
+    return (uint32_t)(((uint64_t)r * n) >> 32);
+}
+
+/**
+ * @brief Map a uniform 32-bit value to a float in [0, 1)
+ */
+static inline float rng_unit_float(uint32_t r) {
+    return (float)(r >> 8) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief Uniform integer in [0, n)
+ */
+static inline uint32_t rng_range(Rng *rng, uint32_t n) {
+    return rng_bound(rng_next_u32(rng), n);
+}
+
+#endif //SPARSE_STORAGE_LEARNING_RNG_H
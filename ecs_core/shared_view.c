@@ -0,0 +1,254 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "shared_view.h"
+#include "profiler.h"
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHARED_VIEW_HAVE_SHM 1
+#endif
+
+#ifdef SHARED_VIEW_HAVE_SHM
+
+static size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+SharedView* shared_view_create(const char *name, uint32_t capacity, uint32_t component_size,
+                               uint32_t generation_capacity) {
+    if (strlen(name) >= sizeof(((SharedView*)0)->name)) return NULL;
+
+    // Buffer layout; buffers start on page boundaries
+    const size_t entities_offset = align_up(sizeof(SharedViewFrameHeader), 64);
+    const size_t components_offset = align_up(entities_offset + sizeof(uint32_t) * (size_t)capacity, 64);
+    const size_t generations_offset = align_up(components_offset + (size_t)component_size * capacity, 64);
+    const size_t buffer_size = align_up(generations_offset + sizeof(uint32_t) * (size_t)generation_capacity, 4096);
+    const size_t first_buffer = align_up(sizeof(SharedViewHeader), 4096);
+    const size_t size = first_buffer + SHARED_VIEW_BUFFERS * buffer_size;
+
+    const int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+    void *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        shm_unlink(name);
+        return NULL;
+    }
+
+    SharedView *view = calloc(1, sizeof(SharedView));
+    if (!view) {
+        munmap(base, size);
+        shm_unlink(name);
+        return NULL;
+    }
+    strcpy(view->name, name);
+    view->header = base;
+    view->size = size;
+
+    // The object starts zeroed, so every buffer's sequence number is 0 (even)
+    SharedViewHeader *header = base;
+    header->version = SHARED_VIEW_VERSION;
+    header->header_size = sizeof(SharedViewHeader);
+    header->capacity = capacity;
+    header->component_size = component_size;
+    header->generation_capacity = generation_capacity;
+    header->writer_pid = (uint32_t)getpid();
+    for (int b = 0; b < SHARED_VIEW_BUFFERS; b++) {
+        header->buffer_offset[b] = first_buffer + (size_t)b * buffer_size;
+    }
+    header->buffer_size = buffer_size;
+    header->entities_offset = entities_offset;
+    header->components_offset = components_offset;
+    header->generations_offset = generations_offset;
+    header->published = SHARED_VIEW_NONE;
+
+    // Magic last: a reader that sees it sees a complete header
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(header->magic, SHARED_VIEW_MAGIC, sizeof(SHARED_VIEW_MAGIC));
+    return view;
+}
+
+void shared_view_publish(SharedView *view, const SparseSet *set, const EntityManager *em, uint64_t tick) {
+    PROFILE_FUNCTION();
+    const uint64_t start = now_ns();
+    SharedViewHeader *header = view->header;
+
+    // Fill the buffer readers aren't being pointed at
+    const uint32_t published = header->published;
+    const uint32_t target = published == SHARED_VIEW_NONE ? 0 : published ^ 1;
+    char *buffer = (char*)header + header->buffer_offset[target];
+    SharedViewFrameHeader *frame = (SharedViewFrameHeader*)buffer;
+
+    uint32_t count = set->dense_count;
+    if (count > header->capacity) count = header->capacity;
+    uint32_t generations = 0;
+    if (em) {
+        // IDs come off the free stack lowest first, so none at or above peak_living was ever handed out
+        generations = em->peak_living < header->generation_capacity ? em->peak_living : header->generation_capacity;
+    }
+
+    const uint64_t sequence = frame->sequence;
+    __atomic_store_n(&frame->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    frame->tick = tick;
+    frame->dense_count = count;
+    frame->generation_count = generations;
+    memcpy(buffer + header->entities_offset, set->dense_entities, sizeof(uint32_t) * count);
+    if (header->component_size > 0) {
+        memcpy(buffer + header->components_offset, set->dense_data, (size_t)header->component_size * count);
+    }
+    if (generations > 0) {
+        memcpy(buffer + header->generations_offset, em->generation, sizeof(uint32_t) * generations);
+    }
+
+    __atomic_store_n(&frame->sequence, sequence + 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->published, target, __ATOMIC_RELEASE);
+    __atomic_store_n(&header->publish_count, header->publish_count + 1, __ATOMIC_RELEASE);
+
+    view->bytes += sizeof(uint32_t) * (count + (uint64_t)generations) + (uint64_t)header->component_size * count;
+    view->publish_ns += now_ns() - start;
+}
+
+void shared_view_destroy(SharedView *view) {
+    if (!view) return;
+    munmap(view->header, view->size);
+    shm_unlink(view->name);
+    free(view);
+}
+
+int shared_view_open(SharedViewReader *reader, const char *name, uint32_t component_size) {
+    reader->header = NULL;
+    reader->size = 0;
+
+    const int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(SharedViewHeader)) {
+        close(fd);
+        return -1;
+    }
+    const size_t size = (size_t)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    const SharedViewHeader *header = base;
+    bool ok = memcmp(header->magic, SHARED_VIEW_MAGIC, sizeof(SHARED_VIEW_MAGIC)) == 0;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    ok = ok && header->version == SHARED_VIEW_VERSION && header->header_size == sizeof(SharedViewHeader);
+    ok = ok && (component_size == 0 || header->component_size == component_size);
+    for (int b = 0; ok && b < SHARED_VIEW_BUFFERS; b++) {
+        ok = header->buffer_offset[b] + header->buffer_size <= size;
+    }
+    ok = ok && header->generations_offset + sizeof(uint32_t) * (uint64_t)header->generation_capacity <= header->buffer_size;
+    if (!ok) {
+        munmap(base, size);
+        return -1;
+    }
+
+    reader->header = header;
+    reader->size = size;
+    return 0;
+}
+
+bool shared_view_acquire(const SharedViewReader *reader, SharedViewFrame *frame) {
+    const SharedViewHeader *header = reader->header;
+    const uint32_t published = __atomic_load_n(&header->published, __ATOMIC_ACQUIRE);
+    if (published >= SHARED_VIEW_BUFFERS) return false;
+
+    const char *buffer = (const char*)header + header->buffer_offset[published];
+    const SharedViewFrameHeader *shared = (const SharedViewFrameHeader*)buffer;
+    frame->frame = shared;
+    frame->sequence = __atomic_load_n(&shared->sequence, __ATOMIC_ACQUIRE);
+    if (frame->sequence & 1) return false;  // the writer lapped us and is refilling it
+
+    // Counts can be torn like anything else read here; clamp so they stay in bounds
+    frame->tick = shared->tick;
+    frame->dense_count = shared->dense_count;
+    frame->generation_count = shared->generation_count;
+    if (frame->dense_count > header->capacity) frame->dense_count = header->capacity;
+    if (frame->generation_count > header->generation_capacity) frame->generation_count = header->generation_capacity;
+
+    frame->entities = (const uint32_t*)(buffer + header->entities_offset);
+    frame->components = buffer + header->components_offset;
+    frame->generations = (const uint32_t*)(buffer + header->generations_offset);
+    return true;
+}
+
+bool shared_view_frame_valid(const SharedViewFrame *frame) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&frame->frame->sequence, __ATOMIC_RELAXED) == frame->sequence;
+}
+
+void shared_view_close(SharedViewReader *reader) {
+    if (reader->header) munmap((void*)reader->header, reader->size);
+    reader->header = NULL;
+    reader->size = 0;
+}
+
+#else
+
+SharedView* shared_view_create(const char *name, uint32_t capacity, uint32_t component_size,
+                               uint32_t generation_capacity) {
+    (void)name;
+    (void)capacity;
+    (void)component_size;
+    (void)generation_capacity;
+    return NULL;
+}
+
+void shared_view_publish(SharedView *view, const SparseSet *set, const EntityManager *em, uint64_t tick) {
+    (void)view;
+    (void)set;
+    (void)em;
+    (void)tick;
+}
+
+void shared_view_destroy(SharedView *view) {
+    (void)view;
+}
+
+int shared_view_open(SharedViewReader *reader, const char *name, uint32_t component_size) {
+    (void)name;
+    (void)component_size;
+    reader->header = NULL;
+    reader->size = 0;
+    return -1;
+}
+
+bool shared_view_acquire(const SharedViewReader *reader, SharedViewFrame *frame) {
+    (void)reader;
+    (void)frame;
+    return false;
+}
+
+bool shared_view_frame_valid(const SharedViewFrame *frame) {
+    (void)frame;
+    return false;
+}
+
+void shared_view_close(SharedViewReader *reader) {
+    (void)reader;
+}
+
+#endif
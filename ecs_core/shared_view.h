@@ -0,0 +1,163 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_SHARED_VIEW_H
+#define SPARSE_STORAGE_LEARNING_SHARED_VIEW_H
+
+/**
+ * @file shared_view.h
+ * @brief Read-only view of a SparseSet for other processes, in POSIX shared memory
+ *
+ * The writer publishes the set's dense entities and components plus the
+ * entity generations into one of two buffers in a shared-memory object, then
+ * flips the header's published index. Each buffer carries a sequence number,
+ * odd while it is being written (a seqlock), so the writer never waits on
+ * readers: a reader maps the object read-only, takes the published buffer,
+ * reads it in place and then checks the sequence number didn't move. With
+ * two buffers the writer only touches the one being read after publishing
+ * twice, so a reader has a whole publish interval to finish.
+ *
+ * Object layout (native byte order, offsets in the header):
+ *   SharedViewHeader
+ *   buffer 0        SharedViewFrameHeader, entities[capacity],
+ *                   components[capacity] (64-byte aligned), generations[generation_capacity]
+ *   buffer 1        same
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sparse_set_storage.h"
+#include "entity_manager.h"
+
+#define SHARED_VIEW_MAGIC "ECSVIEW"
+#define SHARED_VIEW_VERSION 1
+#define SHARED_VIEW_BUFFERS 2
+
+/** Nothing published yet */
+#define SHARED_VIEW_NONE UINT32_MAX
+
+/**
+ * @brief Start of the shared object; fixed once the writer created it
+ */
+typedef struct {
+    char magic[8];                 /**< SHARED_VIEW_MAGIC */
+    uint32_t version;              /**< SHARED_VIEW_VERSION */
+    uint32_t header_size;          /**< sizeof(SharedViewHeader), to catch mismatched builds */
+    uint32_t capacity;             /**< Dense slots per buffer */
+    uint32_t component_size;       /**< Bytes per component */
+    uint32_t generation_capacity;  /**< Generations per buffer */
+    uint32_t writer_pid;
+    uint64_t buffer_offset[SHARED_VIEW_BUFFERS];
+    uint64_t buffer_size;
+    uint64_t entities_offset;      /**< Within a buffer */
+    uint64_t components_offset;
+    uint64_t generations_offset;
+    uint32_t published;            /**< Buffer holding the latest publish, SHARED_VIEW_NONE before the first */
+    uint32_t reserved;
+    uint64_t publish_count;        /**< Publishes so far */
+} SharedViewHeader;
+
+/**
+ * @brief Start of each buffer
+ */
+typedef struct {
+    uint64_t sequence;          /**< Odd while the writer fills the buffer */
+    uint64_t tick;              /**< Caller's clock at publish (e.g. the turn number) */
+    uint32_t dense_count;       /**< Valid entities and components */
+    uint32_t generation_count;  /**< Valid generations; IDs at or above it were never used */
+} SharedViewFrameHeader;
+
+/**
+ * @brief Writer side: owns and names the shared object
+ */
+typedef struct {
+    char name[64];
+    SharedViewHeader *header;   /**< Start of the mapping */
+    size_t size;
+    uint64_t publish_ns;        /**< Time spent in shared_view_publish(), summed */
+    uint64_t bytes;             /**< Bytes copied by shared_view_publish(), summed */
+} SharedView;
+
+/**
+ * @brief A reader's mapping of someone else's view
+ */
+typedef struct {
+    const SharedViewHeader *header;
+    size_t size;
+} SharedViewReader;
+
+/**
+ * @brief One published buffer, read in place
+ * @note The pointers are only meaningful until shared_view_frame_valid()
+ *       returns false; check it after using the data (or copying it out).
+ */
+typedef struct {
+    const SharedViewFrameHeader *frame;
+    uint64_t sequence;              /**< Sequence number seen when the frame was taken */
+    uint64_t tick;
+    uint32_t dense_count;
+    uint32_t generation_count;
+    const uint32_t *entities;
+    const void *components;
+    const uint32_t *generations;
+} SharedViewFrame;
+
+/**
+ * @brief Create (or replace) the shared-memory object `name` and map it
+ * @param name POSIX shared memory name, e.g. "/ecs_battle"
+ * @param capacity Largest dense count that will be published
+ * @param component_size Bytes per component (0 for index-only sets)
+ * @param generation_capacity Generations per publish, normally the entity capacity
+ * @return The view, or NULL if shared memory isn't available
+ * @note shared_view_destroy() unmaps and unlinks it.
+ */
+SharedView* shared_view_create(const char *name, uint32_t capacity, uint32_t component_size,
+                               uint32_t generation_capacity);
+
+/**
+ * @brief Copy the set's dense arrays and the live part of the generations into the idle buffer and publish it
+ * @param view The view
+ * @param set Set to publish; its dense count must fit the view's capacity
+ * @param em Entity manager whose generations to publish (may be NULL)
+ * @param tick Caller's clock, passed through to readers
+ * @note Never blocks. Cost is a copy of the dense range plus the
+ *       generations of every ID used so far (em->peak_living of them).
+ */
+void shared_view_publish(SharedView *view, const SparseSet *set, const EntityManager *em, uint64_t tick);
+
+/**
+ * @brief Unmap and unlink the view and free it
+ */
+void shared_view_destroy(SharedView *view);
+
+/**
+ * @brief Map an existing view read-only
+ * @param reader Reader to fill
+ * @param name Name the writer created it with
+ * @param component_size Component size the reader expects; 0 accepts any
+ * @return 0 on success, -1 if it doesn't exist or its layout doesn't match
+ */
+int shared_view_open(SharedViewReader *reader, const char *name, uint32_t component_size);
+
+/**
+ * @brief Take the latest published buffer
+ * @return true if frame now points at a buffer that wasn't being written
+ *         when taken; false if nothing is published or the writer was
+ *         mid-publish (try again)
+ */
+bool shared_view_acquire(const SharedViewReader *reader, SharedViewFrame *frame);
+
+/**
+ * @brief Whether everything read from frame since shared_view_acquire() is consistent
+ * @note False means the writer reused the buffer meanwhile: discard what was read.
+ */
+bool shared_view_frame_valid(const SharedViewFrame *frame);
+
+/**
+ * @brief Unmap a reader's view
+ */
+void shared_view_close(SharedViewReader *reader);
+
+#endif //SPARSE_STORAGE_LEARNING_SHARED_VIEW_H
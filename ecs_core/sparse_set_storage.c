@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include "sparse_set_storage.h"
+#include "field_index.h"
 
 #include <string.h>
 
@@ -14,6 +15,11 @@ void sparse_set_init(SparseSet *set, const uint32_t capacity, const size_t comp_
     set->comp_size = comp_size;
     set->dense_count = 0;
     set->arena = arena;
+    set->version = 1;
+    set->peak_count = 0;
+    set->name = NULL;
+    set->indices = NULL;
+    set->index_owned = false;
 
     // Allocate sparse array from arena
     set->sparse = arena_alloc(arena, sizeof(uint32_t) * capacity);
@@ -35,6 +41,7 @@ void sparse_set_init(SparseSet *set, const uint32_t capacity, const size_t comp_
 }
 
 void sparse_set_add(SparseSet *set, const uint32_t entity, const void *component_data) {
+    if (set->index_owned) return;
     const uint32_t index = set->sparse[entity];
 
     // If entity already has component, update in-place
@@ -44,11 +51,13 @@ void sparse_set_add(SparseSet *set, const uint32_t entity, const void *component
             void *dest = (char*)set->dense_data + (index * set->comp_size);
             memcpy(dest, component_data, set->comp_size);
         }
+        for (FieldIndex *fi = set->indices; fi; fi = fi->next) field_index_update(fi, entity);
         return;
     }
 
     // Create new component entry
     const uint32_t dense_index = set->dense_count++;
+    if (set->dense_count > set->peak_count) set->peak_count = set->dense_count;
     set->dense_entities[dense_index] = entity;
     set->sparse[entity] = dense_index;
 
@@ -57,13 +66,33 @@ void sparse_set_add(SparseSet *set, const uint32_t entity, const void *component
         void *dest = (char*)set->dense_data + (dense_index * set->comp_size);
         memcpy(dest, component_data, set->comp_size);
     }
+    for (FieldIndex *fi = set->indices; fi; fi = fi->next) field_index_update(fi, entity);
+}
+
+uint32_t sparse_set_add_batch(SparseSet *set, const uint32_t *entities, const uint32_t count) {
+    const uint32_t base = set->dense_count;
+
+    memcpy(set->dense_entities + base, entities, sizeof(uint32_t) * count);
+    for (uint32_t i = 0; i < count; i++) {
+        set->sparse[entities[i]] = base + i;
+    }
+
+    set->dense_count += count;
+    if (set->dense_count > set->peak_count) set->peak_count = set->dense_count;
+    return base;
+}
+
+void sparse_set_notify_written(SparseSet *set, const uint32_t dense_begin, const uint32_t count) {
+    for (FieldIndex *fi = set->indices; fi; fi = fi->next) field_index_update_dense(fi, dense_begin, count);
 }
 
 void sparse_set_remove(SparseSet *set, const uint32_t entity) {
+    if (set->index_owned) return; // its index keeps it in step with the source set
     const uint32_t index = set->sparse[entity];
     if (index == UINT32_MAX) {
         return; // Entity doesn't have this component
     }
+    for (FieldIndex *fi = set->indices; fi; fi = fi->next) field_index_remove(fi, entity);
 
     // Get the last entity's data for swap-and-pop
     const uint32_t last_index = set->dense_count - 1;
@@ -83,6 +112,9 @@ void sparse_set_remove(SparseSet *set, const uint32_t entity) {
     set->sparse[last_entity] = index;
     set->sparse[entity] = UINT32_MAX;
     set->dense_count--;
+
+    // The swap moved last_entity, so any cached dense index may now be wrong
+    set->version++;
 }
 
 void* sparse_set_get(const SparseSet *set, const uint32_t entity) {
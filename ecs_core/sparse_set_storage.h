@@ -15,10 +15,13 @@
  */
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 #include "arena.h"
 
+struct FieldIndex;
+
 /**
  * @brief Cache-friendly sparse set for component storage with O(1) operations
  *
@@ -35,7 +38,12 @@ typedef struct {
     uint32_t dense_count;     /**< Number of entities currently stored */
     uint32_t capacity;        /**< Maximum number of entities this set can hold */
     size_t comp_size;         /**< Size of each component in bytes, 0 for index-only sets */
+    uint32_t version;         /**< Structural version, bumped whenever existing dense indices may move */
+    uint32_t peak_count;      /**< Largest dense_count since init */
+    const char *name;         /**< Label for memory reports, NULL if unnamed */
     Arena *arena;             /**< Arena allocator used for memory management */
+    struct FieldIndex *indices; /**< Secondary indices kept up to date by add/remove, NULL if none (see field_index.h) */
+    bool index_owned;         /**< Members set of a FieldIndex, which alone moves its entities; add/remove are no-ops */
 } SparseSet;
 
 /**
@@ -45,6 +53,9 @@ typedef struct {
  * @param comp_size Size of each component in bytes (0 for index-only sets)
  * @param arena Arena allocator to use for memory allocation
  * @note Component data is aligned to 64 bytes for optimal cache performance
+ * @note The structural version starts at 1 so a zero stamp never looks fresh
+ * @note Clears the name, peak count, indices and index ownership; name the set
+ *       and declare its indices again after re-initializing
  */
 void sparse_set_init(SparseSet *set, uint32_t capacity, size_t comp_size, Arena *arena);
 
@@ -54,9 +65,35 @@ void sparse_set_init(SparseSet *set, uint32_t capacity, size_t comp_size, Arena
  * @param entity Entity ID to add/update
  * @param component_data Pointer to component data to copy (ignored for index-only sets)
  * @note If entity already has a component, the data is updated in-place
+ * @note Indexes new entities and re-keys updated ones in every attached index
+ * @note A no-op on an index-owned set (see field_index.h)
  */
 void sparse_set_add(SparseSet *set, uint32_t entity, const void *component_data);
 
+/**
+ * @brief Append entities without copying component data
+ * @param set Pointer to the SparseSet
+ * @param entities Entity IDs to append; none may already be in the set
+ * @param count Number of entities
+ * @return Dense index of entities[0]; entities[i] lands at the returned index + i
+ * @note Component slots are left uninitialized for the caller to fill in place
+ *       (e.g. from several threads, since the slots don't overlap)
+ * @note Existing dense indices don't move, so the structural version is unchanged
+ * @note Attached indices can't key the slots yet; call sparse_set_notify_written()
+ *       once they're filled
+ */
+uint32_t sparse_set_add_batch(SparseSet *set, const uint32_t *entities, uint32_t count);
+
+/**
+ * @brief Re-key components written in place in every attached index
+ * @param set Pointer to the SparseSet
+ * @param dense_begin Dense index of the first written component
+ * @param count Number of consecutive components written
+ * @note Entities not yet indexed (fresh sparse_set_add_batch() slots) are added
+ *       in dense order; a no-op for sets without indices
+ */
+void sparse_set_notify_written(SparseSet *set, uint32_t dense_begin, uint32_t count);
+
 /**
  * @brief Get a pointer to an entity's component data
  * @param set Pointer to the SparseSet
@@ -71,6 +108,11 @@ void* sparse_set_get(const SparseSet *set, uint32_t entity);
  * @param set Pointer to the SparseSet
  * @param entity Entity ID to remove
  * @note Uses swap-and-pop technique to maintain dense array compactness in O(1) time
+ * @note Bumps the structural version, invalidating cached dense indices
+ * @note Also drops the entity from every attached index
+ * @note A no-op on an index-owned set: its index already dropped the entity
+ *       when the source set removed it, and a swap-and-pop here would move
+ *       entities across bucket bounds
  */
 void sparse_set_remove(SparseSet *set, uint32_t entity);
 
@@ -0,0 +1,273 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "spatial_grid.h"
+
+#include <math.h>
+#include <string.h>
+
+// Upper bound on k for k-nearest queries (working set lives on the stack)
+#define SPATIAL_GRID_MAX_K 64
+
+// Group mask of nearest queries that skip no group
+#define SPATIAL_GRID_ALL_GROUPS 0xFFFFu
+
+void spatial_grid_init(SpatialGrid *grid, const uint32_t capacity,
+                       const float origin_x, const float origin_y, const float width, const float height,
+                       const float cell_size, Arena *arena) {
+    grid->origin_x = origin_x;
+    grid->origin_y = origin_y;
+    grid->cell_size = cell_size;
+    grid->inv_cell_size = 1.0f / cell_size;
+    grid->cols = (uint32_t)ceilf(width / cell_size);
+    grid->rows = (uint32_t)ceilf(height / cell_size);
+    if (grid->cols == 0) grid->cols = 1;
+    if (grid->rows == 0) grid->rows = 1;
+    grid->capacity = capacity;
+
+    const size_t cell_count = (size_t)grid->cols * grid->rows;
+    grid->cell_head = arena_alloc(arena, sizeof(uint32_t) * cell_count * SPATIAL_GRID_MAX_GROUPS);
+    grid->cell_groups = arena_alloc(arena, sizeof(uint16_t) * cell_count);
+
+    // Per-entity arrays, aligned like SparseSet's dense data
+    grid->nodes = arena_alloc_aligned(arena, sizeof(SpatialGridNode) * capacity, 64);
+    grid->cell_of = arena_alloc_aligned(arena, sizeof(uint32_t) * capacity, 64);
+    grid->group = arena_alloc_aligned(arena, sizeof(uint8_t) * capacity, 64);
+
+    spatial_grid_clear(grid);
+}
+
+void spatial_grid_clear(SpatialGrid *grid) {
+    const size_t cell_count = (size_t)grid->cols * grid->rows;
+    for (size_t i = 0; i < cell_count * SPATIAL_GRID_MAX_GROUPS; i++) {
+        grid->cell_head[i] = UINT32_MAX;
+    }
+    memset(grid->cell_groups, 0, sizeof(uint16_t) * cell_count);
+    for (uint32_t i = 0; i < grid->capacity; i++) {
+        grid->cell_of[i] = UINT32_MAX;
+    }
+    grid->count = 0;
+}
+
+// Clamp a world coordinate to a cell column/row
+static inline uint32_t grid_coord(float value, float origin, float inv_cell_size, uint32_t limit) {
+    float c = (value - origin) * inv_cell_size;
+    if (!(c >= 0.0f)) return 0; // also catches NaN
+    uint32_t cell = (uint32_t)c;
+    return cell < limit ? cell : limit - 1;
+}
+
+static inline uint32_t grid_cell_for(const SpatialGrid *grid, float x, float y) {
+    const uint32_t cx = grid_coord(x, grid->origin_x, grid->inv_cell_size, grid->cols);
+    const uint32_t cy = grid_coord(y, grid->origin_y, grid->inv_cell_size, grid->rows);
+    return cy * grid->cols + cx;
+}
+
+// Head of a cell's list for one group; a group's heads are contiguous, so
+// single-group grids touch them like one head per cell
+static inline uint32_t* grid_head(const SpatialGrid *grid, uint32_t cell, uint32_t group) {
+    return &grid->cell_head[(size_t)group * grid->cols * grid->rows + cell];
+}
+
+static inline void grid_link(SpatialGrid *grid, uint32_t entity, uint32_t cell) {
+    const uint32_t group = grid->group[entity];
+    uint32_t *head = grid_head(grid, cell, group);
+    grid->nodes[entity].next = *head;
+    grid->nodes[entity].prev = UINT32_MAX;
+    if (*head != UINT32_MAX) grid->nodes[*head].prev = entity;
+    *head = entity;
+    grid->cell_of[entity] = cell;
+    grid->cell_groups[cell] |= (uint16_t)(1u << group);
+}
+
+static inline void grid_unlink(SpatialGrid *grid, uint32_t entity) {
+    const uint32_t cell = grid->cell_of[entity];
+    const uint32_t group = grid->group[entity];
+    const uint32_t next = grid->nodes[entity].next;
+    const uint32_t prev = grid->nodes[entity].prev;
+
+    if (prev != UINT32_MAX) {
+        grid->nodes[prev].next = next;
+    } else {
+        *grid_head(grid, cell, group) = next;
+        if (next == UINT32_MAX) grid->cell_groups[cell] &= (uint16_t)~(1u << group);
+    }
+    if (next != UINT32_MAX) grid->nodes[next].prev = prev;
+
+    grid->cell_of[entity] = UINT32_MAX;
+}
+
+void spatial_grid_insert(SpatialGrid *grid, const uint32_t entity, const float x, const float y) {
+    spatial_grid_insert_group(grid, entity, x, y, 0);
+}
+
+void spatial_grid_insert_group(SpatialGrid *grid, const uint32_t entity, const float x, const float y,
+                               const uint8_t group) {
+    if (entity >= grid->capacity || group >= SPATIAL_GRID_MAX_GROUPS) return;
+
+    // An entity changing groups moves to the other group's list
+    if (grid->cell_of[entity] != UINT32_MAX && grid->group[entity] != group) {
+        grid_unlink(grid, entity);
+        grid->count--;
+    }
+    grid->group[entity] = group;
+
+    if (grid->cell_of[entity] != UINT32_MAX) {
+        spatial_grid_move(grid, entity, x, y);
+        return;
+    }
+
+    grid->nodes[entity].x = x;
+    grid->nodes[entity].y = y;
+    grid_link(grid, entity, grid_cell_for(grid, x, y));
+    grid->count++;
+}
+
+void spatial_grid_remove(SpatialGrid *grid, const uint32_t entity) {
+    if (entity >= grid->capacity || grid->cell_of[entity] == UINT32_MAX) {
+        return; // Not in the grid
+    }
+
+    grid_unlink(grid, entity);
+    grid->count--;
+}
+
+void spatial_grid_move(SpatialGrid *grid, const uint32_t entity, const float x, const float y) {
+    if (entity >= grid->capacity) return;
+
+    const uint32_t old_cell = grid->cell_of[entity];
+    if (old_cell == UINT32_MAX) {
+        spatial_grid_insert(grid, entity, x, y);
+        return;
+    }
+
+    grid->nodes[entity].x = x;
+    grid->nodes[entity].y = y;
+
+    // Most moves stay inside the same cell; only relink on a boundary crossing
+    const uint32_t new_cell = grid_cell_for(grid, x, y);
+    if (new_cell != old_cell) {
+        grid_unlink(grid, entity);
+        grid_link(grid, entity, new_cell);
+    }
+}
+
+uint32_t spatial_grid_query_radius(const SpatialGrid *grid, const float x, const float y, const float radius,
+                                   uint32_t *out_entities, const uint32_t max_out) {
+    const uint32_t min_cx = grid_coord(x - radius, grid->origin_x, grid->inv_cell_size, grid->cols);
+    const uint32_t max_cx = grid_coord(x + radius, grid->origin_x, grid->inv_cell_size, grid->cols);
+    const uint32_t min_cy = grid_coord(y - radius, grid->origin_y, grid->inv_cell_size, grid->rows);
+    const uint32_t max_cy = grid_coord(y + radius, grid->origin_y, grid->inv_cell_size, grid->rows);
+    const float radius_sq = radius * radius;
+    uint32_t found = 0;
+
+    for (uint32_t cy = min_cy; cy <= max_cy; cy++) {
+        for (uint32_t cx = min_cx; cx <= max_cx; cx++) {
+            const uint32_t cell = cy * grid->cols + cx;
+            for (uint32_t groups = grid->cell_groups[cell]; groups; groups &= groups - 1) {
+                const uint32_t group = (uint32_t)__builtin_ctz(groups);
+                for (uint32_t e = *grid_head(grid, cell, group); e != UINT32_MAX; e = grid->nodes[e].next) {
+                    const float dx = grid->nodes[e].x - x;
+                    const float dy = grid->nodes[e].y - y;
+                    if (dx * dx + dy * dy <= radius_sq) {
+                        if (found < max_out) out_entities[found] = e;
+                        found++;
+                    }
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+// Offer one candidate to the sorted k-best list
+static inline void nearest_offer(uint32_t *ids, float *dists, uint32_t *count, uint32_t k,
+                                 uint32_t entity, float dist_sq) {
+    if (*count == k && dist_sq >= dists[k - 1]) return;
+
+    uint32_t pos = (*count < k) ? (*count)++ : k - 1;
+    while (pos > 0 && dists[pos - 1] > dist_sq) {
+        ids[pos] = ids[pos - 1];
+        dists[pos] = dists[pos - 1];
+        pos--;
+    }
+    ids[pos] = entity;
+    dists[pos] = dist_sq;
+}
+
+// Walks the cell's lists of the groups in `groups` (a mask)
+static inline void nearest_scan_cell(const SpatialGrid *grid, uint32_t cell, float x, float y, float max_sq,
+                                     uint32_t groups, uint32_t *ids, float *dists, uint32_t *count, uint32_t k) {
+    for (groups &= grid->cell_groups[cell]; groups; groups &= groups - 1) {
+        const uint32_t group = (uint32_t)__builtin_ctz(groups);
+        for (uint32_t e = *grid_head(grid, cell, group); e != UINT32_MAX; e = grid->nodes[e].next) {
+            const SpatialGridNode *node = &grid->nodes[e];
+            const float dx = node->x - x;
+            const float dy = node->y - y;
+            const float d = dx * dx + dy * dy;
+            if (d <= max_sq) nearest_offer(ids, dists, count, k, e, d);
+        }
+    }
+}
+
+static inline uint32_t query_nearest(const SpatialGrid *grid, const float x, const float y, uint32_t k,
+                                     const float max_radius, const uint32_t groups,
+                                     uint32_t *out_entities, float *out_dist_sq) {
+    if (k == 0 || grid->count == 0) return 0;
+    if (k > SPATIAL_GRID_MAX_K) k = SPATIAL_GRID_MAX_K;
+
+    float dists[SPATIAL_GRID_MAX_K];
+    uint32_t found = 0;
+    const float max_sq = max_radius * max_radius;
+
+    const int32_t cx = (int32_t)grid_coord(x, grid->origin_x, grid->inv_cell_size, grid->cols);
+    const int32_t cy = (int32_t)grid_coord(y, grid->origin_y, grid->inv_cell_size, grid->rows);
+    const int32_t cols = (int32_t)grid->cols;
+    const int32_t rows = (int32_t)grid->rows;
+    const int32_t max_ring = (cols > rows ? cols : rows);
+
+    for (int32_t ring = 0; ring <= max_ring; ring++) {
+        // Everything in this ring or beyond is at least (ring - 1) cells away
+        const float ring_min = (float)(ring > 0 ? ring - 1 : 0) * grid->cell_size;
+        const float ring_min_sq = ring_min * ring_min;
+        if (ring_min_sq > max_sq) break;
+        if (found == k && ring_min_sq >= dists[k - 1]) break;
+
+        const int32_t y0 = cy - ring, y1 = cy + ring;
+        const int32_t x0 = cx - ring, x1 = cx + ring;
+
+        // Top and bottom rows of the ring
+        for (int32_t gx = x0; gx <= x1; gx++) {
+            if (gx < 0 || gx >= cols) continue;
+            if (y0 >= 0) nearest_scan_cell(grid, (uint32_t)(y0 * cols + gx), x, y, max_sq, groups, out_entities, dists, &found, k);
+            if (ring > 0 && y1 < rows) nearest_scan_cell(grid, (uint32_t)(y1 * cols + gx), x, y, max_sq, groups, out_entities, dists, &found, k);
+        }
+        // Left and right columns, excluding the corners already visited
+        for (int32_t gy = y0 + 1; gy <= y1 - 1; gy++) {
+            if (gy < 0 || gy >= rows) continue;
+            if (x0 >= 0) nearest_scan_cell(grid, (uint32_t)(gy * cols + x0), x, y, max_sq, groups, out_entities, dists, &found, k);
+            if (x1 < cols) nearest_scan_cell(grid, (uint32_t)(gy * cols + x1), x, y, max_sq, groups, out_entities, dists, &found, k);
+        }
+    }
+
+    if (out_dist_sq) {
+        for (uint32_t i = 0; i < found; i++) out_dist_sq[i] = dists[i];
+    }
+    return found;
+}
+
+uint32_t spatial_grid_query_nearest(const SpatialGrid *grid, const float x, const float y, const uint32_t k,
+                                    const float max_radius, uint32_t *out_entities, float *out_dist_sq) {
+    return query_nearest(grid, x, y, k, max_radius, SPATIAL_GRID_ALL_GROUPS, out_entities, out_dist_sq);
+}
+
+uint32_t spatial_grid_query_nearest_excluding(const SpatialGrid *grid, const float x, const float y,
+                                              const uint32_t k, const float max_radius,
+                                              const uint8_t exclude_group,
+                                              uint32_t *out_entities, float *out_dist_sq) {
+    const uint32_t groups = exclude_group < SPATIAL_GRID_MAX_GROUPS
+                          ? SPATIAL_GRID_ALL_GROUPS & ~(1u << exclude_group) : SPATIAL_GRID_ALL_GROUPS;
+    return query_nearest(grid, x, y, k, max_radius, groups, out_entities, out_dist_sq);
+}
@@ -0,0 +1,178 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_SPATIAL_GRID_H
+#define SPARSE_STORAGE_LEARNING_SPATIAL_GRID_H
+
+/**
+ * @file spatial_grid.h
+ * @brief Uniform-grid spatial index with incremental updates and proximity queries
+ *
+ * Buckets entity IDs into fixed-size square cells so that radius and
+ * k-nearest queries only visit the cells around the query point instead of
+ * every entity. Each cell is an intrusive doubly-linked list threaded
+ * through per-entity arrays, which makes insert, remove and move O(1) and
+ * lets a moving entity stay put when it does not cross a cell boundary.
+ *
+ * Every entity also carries a small group number (a team, say), so one grid
+ * can hold several kinds of entity and a nearest query can skip one of them
+ * instead of each kind needing a grid of its own. A cell keeps one list per
+ * group plus a bitmask of the non-empty ones, so queries only walk the lists
+ * they want and a skipped group costs nothing, however crowded the cell.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "arena.h"
+
+/** Number of groups entities can be inserted with (bits in a cell's group mask) */
+#define SPATIAL_GRID_MAX_GROUPS 16
+
+/**
+ * @brief Per-entity grid record, packed so a list walk touches one cache line per entity
+ */
+typedef struct {
+    float x;        /**< Last inserted X */
+    float y;        /**< Last inserted Y */
+    uint32_t next;  /**< Next entity in the same cell */
+    uint32_t prev;  /**< Previous entity in the same cell */
+} SpatialGridNode;
+
+/**
+ * @brief Uniform grid over a rectangular region, indexed by entity ID
+ *
+ * Positions outside the region are clamped into the border cells, so every
+ * entity is always findable. Per-entity arrays are sized to the entity
+ * capacity, mirroring SparseSet's sparse array.
+ *
+ * @note Uses UINT32_MAX as the end-of-list / not-in-grid sentinel
+ */
+typedef struct {
+    float origin_x;       /**< World X of the grid's left edge */
+    float origin_y;       /**< World Y of the grid's bottom edge */
+    float cell_size;      /**< Side length of a cell in world units */
+    float inv_cell_size;  /**< 1 / cell_size, avoids a divide per lookup */
+    uint32_t cols;        /**< Number of cells along X */
+    uint32_t rows;        /**< Number of cells along Y */
+    uint32_t *cell_head;  /**< First entity per group and cell, at group * cols * rows + cell
+                               (size: SPATIAL_GRID_MAX_GROUPS * cols * rows) */
+    uint16_t *cell_groups; /**< Bit g set while a cell's group g list is non-empty (size: cols * rows) */
+    SpatialGridNode *nodes; /**< Position and cell links per entity (size: capacity) */
+    uint32_t *cell_of;    /**< Cell each entity is in, UINT32_MAX if absent (size: capacity) */
+    uint8_t *group;       /**< Group each entity was inserted with (size: capacity) */
+    uint32_t capacity;    /**< Maximum entity ID + 1 */
+    uint32_t count;       /**< Number of entities currently in the grid */
+} SpatialGrid;
+
+/**
+ * @brief Initialize a grid covering [origin, origin + size) with square cells
+ * @param grid Pointer to the SpatialGrid to initialize
+ * @param capacity Maximum number of entity IDs the grid can hold
+ * @param origin_x Left edge of the covered region
+ * @param origin_y Bottom edge of the covered region
+ * @param width Width of the covered region
+ * @param height Height of the covered region
+ * @param cell_size Side length of each cell; roughly the typical query radius works well
+ * @param arena Arena allocator to use for memory allocation
+ * @note Takes SPATIAL_GRID_MAX_GROUPS list heads and a group mask per cell,
+ *       plus a node, cell index and group per entity
+ */
+void spatial_grid_init(SpatialGrid *grid, uint32_t capacity,
+                       float origin_x, float origin_y, float width, float height,
+                       float cell_size, Arena *arena);
+
+/**
+ * @brief Remove every entity from the grid without releasing memory
+ * @param grid Pointer to the SpatialGrid
+ * @note O(cells + capacity); use for full rebuilds, not per-turn updates
+ */
+void spatial_grid_clear(SpatialGrid *grid);
+
+/**
+ * @brief Insert an entity, or move it if it is already present
+ * @param grid Pointer to the SpatialGrid
+ * @param entity Entity ID to insert
+ * @param x World X position
+ * @param y World Y position
+ * @note Same as spatial_grid_insert_group() with group 0
+ */
+void spatial_grid_insert(SpatialGrid *grid, uint32_t entity, float x, float y);
+
+/**
+ * @brief Insert an entity in a group, or move it (and set its group) if it is already present
+ * @param grid Pointer to the SpatialGrid
+ * @param entity Entity ID to insert
+ * @param x World X position
+ * @param y World Y position
+ * @param group Group the entity belongs to, e.g. its team; below SPATIAL_GRID_MAX_GROUPS
+ * @note Entities with an out-of-range group are not inserted
+ */
+void spatial_grid_insert_group(SpatialGrid *grid, uint32_t entity, float x, float y, uint8_t group);
+
+/**
+ * @brief Remove an entity from the grid
+ * @param grid Pointer to the SpatialGrid
+ * @param entity Entity ID to remove
+ * @note Safely ignores entities that are not in the grid
+ */
+void spatial_grid_remove(SpatialGrid *grid, uint32_t entity);
+
+/**
+ * @brief Update an entity's position, relinking only if it changed cells
+ * @param grid Pointer to the SpatialGrid
+ * @param entity Entity ID to move (inserted if absent)
+ * @param x New world X position
+ * @param y New world Y position
+ */
+void spatial_grid_move(SpatialGrid *grid, uint32_t entity, float x, float y);
+
+/**
+ * @brief Collect entities within a radius of a point
+ * @param grid Pointer to the SpatialGrid
+ * @param x Query X position
+ * @param y Query Y position
+ * @param radius Search radius (inclusive)
+ * @param out_entities Output array of entity IDs
+ * @param max_out Capacity of out_entities
+ * @return Number of matches found; may exceed max_out, in which case only max_out were written
+ */
+uint32_t spatial_grid_query_radius(const SpatialGrid *grid, float x, float y, float radius,
+                                   uint32_t *out_entities, uint32_t max_out);
+
+/**
+ * @brief Find the k entities nearest to a point
+ * @param grid Pointer to the SpatialGrid
+ * @param x Query X position
+ * @param y Query Y position
+ * @param k Number of neighbours wanted
+ * @param max_radius Ignore entities farther than this (use INFINITY for no limit)
+ * @param out_entities Output entity IDs, nearest first (size: k)
+ * @param out_dist_sq Output squared distances matching out_entities, may be NULL
+ * @return Number of neighbours found (at most k)
+ * @note Searches rings of cells outward and stops as soon as no unvisited
+ *       cell can hold anything closer than the current k-th neighbour
+ */
+uint32_t spatial_grid_query_nearest(const SpatialGrid *grid, float x, float y, uint32_t k,
+                                    float max_radius, uint32_t *out_entities, float *out_dist_sq);
+
+/**
+ * @brief Find the k entities nearest to a point that are not in a given group
+ * @param grid Pointer to the SpatialGrid
+ * @param x Query X position
+ * @param y Query Y position
+ * @param k Number of neighbours wanted
+ * @param max_radius Ignore entities farther than this (use INFINITY for no limit)
+ * @param exclude_group Group to skip, e.g. the querying entity's own team
+ * @param out_entities Output entity IDs, nearest first (size: k)
+ * @param out_dist_sq Output squared distances matching out_entities, may be NULL
+ * @return Number of neighbours found (at most k)
+ * @note Visits cells like spatial_grid_query_nearest() but never walks the
+ *       excluded group's lists, so it costs what a grid without that group would
+ */
+uint32_t spatial_grid_query_nearest_excluding(const SpatialGrid *grid, float x, float y, uint32_t k,
+                                              float max_radius, uint8_t exclude_group,
+                                              uint32_t *out_entities, float *out_dist_sq);
+
+#endif //SPARSE_STORAGE_LEARNING_SPATIAL_GRID_H
@@ -0,0 +1,88 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "state_hash.h"
+#include <string.h>
+
+#define STATE_HASH_CHUNK_SEED 0x9e3779b97f4a7c15ull
+
+static inline uint32_t dirty_words(uint32_t chunks) {
+    return (chunks + 63) / 64;
+}
+
+// Hash of the live slots of one chunk, salted with its position so equal
+// chunks at different offsets don't cancel out in the XOR
+static uint64_t hash_chunk(const SparseSet *set, StateHashFn fn, uint32_t chunk) {
+    const uint32_t begin = chunk * STATE_HASH_CHUNK;
+    uint32_t end = begin + STATE_HASH_CHUNK;
+    if (end > set->dense_count) end = set->dense_count;
+
+    const char *data = set->dense_data;
+    const void *components = data ? data + (size_t)begin * set->comp_size : NULL;
+    return state_hash_mix(STATE_HASH_CHUNK_SEED * (chunk + 1) ^
+                          fn(components, set->dense_entities + begin, end - begin));
+}
+
+static inline uint64_t hash_finish(uint64_t combined, uint32_t count) {
+    return state_hash_mix(combined ^ ((uint64_t)count * STATE_HASH_CHUNK_SEED));
+}
+
+void state_hash_init(StateHash *sh, uint32_t capacity, StateHashFn fn, Arena *arena) {
+    sh->chunk_capacity = (capacity + STATE_HASH_CHUNK - 1) / STATE_HASH_CHUNK;
+    if (sh->chunk_capacity == 0) sh->chunk_capacity = 1;
+    sh->chunk_hash = arena_alloc(arena, sizeof(uint64_t) * sh->chunk_capacity);
+    sh->dirty = arena_alloc(arena, sizeof(uint64_t) * dirty_words(sh->chunk_capacity));
+    sh->fn = fn;
+    state_hash_reset(sh);
+}
+
+void state_hash_reset(StateHash *sh) {
+    memset(sh->chunk_hash, 0, sizeof(uint64_t) * sh->chunk_capacity);
+    memset(sh->dirty, 0, sizeof(uint64_t) * dirty_words(sh->chunk_capacity));
+    sh->tracked_count = 0;
+    sh->combined = 0;
+    sh->value = hash_finish(0, 0);
+}
+
+uint64_t state_hash_update(StateHash *sh, const SparseSet *set) {
+    const uint32_t count = set->dense_count;
+
+    // Chunks between the old and new end gained or lost slots
+    if (count != sh->tracked_count) {
+        const uint32_t lo = count < sh->tracked_count ? count : sh->tracked_count;
+        const uint32_t hi = count < sh->tracked_count ? sh->tracked_count : count;
+        for (uint32_t c = lo / STATE_HASH_CHUNK; c <= (hi - 1) / STATE_HASH_CHUNK; c++) {
+            sh->dirty[c >> 6] |= 1ull << (c & 63);
+        }
+    }
+
+    const uint32_t words = dirty_words(sh->chunk_capacity);
+    for (uint32_t w = 0; w < words; w++) {
+        uint64_t bits = sh->dirty[w];
+        if (!bits) continue;
+        sh->dirty[w] = 0;
+
+        while (bits) {
+            const uint32_t c = w * 64 + (uint32_t)__builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            sh->combined ^= sh->chunk_hash[c];
+            sh->chunk_hash[c] = (uint64_t)c * STATE_HASH_CHUNK < count ? hash_chunk(set, sh->fn, c) : 0;
+            sh->combined ^= sh->chunk_hash[c];
+        }
+    }
+
+    sh->tracked_count = count;
+    sh->value = hash_finish(sh->combined, count);
+    return sh->value;
+}
+
+uint64_t state_hash_full(const SparseSet *set, StateHashFn fn) {
+    uint64_t combined = 0;
+    const uint32_t chunks = (set->dense_count + STATE_HASH_CHUNK - 1) / STATE_HASH_CHUNK;
+    for (uint32_t c = 0; c < chunks; c++) {
+        combined ^= hash_chunk(set, fn, c);
+    }
+    return hash_finish(combined, set->dense_count);
+}
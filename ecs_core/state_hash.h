@@ -0,0 +1,115 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_STATE_HASH_H
+#define SPARSE_STORAGE_LEARNING_STATE_HASH_H
+
+/**
+ * @file state_hash.h
+ * @brief Incremental hash of a SparseSet's dense contents
+ *
+ * The dense range is split into chunks of STATE_HASH_CHUNK slots. Each chunk
+ * hashes its entity IDs and components in dense order; the set's hash
+ * combines every chunk's hash with its position and the dense count. Systems
+ * mark the dense slots they write, and state_hash_update() only rehashes
+ * the marked chunks, so a turn that touches a few units costs a few chunks.
+ *
+ * Appends and removals at the end of the dense range are picked up from the
+ * dense count alone; a swap-remove only needs the hole it filled marked.
+ */
+
+#include <stdint.h>
+#include "sparse_set_storage.h"
+#include "arena.h"
+
+/** Dense slots per hashed chunk */
+#define STATE_HASH_CHUNK 256
+
+/**
+ * @brief Hash of a run of dense slots, in order
+ * @param components First component of the run, NULL for index-only sets
+ * @param entities Entity IDs of the same slots
+ * @param count Number of slots (at most STATE_HASH_CHUNK)
+ * @note Should cover exactly the fields that define the simulation state,
+ *       not caches derived from them. Called once per chunk, so the per-slot
+ *       loop can be inlined; it doesn't need to be a strong hash, each
+ *       chunk's result is finalized with state_hash_mix().
+ */
+typedef uint64_t (*StateHashFn)(const void *components, const uint32_t *entities, uint32_t count);
+
+/**
+ * @brief Per-chunk hashes and dirty bits for one SparseSet
+ */
+typedef struct {
+    uint64_t *chunk_hash;     /**< Contribution per chunk, 0 past the end of the dense range */
+    uint64_t *dirty;          /**< One bit per chunk */
+    uint32_t chunk_capacity;  /**< Chunks covering the set's full capacity */
+    uint32_t tracked_count;   /**< dense_count at the last update */
+    uint64_t combined;        /**< XOR of every chunk contribution */
+    uint64_t value;           /**< Hash returned by the last update */
+    StateHashFn fn;           /**< Hash of a run of slots */
+} StateHash;
+
+/**
+ * @brief Initialize an empty hash for a set of the given capacity
+ * @param sh Pointer to the StateHash to initialize
+ * @param capacity Capacity of the SparseSet it will track
+ * @param fn Hash of a run of slots
+ * @param arena Arena allocator for the chunk arrays
+ */
+void state_hash_init(StateHash *sh, uint32_t capacity, StateHashFn fn, Arena *arena);
+
+/**
+ * @brief Forget all tracked state, as if the set were empty
+ * @note Call whenever the set is re-initialized or its contents replaced wholesale
+ */
+void state_hash_reset(StateHash *sh);
+
+/**
+ * @brief Note that a dense slot's entity or component changed
+ * @param sh Pointer to the StateHash
+ * @param dense_index Slot that was written
+ */
+static inline void state_hash_mark(StateHash *sh, uint32_t dense_index) {
+    const uint32_t chunk = dense_index / STATE_HASH_CHUNK;
+    sh->dirty[chunk >> 6] |= 1ull << (chunk & 63);
+}
+
+/**
+ * @brief state_hash_mark() for slots written by several threads at once
+ * @note Neighbouring chunks share a word of dirty bits, so this one sets its bit atomically.
+ */
+static inline void state_hash_mark_concurrent(StateHash *sh, uint32_t dense_index) {
+    const uint32_t chunk = dense_index / STATE_HASH_CHUNK;
+    __atomic_fetch_or(&sh->dirty[chunk >> 6], 1ull << (chunk & 63), __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Rehash the marked chunks and return the set's hash
+ * @param sh Pointer to the StateHash
+ * @param set The tracked set
+ * @return Hash of the set's dense entities and components, also kept in sh->value
+ */
+uint64_t state_hash_update(StateHash *sh, const SparseSet *set);
+
+/**
+ * @brief Hash a set from scratch, ignoring dirty tracking
+ * @return The value state_hash_update() returns when every write was marked
+ * @note O(dense_count); meant for checking that systems mark what they write
+ */
+uint64_t state_hash_full(const SparseSet *set, StateHashFn fn);
+
+/**
+ * @brief 64-bit finalizer (splitmix64) for building StateHashFn implementations
+ */
+static inline uint64_t state_hash_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+#endif //SPARSE_STORAGE_LEARNING_STATE_HASH_H
@@ -0,0 +1,134 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "timing_wheel.h"
+
+#define SLOT_MASK (TIMING_WHEEL_SLOTS - 1)
+
+void timing_wheel_init(TimingWheel *tw, const uint32_t capacity, Arena *arena) {
+    tw->capacity = capacity;
+    tw->count = 0;
+    tw->now = 0;
+
+    tw->slot_head = arena_alloc(arena, sizeof(uint32_t) * TIMING_WHEEL_LEVELS * TIMING_WHEEL_SLOTS);
+    for (uint32_t i = 0; i < TIMING_WHEEL_LEVELS * TIMING_WHEEL_SLOTS; i++) {
+        tw->slot_head[i] = UINT32_MAX;
+    }
+
+    tw->next = arena_alloc_aligned(arena, sizeof(uint32_t) * capacity, 64);
+    tw->prev = arena_alloc_aligned(arena, sizeof(uint32_t) * capacity, 64);
+    tw->due = arena_alloc_aligned(arena, sizeof(uint32_t) * capacity, 64);
+    tw->slot_of = arena_alloc_aligned(arena, sizeof(uint32_t) * capacity, 64);
+    for (uint32_t i = 0; i < capacity; i++) {
+        tw->slot_of[i] = UINT32_MAX;
+    }
+}
+
+static inline void wheel_link(TimingWheel *tw, uint32_t entity, uint32_t slot) {
+    const uint32_t head = tw->slot_head[slot];
+    tw->next[entity] = head;
+    tw->prev[entity] = UINT32_MAX;
+    if (head != UINT32_MAX) tw->prev[head] = entity;
+    tw->slot_head[slot] = entity;
+    tw->slot_of[entity] = slot;
+}
+
+static inline void wheel_unlink(TimingWheel *tw, uint32_t entity) {
+    const uint32_t slot = tw->slot_of[entity];
+    const uint32_t next = tw->next[entity];
+    const uint32_t prev = tw->prev[entity];
+
+    if (prev != UINT32_MAX) tw->next[prev] = next;
+    else tw->slot_head[slot] = next;
+    if (next != UINT32_MAX) tw->prev[next] = prev;
+
+    tw->slot_of[entity] = UINT32_MAX;
+}
+
+// Pick the level whose span covers the remaining delay, then the slot for the due tick
+static inline uint32_t wheel_slot_for(const TimingWheel *tw, uint32_t due) {
+    if (due < tw->now) due = tw->now; // overdue: fire on the next advance
+    const uint32_t delta = due - tw->now;
+
+    uint32_t level = 0;
+    while (level < TIMING_WHEEL_LEVELS - 1 &&
+           delta >= (1u << (TIMING_WHEEL_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+
+    uint32_t slot;
+    if (level == TIMING_WHEEL_LEVELS - 1 &&
+        delta >= (1u << (TIMING_WHEEL_SLOT_BITS * TIMING_WHEEL_LEVELS)) - (1u << (TIMING_WHEEL_SLOT_BITS * level))) {
+        // Beyond the wheel's span: park in the slot just before the current top-level
+        // position, which is the last to cascade; it is re-bucketed from there
+        slot = ((tw->now >> (TIMING_WHEEL_SLOT_BITS * level)) - 1) & SLOT_MASK;
+    } else {
+        slot = (due >> (TIMING_WHEEL_SLOT_BITS * level)) & SLOT_MASK;
+    }
+    return level * TIMING_WHEEL_SLOTS + slot;
+}
+
+void timing_wheel_schedule(TimingWheel *tw, const uint32_t entity, const uint32_t due_tick) {
+    if (entity >= tw->capacity) return;
+
+    if (tw->slot_of[entity] != UINT32_MAX) {
+        wheel_unlink(tw, entity);
+    } else {
+        tw->count++;
+    }
+
+    tw->due[entity] = due_tick < tw->now ? tw->now : due_tick;
+    wheel_link(tw, entity, wheel_slot_for(tw, tw->due[entity]));
+}
+
+void timing_wheel_cancel(TimingWheel *tw, const uint32_t entity) {
+    if (entity >= tw->capacity || tw->slot_of[entity] == UINT32_MAX) {
+        return; // Nothing scheduled
+    }
+
+    wheel_unlink(tw, entity);
+    tw->count--;
+}
+
+// Re-bucket every entry of one higher-level slot relative to the current tick
+static void wheel_cascade(TimingWheel *tw, uint32_t level) {
+    const uint32_t slot = level * TIMING_WHEEL_SLOTS +
+                          ((tw->now >> (TIMING_WHEEL_SLOT_BITS * level)) & SLOT_MASK);
+
+    uint32_t e = tw->slot_head[slot];
+    tw->slot_head[slot] = UINT32_MAX;
+
+    while (e != UINT32_MAX) {
+        const uint32_t next = tw->next[e];
+        wheel_link(tw, e, wheel_slot_for(tw, tw->due[e]));
+        e = next;
+    }
+}
+
+uint32_t timing_wheel_advance(TimingWheel *tw, uint32_t *out_entities) {
+    // Entering a new block of a level: pull that level's slot down, coarsest first
+    // so entries cascading from level 2 into level 1 move on to level 0 this tick
+    for (uint32_t level = TIMING_WHEEL_LEVELS - 1; level > 0; level--) {
+        const uint32_t below_mask = (1u << (TIMING_WHEEL_SLOT_BITS * level)) - 1;
+        if ((tw->now & below_mask) == 0) {
+            wheel_cascade(tw, level);
+        }
+    }
+
+    const uint32_t slot = tw->now & SLOT_MASK;
+    uint32_t fired = 0;
+
+    uint32_t e = tw->slot_head[slot];
+    tw->slot_head[slot] = UINT32_MAX;
+    while (e != UINT32_MAX) {
+        const uint32_t next = tw->next[e];
+        tw->slot_of[e] = UINT32_MAX;
+        out_entities[fired++] = e;
+        e = next;
+    }
+
+    tw->count -= fired;
+    tw->now++;
+    return fired;
+}
@@ -0,0 +1,83 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_TIMING_WHEEL_H
+#define SPARSE_STORAGE_LEARNING_TIMING_WHEEL_H
+
+/**
+ * @file timing_wheel.h
+ * @brief Hierarchical timing wheel for per-entity event scheduling
+ *
+ * Schedules at most one pending event per entity ID and hands back, tick by
+ * tick, only the entities whose event is due. Scheduling, cancelling and
+ * firing are O(1); entries far in the future sit in coarser levels and are
+ * cascaded down as their time approaches, so idle entities cost nothing
+ * on ticks they do not fire.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "arena.h"
+
+#define TIMING_WHEEL_LEVELS 4       /**< Number of wheel levels */
+#define TIMING_WHEEL_SLOT_BITS 6    /**< log2 of slots per level */
+#define TIMING_WHEEL_SLOTS (1u << TIMING_WHEEL_SLOT_BITS) /**< Slots per level (64) */
+
+/**
+ * @brief Four-level, 64-slot hierarchical timing wheel keyed by entity ID
+ *
+ * Level L slot S holds entities whose due tick has bits [6L, 6L+6) equal to S.
+ * Level 0 covers the next 64 ticks exactly; the full wheel spans 2^24 ticks,
+ * and anything further out waits in the top level until it comes into range.
+ *
+ * @note Uses UINT32_MAX as the end-of-list / not-scheduled sentinel
+ */
+typedef struct {
+    uint32_t *slot_head;  /**< First entity per slot (size: LEVELS * SLOTS) */
+    uint32_t *next;       /**< Next entity in the same slot (size: capacity) */
+    uint32_t *prev;       /**< Previous entity in the same slot (size: capacity) */
+    uint32_t *slot_of;    /**< Slot each entity is in, UINT32_MAX if not scheduled (size: capacity) */
+    uint32_t *due;        /**< Due tick per entity (size: capacity) */
+    uint32_t now;         /**< Next tick timing_wheel_advance() will process */
+    uint32_t capacity;    /**< Maximum entity ID + 1 */
+    uint32_t count;       /**< Number of scheduled entities */
+} TimingWheel;
+
+/**
+ * @brief Initialize an empty wheel starting at tick 0
+ * @param tw Pointer to the TimingWheel to initialize
+ * @param capacity Maximum number of entity IDs that can be scheduled
+ * @param arena Arena allocator to use for memory allocation
+ */
+void timing_wheel_init(TimingWheel *tw, uint32_t capacity, Arena *arena);
+
+/**
+ * @brief Schedule (or reschedule) an entity's event
+ * @param tw Pointer to the TimingWheel
+ * @param entity Entity ID
+ * @param due_tick Tick at which the event fires; ticks already passed fire on the next advance
+ * @note Replaces any event already pending for this entity
+ */
+void timing_wheel_schedule(TimingWheel *tw, uint32_t entity, uint32_t due_tick);
+
+/**
+ * @brief Cancel an entity's pending event
+ * @param tw Pointer to the TimingWheel
+ * @param entity Entity ID
+ * @note Safely ignores entities with nothing scheduled
+ */
+void timing_wheel_cancel(TimingWheel *tw, uint32_t entity);
+
+/**
+ * @brief Process the current tick and move to the next one
+ * @param tw Pointer to the TimingWheel
+ * @param out_entities Output array of entities due this tick (size: capacity)
+ * @return Number of entities written to out_entities
+ * @note Fired entities are no longer scheduled; reschedule them to repeat.
+ *       After the call, the processed tick is tw->now - 1.
+ */
+uint32_t timing_wheel_advance(TimingWheel *tw, uint32_t *out_entities);
+
+#endif //SPARSE_STORAGE_LEARNING_TIMING_WHEEL_H
@@ -5,53 +5,185 @@
 #include "entity_factory.h"
 #include "world.h"
 #include "components.h"
+#include "ecs_core/parallel.h"
+#include "ecs_core/profiler.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-Entity spawn_soldier(World *world, uint8_t team_id, uint32_t unit_number) {
-    Entity soldier = entity_create(world->entity_manager);
+// Random draws per soldier: health, attack, defense, speed, x, y
+#define SPAWN_RANDOM_PER_UNIT 6
+// Units per RNG stream and per parallel chunk in spawn_army; a unit's stats
+// depend only on (seed, team, unit_number), not on the worker count
+#define SPAWN_RNG_BLOCK 4096
 
-    CombatantBundle bundle;
+typedef struct {
+    World *world;
+    CombatantBundle *bundles; // dense slots for this army, in unit order
+    uint8_t team_id;
+} SpawnJob;
 
+// Fill a soldier's bundle from its SPAWN_RANDOM_PER_UNIT random draws
+static void build_soldier(const World *world, uint8_t team_id, uint32_t unit_number,
+                          const uint32_t *r, CombatantBundle *bundle) {
     // Hot data
-    bundle.health = 100 + (rand() % 21); // 100 - 120
-    bundle.attack = 15 + (rand() % 11); // 15 - 25
-    bundle.defense = 5 + (rand() % 6); // 5 - 10
-    bundle.team_id = team_id;
-    bundle.is_attacking = false;
-    bundle.target = (Entity){UINT32_MAX, 0}; // invalid initially
+    bundle->health = 100 + (int)rng_bound(r[0], 21); // 100 - 120
+    bundle->attack = 15 + (int)rng_bound(r[1], 11); // 15 - 25
+    bundle->defense = 5 + (int)rng_bound(r[2], 6); // 5 - 10
+    bundle->team_id = team_id;
+    bundle->is_attacking = false;
+    bundle->target = resolved_handle_none(); // invalid initially
 
     // Cold data
-    bundle.max_health = bundle.health;
-    bundle.speed = 1.0f + (rand() % 100) / 100.0f; // 1.0 - 2.0
-    bundle.attack_cooldown = 0.0f;
-    bundle.unit_number = unit_number;
+    bundle->max_health = bundle->health;
+    bundle->speed = 1.0f + rng_bound(r[3], 100) / 100.0f; // 1.0 - 2.0
+    bundle->attack_cooldown = BASE_ATTACK_COOLDOWN / bundle->speed; // 1.5 - 3.0 turns
+    bundle->unit_number = unit_number;
 
-    snprintf(bundle.name, sizeof(bundle.name), "Team %c Soldier #%u",
-            team_id == 0 ? 'A' : 'B', unit_number);
+    // Teams deploy in vertical strips spread evenly from the left edge to the
+    // right one, together 80% of the width: with two teams, Team A takes the
+    // left 40% of the battlefield and Team B the right 40%
+    const uint32_t teams = world->team_count > 1 ? world->team_count : 1;
+    float deploy_width = world->battlefield_width * 0.8f / (float)teams;
+    float deploy_x = teams > 1 ? (world->battlefield_width - deploy_width) * (float)team_id / (float)(teams - 1) : 0.0f;
+    bundle->position.x = deploy_x + rng_unit_float(r[4]) * deploy_width;
+    bundle->position.y = rng_unit_float(r[5]) * world->battlefield_height;
+}
 
-    // Add the entire bundle to storage
-    sparse_set_add(world->combatant_storage, soldier.id, &bundle);
+// Systems that track entities outside the sparse sets
+static void register_soldier(World *world, uint32_t id, const CombatantBundle *bundle) {
+    // Everyone gets to act on the first turn
+    if (world->schedule_mode == SCHEDULE_COOLDOWN) {
+        timing_wheel_schedule(world->action_wheel, id, world->action_wheel->now);
+    }
 
-    // Add to team-specific index sets
-    if (team_id == 0) {
-        sparse_set_add(world->team_a_storage, soldier.id, NULL);
-        world->team_a_count++;
-    } else {
-        sparse_set_add(world->team_b_storage, soldier.id, NULL);
-        world->team_b_count++;
+    if (world->targeting_mode == TARGETING_NEAREST) {
+        spatial_grid_insert_group(world->spatial, id, bundle->position.x, bundle->position.y, bundle->team_id);
     }
+}
+
+// Count units spawned for a team, which also joins the battle
+static void count_spawned(World *world, uint8_t team_id, uint32_t count) {
+    world->team_spawned[team_id] += count;
+    if (team_id >= world->team_count) world->team_count = team_id + 1u;
+}
 
+Entity spawn_soldier(World *world, uint8_t team_id, uint32_t unit_number) {
+    if (team_id >= MAX_TEAMS) return (Entity){UINT32_MAX, 0};
+    uint32_t r[SPAWN_RANDOM_PER_UNIT];
+    rng_fill_u32(&world->rng, r, SPAWN_RANDOM_PER_UNIT);
+
+    Entity soldier = entity_create(world->entity_manager);
+
+    CombatantBundle bundle;
+    build_soldier(world, team_id, unit_number, r, &bundle);
+
+    // Add the entire bundle to storage; the team index picks it up
+    sparse_set_add(world->combatant_storage, soldier.id, &bundle);
+    count_spawned(world, team_id, 1);
+
+    register_soldier(world, soldier.id, &bundle);
     return soldier;
 }
 
+// One chunk is one RNG block, so the stats don't depend on which thread builds them
+static void spawn_chunk(void *ctx, uint32_t begin, uint32_t end) {
+    PROFILE_FUNCTION();
+    const SpawnJob *job = ctx;
+    uint32_t random[SPAWN_RANDOM_PER_UNIT * SPAWN_RNG_BLOCK];
+
+    Rng stream;
+    rng_seed_stream(&stream, job->world->seed, ((uint64_t)job->team_id << 32) | (begin / SPAWN_RNG_BLOCK));
+    rng_fill_u32(&stream, random, (size_t)(end - begin) * SPAWN_RANDOM_PER_UNIT);
+
+    for (uint32_t i = begin; i < end; i++) {
+        build_soldier(job->world, job->team_id, i + 1,
+                &random[(i - begin) * SPAWN_RANDOM_PER_UNIT], &job->bundles[i]);
+    }
+}
+
 void spawn_army(World *world, uint8_t team_id, uint32_t count) {
-    // Pre-allocate in batches for better cache locality
-    for (uint32_t i = 0; i < count; i++) {
-        spawn_soldier(world, team_id, i + 1);
+    PROFILE_FUNCTION();
+    if (team_id >= MAX_TEAMS) return;
+    size_t checkpoint = arena_checkpoint(world->battle_arena);
+    uint32_t *ids = arena_alloc(world->battle_arena, sizeof(uint32_t) * (count ? count : 1));
+
+    // Reserve every ID up front, then append them to the storage in one pass
+    count = entity_create_batch(world->entity_manager, count, ids);
+    uint32_t base = sparse_set_add_batch(world->combatant_storage, ids, count);
+    count_spawned(world, team_id, count);
+
+    // Bundles are built straight into their dense slots, one RNG block per chunk
+    SpawnJob job = {
+        .world = world,
+        .bundles = (CombatantBundle*)world->combatant_storage->dense_data + base,
+        .team_id = team_id,
+    };
+    parallel_for(count, SPAWN_RNG_BLOCK, world->worker_threads, spawn_chunk, &job);
+    sparse_set_notify_written(world->combatant_storage, base, count);
+
+    // The wheel and grid are linked lists, so registration stays serial (and in unit order)
+    if (world->schedule_mode == SCHEDULE_COOLDOWN || world->targeting_mode == TARGETING_NEAREST) {
+        for (uint32_t i = 0; i < count; i++) {
+            register_soldier(world, ids[i], &job.bundles[i]);
+        }
     }
 
+    arena_restore(world->battle_arena, checkpoint);
+
     // Force cache update after spawning
     world->needs_target_update = true;
-}
\ No newline at end of file
+}
+
+CombatantBundle* spawn_bulk_reserve(World *world, uint32_t count, uint32_t *ids, uint32_t *reserved) {
+    PROFILE_FUNCTION();
+    *reserved = entity_create_batch(world->entity_manager, count, ids);
+    const uint32_t base = sparse_set_add_batch(world->combatant_storage, ids, *reserved);
+    return (CombatantBundle*)world->combatant_storage->dense_data + base;
+}
+
+void spawn_bulk_commit(World *world, const uint32_t *ids, const CombatantBundle *bundles, uint32_t count) {
+    PROFILE_FUNCTION();
+    // The bundles are the reserved dense slots, now filled in
+    const uint32_t base = (uint32_t)(bundles - (const CombatantBundle*)world->combatant_storage->dense_data);
+
+    // The index counts the units per team as it buckets them; the teams' growth is what spawned
+    uint32_t before[MAX_TEAMS];
+    for (uint32_t t = 0; t < MAX_TEAMS; t++) before[t] = field_index_count(world->team_index, t);
+    sparse_set_notify_written(world->combatant_storage, base, count);
+    for (uint32_t t = 0; t < MAX_TEAMS; t++) {
+        const uint32_t spawned = field_index_count(world->team_index, t) - before[t];
+        if (spawned > 0) count_spawned(world, (uint8_t)t, spawned);
+    }
+
+    if (world->schedule_mode == SCHEDULE_COOLDOWN || world->targeting_mode == TARGETING_NEAREST) {
+        for (uint32_t i = 0; i < count; i++) {
+            register_soldier(world, ids[i], &bundles[i]);
+        }
+    }
+    world->needs_target_update = true;
+}
+
+void spawn_bulk_cancel(World *world, const uint32_t *ids, uint32_t count) {
+    // The reserved slots are the last ones, so removing them back to front moves nothing else
+    for (uint32_t i = count; i-- > 0;) {
+        sparse_set_remove(world->combatant_storage, ids[i]);
+        entity_destroy(world->entity_manager, (Entity){ids[i], world->entity_manager->generation[ids[i]]});
+    }
+}
+
+int unit_format_name(const CombatantBundle *unit, char *buf, size_t size) {
+    return snprintf(buf, size, "Team %c Soldier #%u", 'A' + unit->team_id, unit->unit_number);
+}
+
+const char* world_unit_name(const World *world, Entity e, char *buf, size_t size) {
+    if (e.id >= world->entity_manager->capacity || !entity_is_alive(world->entity_manager, e)) {
+        return NULL;
+    }
+
+    const CombatantBundle *unit = sparse_set_get(world->combatant_storage, e.id);
+    if (!unit) return NULL;
+
+    unit_format_name(unit, buf, size);
+    return buf;
+}
@@ -6,12 +6,37 @@
 #define SPARSE_STORAGE_LEARNING_ENTITY_FACTORY_H
 #include "world.h"
 #include <stdint.h>
+#include <stddef.h>
 #include "ecs_core/entity_manager.h"  // For Entity type
 
 // Forward declaration of World
 typedef struct World World;
 
+// team_id must be below MAX_TEAMS (nothing is spawned otherwise); units
+// deploy in their team's strip of the battlefield, laid out for team_count
+// teams, so set that first for battles of more than two
 Entity spawn_soldier(World *world, uint8_t team_id, uint32_t unit_number);
 void spawn_army(World *world, uint8_t team_id, uint32_t count);
 
+// Bulk insert for units the caller builds itself (e.g. from a scenario file).
+// Reserves up to count entities, appends them to the combatant storage and
+// returns their dense slots, in ID order, for the caller to fill; ids receives
+// the entity IDs and *reserved how many there are (fewer than count only at
+// capacity). Slots may be filled from any thread; team_ids must be below
+// MAX_TEAMS.
+CombatantBundle* spawn_bulk_reserve(World *world, uint32_t count, uint32_t *ids, uint32_t *reserved);
+// Once every reserved slot is built: add the units to the team index and
+// register them with the action wheel and spatial grid; bundles must be the
+// slots spawn_bulk_reserve returned
+void spawn_bulk_commit(World *world, const uint32_t *ids, const CombatantBundle *bundles, uint32_t count);
+// Undo spawn_bulk_reserve when the slots can't be built; must come before any
+// other insert
+void spawn_bulk_cancel(World *world, const uint32_t *ids, uint32_t count);
+
+// Unit names ("Team A Soldier #12") are formatted on demand from the bundle
+#define UNIT_NAME_MAX 32
+int unit_format_name(const CombatantBundle *unit, char *buf, size_t size);
+// Formats the name of a living entity into buf; returns buf, or NULL if e is dead
+const char* world_unit_name(const World *world, Entity e, char *buf, size_t size);
+
 #endif //SPARSE_STORAGE_LEARNING_ENTITY_FACTORY_H
\ No newline at end of file
@@ -1,52 +1,178 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <string.h>
+#include <unistd.h>
 #include "world.h"
 #include "entity_factory.h"
 #include "combat_system.h"
+#include "battle.h"
+#include "batch_runner.h"
+#include "sim_server.h"
+#include "battle_metrics.h"
 
 void run_battle(World *world) {
     clock_t start_time = clock();
 
     printf("\n=== BATTLE BEGINS ===\n");
-    world->battle_active = true;
+    BattleResult result = battle_run(world, BATTLE_MAX_TURNS);
 
-    while (world->battle_active && world->turn_number < 100000) {
-        //printf("\n--- Turn %u ---\n", ++world->turn_number);
-
-        // 1. Target acquisition
-        combat_system_target_acquisition(world);
-
-        // 2. Execute attacks
-        combat_system_execute_attacks(world);
+    if (result.timed_out) {
+        printf("\nBattle timeout - draw!\n");
+    } else {
+        printf("\n=== BATTLE COMPLETE ===\n");
+        if (result.winner >= 0) {
+            printf("Team %c wins with %u survivors!\n", 'A' + result.winner, result.survivors[result.winner]);
+        } else {
+            printf("It's a draw - mutual destruction!\n");
+        }
+    }
 
-        // 3. Process deaths
-        combat_system_process_deaths(world);
+    clock_t end_time = clock();
+    double time_taken = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
+    printf("\nBattle simulation finished in %.4f seconds (%u turns).\n", time_taken, result.turns);
+}
 
-        // 4. Check victory
-        if (combat_system_check_victory(world)) {
-            world->battle_active = false;
-            break;
+// --batch N --army A B [--seed S] [--threads T]: run N battles non-interactively
+static int run_batch(int argc, char **argv, TargetingMode targeting, ScheduleMode schedule) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    BatchConfig config = {
+        .battles = 1000,
+        .team_a_size = 1000,
+        .team_b_size = 1000,
+        .seed = (uint32_t)time(NULL),
+        .threads = cores > 0 ? (uint32_t)cores : 1,
+        .max_turns = BATTLE_MAX_TURNS,
+        .targeting_mode = targeting,
+        .schedule_mode = schedule,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            config.battles = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--army") == 0 && i + 2 < argc) {
+            config.team_a_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+            config.team_b_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config.threads = (uint32_t)strtoul(argv[++i], NULL, 10);
         }
+    }
 
-        // Optional: pause for dramatic effect
-        // getchar();  // Press enter to continue
+    printf("=== ECS BATTLE SIMULATOR (batch) ===\n");
+    BatchResult result;
+    if (batch_run(&config, &result) != 0) {
+        fprintf(stderr, "Batch run failed\n");
+        return 1;
     }
+    batch_result_print(&config, &result, stdout);
+    return 0;
+}
 
-    if (world->turn_number >= 100000) {
-        printf("\nBattle timeout - draw!\n");
+// --serve [--socket PATH] [--max-units N] [--threads T]: answer battle
+// requests from stdin or a Unix socket until EOF / termination (see sim_server.h)
+static int run_server(int argc, char **argv, TargetingMode targeting, ScheduleMode schedule, uint32_t threads) {
+    ServerConfig config = {
+        .socket_path = NULL,
+        .threads = threads,
+        .max_units = 1000000,
+        .targeting_mode = targeting,
+        .schedule_mode = schedule,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            config.socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--max-units") == 0 && i + 1 < argc) {
+            config.max_units = (uint32_t)strtoul(argv[++i], NULL, 10);
+        }
+    }
+    if (config.max_units < 2) {
+        fprintf(stderr, "--max-units must be at least 2\n");
+        return 2;
     }
 
-    clock_t end_time = clock();
-    double time_taken = ((double)(end_time - start_time)) / CLOCKS_PER_SEC;
-    printf("\nBattle simulation finished in %.4f seconds.\n", time_taken);
+    if (server_run(&config) != 0) {
+        fprintf(stderr, "Server failed\n");
+        return 1;
+    }
+    return 0;
 }
 
-int main() {
-    srand(time(NULL));
+int main(int argc, char **argv) {
+    // --nearest: units engage the nearest enemy instead of the weakest ones
+    // --cooldown: units attack when their cooldown expires instead of every turn
+    // --threads T: spawn armies on T threads (in batch mode: run T battles at once)
+    // --memory: print the world's memory footprint after each battle
+    // --journal FILE: record every battle's combat events (read with journal_dump)
+    // --serve: run as a battle server instead of prompting (see run_server)
+    // --metrics ADDR: serve live battle metrics for Prometheus on ADDR,
+    //   "unix:/path" or "[host:]port" (see ecs_core/metrics.h, battle_metrics.h)
+    TargetingMode targeting = TARGETING_WEAKEST;
+    ScheduleMode schedule = SCHEDULE_EVERY_TURN;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t threads = cores > 0 ? (uint32_t)cores : 1;
+    int batch = 0;
+    int serve = 0;
+    int memory_report = 0;
+    const char *journal_path = NULL;
+    const char *metrics_address = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--nearest") == 0) {
+            targeting = TARGETING_NEAREST;
+        } else if (strcmp(argv[i], "--cooldown") == 0) {
+            schedule = SCHEDULE_COOLDOWN;
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            batch = 1;
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            serve = 1;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--memory") == 0) {
+            memory_report = 1;
+        } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            journal_path = argv[++i];
+        } else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+            metrics_address = argv[++i];
+        }
+    }
+
+    if (metrics_address) {
+        battle_metrics_enable();
+        if (metrics_exporter_start(metrics_address) != 0) {
+            fprintf(stderr, "Cannot serve metrics on %s\n", metrics_address);
+            return 1;
+        }
+    }
+    if (batch) {
+        const int rc = run_batch(argc, argv, targeting, schedule);
+        metrics_exporter_stop();
+        return rc;
+    }
+    if (serve) {
+        const int rc = run_server(argc, argv, targeting, schedule, threads);
+        metrics_exporter_stop();
+        return rc;
+    }
 
     // Create world
     World *world = world_create(100000);
+    world->targeting_mode = targeting;
+    world->schedule_mode = schedule;
+    world->worker_threads = threads;
+    world_seed(world, (uint64_t)time(NULL));
+
+    Journal *journal = NULL;
+    if (journal_path) {
+        if (!(journal = journal_open(journal_path, 1))) {
+            fprintf(stderr, "Cannot open journal %s\n", journal_path);
+            world_destroy(world);
+            metrics_exporter_stop();
+            return 1;
+        }
+        world->journal = journal_ring(journal, 0);
+    }
 
     printf("=== ECS BATTLE SIMULATOR ===\n");
 
@@ -67,9 +193,20 @@ int main() {
 
         // Run the battle
         run_battle(world);
+
+        if (memory_report) {
+            WorldMemoryReport report;
+            world_memory_report(world, &report);
+            printf("\n=== MEMORY (bytes) ===\n");
+            memory_regions_print(report.regions, report.count, stdout);
+        }
     }
 
     printf("Thanks for playing!\n");
+    metrics_exporter_stop();
+    if (journal && journal_close(journal) != 0) {
+        fprintf(stderr, "Journal %s is incomplete\n", journal_path);
+    }
     world_destroy(world);
 
 
@@ -0,0 +1,450 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "scenario.h"
+#include "entity_factory.h"
+#include "ecs_core/parallel.h"
+#include "ecs_core/profiler.h"
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SCENARIO_HAVE_MMAP 1
+#endif
+
+#ifdef SCENARIO_HAVE_MMAP
+
+// Decimal digits kept in a float's mantissa; more are ignored
+#define SCENARIO_MAX_DIGITS 18
+
+typedef struct {
+    int health;
+    int attack;
+    int defense;
+    float speed;
+} ScenarioType;
+
+typedef struct {
+    ScenarioType *types;   // NULL when only the counts were wanted
+    uint32_t type_count;
+    uint32_t unit_count;
+    const char *units;     // first unit line
+    uint64_t units_line;   // line number of the "units" line
+} ScenarioHeader;
+
+// A run of whole unit lines, parsed by one thread
+typedef struct {
+    const char *begin;
+    const char *end;
+    uint32_t units;    // lines in the chunk
+    uint32_t base;     // index of its first unit
+    uint32_t error;    // first malformed unit in the chunk, UINT32_MAX if none
+} ScenarioChunk;
+
+typedef struct {
+    ScenarioChunk *chunks;
+    const ScenarioHeader *header;
+    CombatantBundle *bundles;  // reserved dense slots, one per unit
+} ScenarioJob;
+
+static const double pow10_table[SCENARIO_MAX_DIGITS + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9,
+    1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18,
+};
+
+// Multiplying beats dividing by pow10_table; the double product can be an
+// ulp off, which almost never survives the conversion to float
+static const double inv_pow10_table[SCENARIO_MAX_DIGITS + 1] = {
+    1e-0, 1e-1, 1e-2, 1e-3, 1e-4, 1e-5, 1e-6, 1e-7, 1e-8, 1e-9,
+    1e-10, 1e-11, 1e-12, 1e-13, 1e-14, 1e-15, 1e-16, 1e-17, 1e-18,
+};
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Field parsers work on [p, end) and return the position after the field,
+// or NULL if there isn't a valid one; they never read past end
+
+static inline const char* skip_blanks(const char *p, const char *end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+static const char* parse_u32(const char *p, const char *end, uint32_t *out) {
+    p = skip_blanks(p, end);
+    const char *digits = p;
+    uint64_t value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (uint64_t)(*p++ - '0');
+        if (value > UINT32_MAX) return NULL;
+    }
+    if (p == digits) return NULL;
+    *out = (uint32_t)value;
+    return p;
+}
+
+// [-]digits[.digits]; exact up to SCENARIO_MAX_DIGITS significant digits
+static const char* parse_float(const char *p, const char *end, float *out) {
+    p = skip_blanks(p, end);
+    const bool negative = p < end && *p == '-';
+    if (negative) p++;
+
+    uint64_t mantissa = 0;
+    int kept = 0, scale = 0, digits = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+        if (kept < SCENARIO_MAX_DIGITS) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            if (mantissa) kept++;
+        } else {
+            scale++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            if (kept < SCENARIO_MAX_DIGITS) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                if (mantissa) kept++;
+                scale--;
+            }
+        }
+    }
+    if (digits == 0 || scale > SCENARIO_MAX_DIGITS || scale < -SCENARIO_MAX_DIGITS) return NULL;
+
+    double value = (double)mantissa;
+    value *= scale < 0 ? inv_pow10_table[-scale] : pow10_table[scale];
+    *out = (float)(negative ? -value : value);
+    return p;
+}
+
+static const char* parse_word(const char *p, const char *end, const char *word) {
+    p = skip_blanks(p, end);
+    const size_t length = strlen(word);
+    if ((size_t)(end - p) < length || memcmp(p, word, length) != 0) return NULL;
+    p += length;
+    return p == end || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n' ? p : NULL;
+}
+
+// Trailing blanks and the line break; returns the start of the next line
+static const char* parse_line_end(const char *p, const char *end) {
+    p = skip_blanks(p, end);
+    if (p < end && *p == '\r') p++;
+    if (p == end) return p;
+    return *p == '\n' ? p + 1 : NULL;
+}
+
+static const char* next_line(const char *p, const char *end) {
+    const char *newline = memchr(p, '\n', (size_t)(end - p));
+    return newline ? newline + 1 : end;
+}
+
+// Eight bytes at a time: a byte of w ^ '\n'-pattern is zero exactly where
+// w has a '\n'; the mask leaves one bit per zero byte, summed by the multiply
+static uint32_t count_newlines(const char *p, const char *end) {
+    const uint64_t newlines = 0x0a0a0a0a0a0a0a0aull;
+    const uint64_t low7 = 0x7f7f7f7f7f7f7f7full;
+    uint32_t count = 0;
+    for (; end - p >= 8; p += 8) {
+        uint64_t w;
+        memcpy(&w, p, sizeof(w));
+        w ^= newlines;
+        const uint64_t found = ~(((w & low7) + low7) | w | low7) >> 7;
+        count += (uint32_t)((found * 0x0101010101010101ull) >> 56);
+    }
+    for (; p < end; p++) {
+        count += *p == '\n';
+    }
+    return count;
+}
+
+static const char* parse_type(const char *p, const char *end, ScenarioType *type) {
+    // Name: the first token, only for people reading the file
+    p = skip_blanks(p, end);
+    const char *name = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') p++;
+    if (p == name) return NULL;
+
+    uint32_t health, attack, defense;
+    float speed;
+    if (!(p = parse_u32(p, end, &health)) || !(p = parse_u32(p, end, &attack)) ||
+        !(p = parse_u32(p, end, &defense)) || !(p = parse_float(p, end, &speed))) {
+        return NULL;
+    }
+    if (health == 0 || health > INT32_MAX || attack > INT32_MAX || defense > INT32_MAX || !(speed > 0.0f)) {
+        return NULL;
+    }
+
+    type->health = (int)health;
+    type->attack = (int)attack;
+    type->defense = (int)defense;
+    type->speed = speed;
+    return parse_line_end(p, end);
+}
+
+// Everything up to the first unit line. Types are stored when scratch is
+// given, otherwise only checked.
+static int parse_header(const char *data, size_t size, Arena *scratch,
+                        ScenarioHeader *header, uint64_t *error_line) {
+    const char *end = data + size;
+    const char *p = data;
+    uint64_t line = 0;
+    uint32_t version = 0;
+    uint32_t types_seen = 0;
+    enum { EXPECT_MAGIC, EXPECT_TYPES, EXPECT_TYPE, EXPECT_UNITS } state = EXPECT_MAGIC;
+
+    memset(header, 0, sizeof(*header));
+    while (p < end) {
+        const char *q = p;
+        line++;
+
+        // Comments and blank lines
+        const char *first = skip_blanks(p, end);
+        if (first == end || *first == '#' || *first == '\r' || *first == '\n') {
+            p = next_line(p, end);
+            continue;
+        }
+
+        switch (state) {
+        case EXPECT_MAGIC:
+            if ((q = parse_word(q, end, SCENARIO_MAGIC)) && (q = parse_u32(q, end, &version)) &&
+                version == SCENARIO_VERSION) {
+                q = parse_line_end(q, end);
+            } else {
+                q = NULL;
+            }
+            state = EXPECT_TYPES;
+            break;
+        case EXPECT_TYPES:
+            if ((q = parse_word(q, end, "types")) && (q = parse_u32(q, end, &header->type_count)) &&
+                header->type_count > 0 && header->type_count <= SCENARIO_MAX_TYPES) {
+                q = parse_line_end(q, end);
+            } else {
+                q = NULL;
+            }
+            if (q && scratch) {
+                header->types = arena_alloc(scratch, sizeof(ScenarioType) * header->type_count);
+                if (!header->types) q = NULL;
+            }
+            state = EXPECT_TYPE;
+            break;
+        case EXPECT_TYPE: {
+            ScenarioType type;
+            q = parse_type(q, end, &type);
+            if (q && header->types) header->types[types_seen] = type;
+            if (++types_seen == header->type_count) state = EXPECT_UNITS;
+            break;
+        }
+        case EXPECT_UNITS:
+            if ((q = parse_word(q, end, "units")) && (q = parse_u32(q, end, &header->unit_count))) {
+                q = parse_line_end(q, end);
+            }
+            if (q) {
+                header->units = q;
+                header->units_line = line;
+                return 0;
+            }
+            break;
+        }
+
+        if (!q) {
+            *error_line = line;
+            return -1;
+        }
+        p = q;
+    }
+
+    *error_line = line + 1; // ran out before the units line
+    return -1;
+}
+
+// team type x y
+static const char* parse_unit(const char *p, const char *end, const ScenarioHeader *header,
+                              uint32_t index, CombatantBundle *bundle) {
+    uint32_t team, type_index;
+    float x, y;
+    if (!(p = parse_u32(p, end, &team)) || !(p = parse_u32(p, end, &type_index)) ||
+        !(p = parse_float(p, end, &x)) || !(p = parse_float(p, end, &y))) {
+        return NULL;
+    }
+    if (team >= MAX_TEAMS || type_index >= header->type_count) return NULL;
+
+    const ScenarioType *type = &header->types[type_index];
+    bundle->health = type->health;
+    bundle->attack = type->attack;
+    bundle->defense = type->defense;
+    bundle->team_id = (uint8_t)team;
+    bundle->is_attacking = false;
+    bundle->target = resolved_handle_none();
+    bundle->max_health = type->health;
+    bundle->speed = type->speed;
+    bundle->attack_cooldown = BASE_ATTACK_COOLDOWN / type->speed;
+    bundle->unit_number = index + 1;
+    bundle->position.x = x;
+    bundle->position.y = y;
+    return parse_line_end(p, end);
+}
+
+static void count_chunks(void *ctx, uint32_t begin, uint32_t end) {
+    ScenarioJob *job = ctx;
+    for (uint32_t c = begin; c < end; c++) {
+        ScenarioChunk *chunk = &job->chunks[c];
+        // A last line may lack its '\n'
+        chunk->units = count_newlines(chunk->begin, chunk->end) +
+                       (chunk->end > chunk->begin && chunk->end[-1] != '\n');
+    }
+}
+
+static void parse_chunks(void *ctx, uint32_t begin, uint32_t end) {
+    PROFILE_FUNCTION();
+    ScenarioJob *job = ctx;
+    for (uint32_t c = begin; c < end; c++) {
+        ScenarioChunk *chunk = &job->chunks[c];
+        const char *p = chunk->begin;
+        chunk->error = UINT32_MAX;
+        for (uint32_t i = 0; i < chunk->units; i++) {
+            p = parse_unit(p, chunk->end, job->header, chunk->base + i, &job->bundles[chunk->base + i]);
+            if (!p) {
+                chunk->error = i;
+                break;
+            }
+        }
+    }
+}
+
+static int load_units(World *world, const char *data, size_t size, const ScenarioHeader *header,
+                      ScenarioStats *stats) {
+    const char *end = data + size;
+    const EntityManager *em = world->entity_manager;
+
+    // Blank lines after the last unit (an editor's final newline) aren't units
+    while (end > header->units && (end[-1] == '\n' || end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) end--;
+    if (header->unit_count > em->capacity - em->living_count) {
+        stats->error_line = header->units_line;
+        return -1;
+    }
+
+    // Chunk boundaries: every SCENARIO_CHUNK_BYTES, moved to the next line start
+    const uint32_t max_chunks = (uint32_t)((size_t)(end - header->units) / SCENARIO_CHUNK_BYTES + 1);
+    ScenarioChunk *chunks = arena_alloc(world->battle_arena, sizeof(ScenarioChunk) * max_chunks);
+    uint32_t *ids = arena_alloc(world->battle_arena, sizeof(uint32_t) * (header->unit_count ? header->unit_count : 1));
+    if (!chunks || !ids) return -1;
+
+    uint32_t chunk_count = 0;
+    for (const char *p = header->units; p < end; chunk_count++) {
+        ScenarioChunk *chunk = &chunks[chunk_count];
+        chunk->begin = p;
+        chunk->end = (size_t)(end - p) > SCENARIO_CHUNK_BYTES ? next_line(p + SCENARIO_CHUNK_BYTES - 1, end) : end;
+        p = chunk->end;
+    }
+
+    ScenarioJob job = {chunks, header, NULL};
+    parallel_for(chunk_count, 1, world->worker_threads, count_chunks, &job);
+
+    uint32_t total = 0;
+    for (uint32_t c = 0; c < chunk_count; c++) {
+        chunks[c].base = total;
+        total += chunks[c].units;
+    }
+    if (total != header->unit_count) {
+        stats->error_line = header->units_line + 1 + (total < header->unit_count ? total : header->unit_count);
+        return -1;
+    }
+
+    uint32_t reserved;
+    job.bundles = spawn_bulk_reserve(world, header->unit_count, ids, &reserved);
+    parallel_for(chunk_count, 1, world->worker_threads, parse_chunks, &job);
+
+    for (uint32_t c = 0; c < chunk_count; c++) {
+        if (chunks[c].error != UINT32_MAX) {
+            stats->error_line = header->units_line + 1 + chunks[c].base + chunks[c].error;
+            spawn_bulk_cancel(world, ids, reserved);
+            return -1;
+        }
+    }
+
+    spawn_bulk_commit(world, ids, job.bundles, reserved);
+    stats->units = reserved;
+    return 0;
+}
+
+static const char* scenario_map(const char *path, size_t *size) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+
+    *size = (size_t)st.st_size;
+    void *data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+
+    // Every chunk gets read right away, just not in order
+    madvise(data, *size, MADV_WILLNEED);
+    return data;
+}
+
+int scenario_load(World *world, const char *path, ScenarioStats *stats) {
+    PROFILE_FUNCTION();
+    ScenarioStats unused;
+    if (!stats) stats = &unused;
+    memset(stats, 0, sizeof(*stats));
+    const uint64_t start = now_ns();
+
+    size_t size;
+    const char *data = scenario_map(path, &size);
+    if (!data) return -1;
+    stats->bytes = size;
+
+    // Type table, chunk table and entity IDs are scratch in the battle arena
+    const size_t checkpoint = arena_checkpoint(world->battle_arena);
+    ScenarioHeader header;
+    int rc = parse_header(data, size, world->battle_arena, &header, &stats->error_line);
+    if (rc == 0) {
+        stats->types = header.type_count;
+        rc = load_units(world, data, size, &header, stats);
+    }
+    arena_restore(world->battle_arena, checkpoint);
+
+    munmap((void*)data, size);
+    stats->load_ns = now_ns() - start;
+    return rc;
+}
+
+uint32_t scenario_unit_count(const char *path) {
+    size_t size;
+    const char *data = scenario_map(path, &size);
+    if (!data) return 0;
+
+    ScenarioHeader header;
+    uint64_t error_line;
+    const uint32_t count = parse_header(data, size, NULL, &header, &error_line) == 0 ? header.unit_count : 0;
+    munmap((void*)data, size);
+    return count;
+}
+
+#else
+
+int scenario_load(World *world, const char *path, ScenarioStats *stats) {
+    (void)world;
+    (void)path;
+    if (stats) memset(stats, 0, sizeof(*stats));
+    return -1;
+}
+
+uint32_t scenario_unit_count(const char *path) {
+    (void)path;
+    return 0;
+}
+
+#endif
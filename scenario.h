@@ -0,0 +1,57 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_SCENARIO_H
+#define SPARSE_STORAGE_LEARNING_SCENARIO_H
+
+#include "world.h"
+
+// Scenario files define armies as data instead of spawn_army's random ranges:
+// a table of unit types followed by one line per unit.
+//
+//   ecs-scenario 1
+//   # comments and blank lines are allowed in the header
+//   types 2
+//   infantry 110 18 7 1.2        name health attack defense speed
+//   archer 90 24 5 1.6
+//   units 3
+//   0 0 12.5 40.25               team type x y
+//   0 1 3.0 8.5
+//   1 0 70.75 22.0
+//
+// Every line after "units N" is a unit, exactly N of them (blank lines at the
+// end of the file are ignored); team is a team_id below MAX_TEAMS (0 is A,
+// 1 is B, ...) and type indexes the type table. Units get unit_number = their
+// line within the units section (1-based).
+//
+// Loading maps the file and splits the units section into chunks of
+// SCENARIO_CHUNK_BYTES at line boundaries. Chunks are counted, then parsed
+// in parallel (world->worker_threads) straight into the combatant storage's
+// dense slots, reserved in one go; only the team counts, grid and wheel are
+// filled serially afterwards. No memory is allocated per unit.
+
+#define SCENARIO_MAGIC "ecs-scenario"
+#define SCENARIO_VERSION 1
+#define SCENARIO_CHUNK_BYTES (1u << 20)
+#define SCENARIO_MAX_TYPES 65536
+
+typedef struct {
+    uint32_t units;        // units loaded
+    uint32_t types;        // unit types defined
+    uint64_t bytes;        // file size
+    uint64_t load_ns;      // mapping, parsing and inserting, wall clock
+    uint64_t error_line;   // first malformed line (1-based) when loading fails, 0 otherwise
+} ScenarioStats;
+
+// Spawn every unit of the scenario at path into the world, next to any units
+// it already has. Returns 0 on success; -1 if the file can't be read, is
+// malformed (stats->error_line says where) or doesn't fit the world's
+// capacity, in which case nothing is added. stats may be NULL.
+int scenario_load(World *world, const char *path, ScenarioStats *stats);
+
+// Units declared by the scenario at path, 0 if it isn't a readable scenario;
+// create the world to load it into with at least this capacity
+uint32_t scenario_unit_count(const char *path);
+
+#endif //SPARSE_STORAGE_LEARNING_SCENARIO_H
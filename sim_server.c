@@ -0,0 +1,485 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "sim_server.h"
+#include "battle.h"
+#include "entity_factory.h"
+#include "ecs_core/metrics.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// A request stream and where its responses go. The reader and every job it
+// queued hold a reference; the last one out frees it.
+typedef struct {
+    int in_fd;
+    int out_fd;
+    bool owns_fds;              // socket connection: close when released
+    bool broken;                // a write failed, drop later responses (under write_lock)
+    pthread_mutex_t write_lock; // one response line per write
+    uint32_t refs;
+} Connection;
+
+typedef struct {
+    Connection *conn;
+    char id[SERVER_MAX_ID + 1];
+    uint32_t team_a_size;
+    uint32_t team_b_size;
+    uint64_t seed;
+    uint32_t max_turns;
+    TargetingMode targeting_mode;
+    ScheduleMode schedule_mode;
+    uint64_t received_ns;
+} Job;
+
+// Bounded FIFO between the readers and the workers
+typedef struct {
+    Job jobs[SERVER_QUEUE_CAPACITY];
+    uint32_t head;
+    uint32_t count;
+    bool closed;
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+} JobQueue;
+
+typedef struct {
+    const ServerConfig *config;
+    JobQueue *queue;
+    uint32_t index;
+    World *worlds[SERVER_WORLD_CLASSES];  // warm worlds by size class, NULL until needed
+} Worker;
+
+typedef struct {
+    const ServerConfig *config;
+    JobQueue *queue;
+    Connection *conn;
+} Reader;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static Connection* connection_create(int in_fd, int out_fd, bool owns_fds) {
+    Connection *conn = calloc(1, sizeof(Connection));
+    if (!conn) return NULL;
+    conn->in_fd = in_fd;
+    conn->out_fd = out_fd;
+    conn->owns_fds = owns_fds;
+    conn->refs = 1;
+    pthread_mutex_init(&conn->write_lock, NULL);
+    return conn;
+}
+
+static void connection_retain(Connection *conn) {
+    __atomic_fetch_add(&conn->refs, 1, __ATOMIC_RELAXED);
+}
+
+static void connection_release(Connection *conn) {
+    if (__atomic_sub_fetch(&conn->refs, 1, __ATOMIC_ACQ_REL) != 0) return;
+    if (conn->owns_fds) {
+        close(conn->in_fd);
+        if (conn->out_fd != conn->in_fd) close(conn->out_fd);
+    }
+    pthread_mutex_destroy(&conn->write_lock);
+    free(conn);
+}
+
+// Write one response line whole, so lines from different workers never interleave
+static void respond(Connection *conn, const char *line, size_t len) {
+    pthread_mutex_lock(&conn->write_lock);
+    while (len > 0 && !conn->broken) {
+        const ssize_t written = write(conn->out_fd, line, len);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            conn->broken = true;  // client went away
+            break;
+        }
+        line += written;
+        len -= (size_t)written;
+    }
+    pthread_mutex_unlock(&conn->write_lock);
+}
+
+static void respond_error(Connection *conn, const char *id, const char *error) {
+    char line[SERVER_MAX_ID + 128];
+    int len;
+    if (id) {
+        len = snprintf(line, sizeof(line), "{\"id\": \"%s\", \"ok\": false, \"error\": \"%s\"}\n", id, error);
+    } else {
+        len = snprintf(line, sizeof(line), "{\"id\": null, \"ok\": false, \"error\": \"%s\"}\n", error);
+    }
+    respond(conn, line, (size_t)len);
+}
+
+static void queue_init(JobQueue *queue) {
+    queue->head = 0;
+    queue->count = 0;
+    queue->closed = false;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+}
+
+static void queue_destroy(JobQueue *queue) {
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+}
+
+// Blocks while the queue is full, which pushes back on clients that outrun the workers
+static void queue_push(JobQueue *queue, const Job *job) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == SERVER_QUEUE_CAPACITY) {
+        pthread_cond_wait(&queue->not_full, &queue->lock);
+    }
+    queue->jobs[(queue->head + queue->count) % SERVER_QUEUE_CAPACITY] = *job;
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+// False once the queue is closed and drained
+static bool queue_pop(JobQueue *queue, Job *job) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->closed) {
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    }
+    const bool got = queue->count > 0;
+    if (got) {
+        *job = queue->jobs[queue->head];
+        queue->head = (queue->head + 1) % SERVER_QUEUE_CAPACITY;
+        queue->count--;
+        pthread_cond_signal(&queue->not_full);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return got;
+}
+
+static void queue_close(JobQueue *queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = true;
+    pthread_cond_broadcast(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+static bool valid_id(const char *id, size_t len) {
+    if (len == 0 || len > SERVER_MAX_ID) return false;
+    for (size_t i = 0; i < len; i++) {
+        const char c = id[i];
+        const bool ok = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                        c == '-' || c == '_' || c == '.' || c == ':';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+static bool parse_u64(const char *token, uint64_t *out) {
+    if (*token < '0' || *token > '9') return false;
+    char *end;
+    errno = 0;
+    const unsigned long long value = strtoull(token, &end, 10);
+    if (*end != '\0' || errno != 0) return false;
+    *out = value;
+    return true;
+}
+
+// Fill job from one request line (modified in place). On error returns the
+// message, with job->id set when the ID itself was readable.
+static const char* parse_request(char *line, const ServerConfig *config, Job *job) {
+    job->id[0] = '\0';
+    job->targeting_mode = config->targeting_mode;
+    job->schedule_mode = config->schedule_mode;
+    job->max_turns = BATTLE_MAX_TURNS;
+
+    char *save = NULL;
+    const char *id = strtok_r(line, " \t", &save);
+    if (!id || !valid_id(id, strlen(id))) return "missing or malformed id";
+    memcpy(job->id, id, strlen(id) + 1);
+
+    uint64_t numbers[3];
+    for (int n = 0; n < 3; n++) {
+        const char *token = strtok_r(NULL, " \t", &save);
+        if (!token || !parse_u64(token, &numbers[n])) return "expected: ID A B SEED [options]";
+    }
+    if (numbers[0] == 0 || numbers[1] == 0) return "army sizes must be positive";
+    // Each side on its own first, so the sum below can't wrap
+    if (numbers[0] > config->max_units || numbers[1] > config->max_units - numbers[0]) return "army too large";
+    job->team_a_size = (uint32_t)numbers[0];
+    job->team_b_size = (uint32_t)numbers[1];
+    job->seed = numbers[2];
+
+    for (const char *token; (token = strtok_r(NULL, " \t", &save)) != NULL;) {
+        uint64_t turns;
+        if (strcmp(token, "nearest") == 0) {
+            job->targeting_mode = TARGETING_NEAREST;
+        } else if (strcmp(token, "weakest") == 0) {
+            job->targeting_mode = TARGETING_WEAKEST;
+        } else if (strcmp(token, "cooldown") == 0) {
+            job->schedule_mode = SCHEDULE_COOLDOWN;
+        } else if (strcmp(token, "every-turn") == 0) {
+            job->schedule_mode = SCHEDULE_EVERY_TURN;
+        } else if (strncmp(token, "turns=", 6) == 0 && parse_u64(token + 6, &turns) &&
+                   turns > 0 && turns <= BATTLE_MAX_TURNS) {
+            job->max_turns = (uint32_t)turns;
+        } else {
+            return "unknown option";
+        }
+    }
+    return NULL;
+}
+
+// Units held by a world of size class k
+static uint64_t class_capacity(uint32_t k, uint32_t max_units) {
+    const uint64_t capacity = (uint64_t)SERVER_SMALLEST_WORLD << (2 * k);
+    return (capacity < max_units && k + 1 < SERVER_WORLD_CLASSES) ? capacity : max_units;
+}
+
+// The smallest warm world that fits units, created on first use
+static World* worker_world(Worker *worker, uint64_t units) {
+    for (uint32_t k = 0; k < SERVER_WORLD_CLASSES; k++) {
+        const uint64_t capacity = class_capacity(k, worker->config->max_units);
+        if (capacity < units) continue;
+        if (!worker->worlds[k]) worker->worlds[k] = world_create(capacity);
+        return worker->worlds[k];
+    }
+    return NULL;
+}
+
+static const char* winner_name(int winner) {
+    return winner == 0 ? "A" : winner == 1 ? "B" : "draw";
+}
+
+static void run_job(Worker *worker, const Job *job) {
+    const uint64_t start = now_ns();
+    const uint64_t units = (uint64_t)job->team_a_size + job->team_b_size;
+    World *world = worker_world(worker, units);
+    if (!world) {
+        respond_error(job->conn, job->id, "out of memory");
+        return;
+    }
+
+    world->targeting_mode = job->targeting_mode;
+    world->schedule_mode = job->schedule_mode;
+    world_size_battlefield(world, units);
+    world_reset_battle(world);
+    world_seed(world, job->seed);
+    spawn_army(world, 0, job->team_a_size);
+    spawn_army(world, 1, job->team_b_size);
+    const uint64_t spawned = now_ns();
+
+    const BattleResult result = battle_run(world, job->max_turns);
+    const uint64_t done = now_ns();
+
+    char line[SERVER_MAX_ID + 256];
+    const int len = snprintf(line, sizeof(line),
+            "{\"id\": \"%s\", \"ok\": true, \"winner\": \"%s\", \"turns\": %u, \"timed_out\": %s, "
+            "\"team_a\": %u, \"team_b\": %u, \"worker\": %u, \"queue_us\": %llu, \"setup_us\": %llu, "
+            "\"battle_us\": %llu}\n",
+            job->id, winner_name(result.winner), result.turns, result.timed_out ? "true" : "false",
+            result.survivors[0], result.survivors[1], worker->index,
+            (unsigned long long)((start - job->received_ns) / 1000),
+            (unsigned long long)((spawned - start) / 1000), (unsigned long long)((done - spawned) / 1000));
+    respond(job->conn, line, (size_t)len);
+}
+
+static void* worker_main(void *arg) {
+    Worker *worker = arg;
+    Job job;
+    while (queue_pop(worker->queue, &job)) {
+        run_job(worker, &job);
+        connection_release(job.conn);
+    }
+    for (uint32_t k = 0; k < SERVER_WORLD_CLASSES; k++) {
+        if (worker->worlds[k]) world_destroy(worker->worlds[k]);
+    }
+    return NULL;
+}
+
+static void handle_line(char *line, size_t len, const ServerConfig *config, JobQueue *queue, Connection *conn) {
+    if (len > 0 && line[len - 1] == '\r') line[--len] = '\0';
+    if (len == 0) return;
+
+    Job job;
+    const char *error = parse_request(line, config, &job);
+    if (error) {
+        respond_error(conn, job.id[0] ? job.id : NULL, error);
+        return;
+    }
+    job.conn = conn;
+    job.received_ns = now_ns();
+    connection_retain(conn);
+    queue_push(queue, &job);
+}
+
+// Read requests off one stream until EOF, queueing each as soon as its line is complete
+static void serve_stream(const ServerConfig *config, JobQueue *queue, Connection *conn) {
+    char buffer[64 * 1024];
+    size_t used = 0;
+    bool skipping = false;  // inside a line that was too long
+
+    for (;;) {
+        const ssize_t got = read(conn->in_fd, buffer + used, sizeof(buffer) - used);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        used += (size_t)got;
+
+        size_t begin = 0;
+        for (char *newline; (newline = memchr(buffer + begin, '\n', used - begin)) != NULL;) {
+            const size_t end = (size_t)(newline - buffer);
+            *newline = '\0';
+            if (skipping) {
+                skipping = false;
+            } else if (end - begin > SERVER_MAX_LINE) {
+                respond_error(conn, NULL, "line too long");
+            } else {
+                handle_line(buffer + begin, end - begin, config, queue, conn);
+            }
+            begin = end + 1;
+        }
+
+        // Keep the partial line; one longer than the buffer can't be a request
+        memmove(buffer, buffer + begin, used - begin);
+        used -= begin;
+        if (used == sizeof(buffer)) {
+            if (!skipping) respond_error(conn, NULL, "line too long");
+            skipping = true;
+            used = 0;
+        }
+    }
+}
+
+static void* reader_main(void *arg) {
+    Reader *reader = arg;
+    serve_stream(reader->config, reader->queue, reader->conn);
+    connection_release(reader->conn);
+    free(reader);
+    return NULL;
+}
+
+static const char *listening_path;
+
+static void remove_socket_and_exit(int sig) {
+    (void)sig;
+    unlink(listening_path);
+    metrics_exporter_unlink();
+    _exit(0);
+}
+
+// Accept connections forever, one detached reader thread each
+static int serve_socket(const ServerConfig *config, JobQueue *queue) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(config->socket_path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "socket path too long: %s\n", config->socket_path);
+        return -1;
+    }
+    strcpy(addr.sun_path, config->socket_path);
+
+    // A socket left behind by an earlier run; never remove anything else
+    struct stat st;
+    if (stat(config->socket_path, &st) == 0 && S_ISSOCK(st.st_mode)) unlink(config->socket_path);
+
+    const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0 || bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, 64) != 0) {
+        perror(config->socket_path);
+        if (listen_fd >= 0) close(listen_fd);
+        return -1;
+    }
+
+    listening_path = config->socket_path;
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = remove_socket_and_exit;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    fprintf(stderr, "serving on %s with %u workers\n", config->socket_path, config->threads);
+
+    for (;;) {
+        const int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno != EINTR) perror("accept");
+            continue;
+        }
+
+        Connection *conn = connection_create(fd, fd, true);
+        Reader *reader = conn ? malloc(sizeof(Reader)) : NULL;
+        pthread_t thread;
+        if (!reader) {
+            if (conn) connection_release(conn);
+            else close(fd);
+            continue;
+        }
+        *reader = (Reader){config, queue, conn};
+        if (pthread_create(&thread, NULL, reader_main, reader) != 0) {
+            connection_release(conn);
+            free(reader);
+            continue;
+        }
+        pthread_detach(thread);
+    }
+}
+
+int server_run(const ServerConfig *config) {
+    const uint32_t threads = config->threads ? config->threads : 1;
+
+    // A client that disconnects must not take the server down with it
+    signal(SIGPIPE, SIG_IGN);
+
+    JobQueue *queue = malloc(sizeof(JobQueue));
+    Worker *workers = calloc(threads, sizeof(Worker));
+    pthread_t *handles = calloc(threads, sizeof(pthread_t));
+    if (!queue || !workers || !handles) {
+        free(queue);
+        free(workers);
+        free(handles);
+        return -1;
+    }
+    queue_init(queue);
+
+    uint32_t started = 0;
+    for (uint32_t t = 0; t < threads; t++) {
+        workers[t].config = config;
+        workers[t].queue = queue;
+        workers[t].index = t;
+        if (pthread_create(&handles[started], NULL, worker_main, &workers[t]) == 0) started++;
+    }
+
+    int status = started > 0 ? 0 : -1;
+    if (status == 0) {
+        if (config->socket_path) {
+            status = serve_socket(config, queue);
+        } else {
+            Connection *conn = connection_create(STDIN_FILENO, STDOUT_FILENO, false);
+            if (conn) {
+                serve_stream(config, queue, conn);
+                connection_release(conn);
+            } else {
+                status = -1;
+            }
+        }
+    }
+
+    // Workers finish whatever is queued, answering it, before they exit
+    queue_close(queue);
+    for (uint32_t t = 0; t < started; t++) pthread_join(handles[t], NULL);
+
+    queue_destroy(queue);
+    free(queue);
+    free(workers);
+    free(handles);
+    return status;
+}
@@ -0,0 +1,55 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_SIM_SERVER_H
+#define SPARSE_STORAGE_LEARNING_SIM_SERVER_H
+
+#include "world.h"
+
+// Long-running battle server. Requests arrive one per line, on stdin or on
+// connections to a Unix socket:
+//
+//   ID A B SEED [nearest|weakest] [cooldown|every-turn] [turns=N]
+//
+// ID is a client-chosen token (letters, digits, '-', '_', '.', ':'; at most
+// SERVER_MAX_ID bytes), A and B the army sizes, SEED seeds the battle exactly
+// like world_seed + spawn_army; omitted modes default to the server's. Every
+// request gets one JSON line back on the same stream, carrying its ID:
+//
+//   {"id": "7", "ok": true, "winner": "A", "turns": 412, "timed_out": false,
+//    "team_a": 311, "team_b": 0, "worker": 1, "queue_us": 12, "setup_us": 840,
+//    "battle_us": 10210}
+//   {"id": "8", "ok": false, "error": "army too large"}
+//
+// Clients may pipeline: requests are queued as soon as they are read and run
+// on worker threads, so responses come back in completion order, not request
+// order. queue_us is the wait between reading the request and a worker
+// starting it; setup_us covers world_reset_battle and spawning.
+//
+// Each worker keeps warm Worlds in size classes (SERVER_SMALLEST_WORLD units,
+// growing by 4x up to max_units), created on first use, and runs a request on
+// the smallest one that fits with its battlefield sized for the request, so
+// results match a world created for exactly that battle.
+
+#define SERVER_MAX_ID 32
+#define SERVER_MAX_LINE 256
+#define SERVER_QUEUE_CAPACITY 1024  // requests read but not started; readers wait when full
+#define SERVER_SMALLEST_WORLD 1024
+#define SERVER_WORLD_CLASSES 12
+
+typedef struct {
+    const char *socket_path;        // listen on this Unix socket; NULL serves stdin/stdout
+    uint32_t threads;               // battle workers
+    uint32_t max_units;             // largest A + B a request may ask for
+    TargetingMode targeting_mode;   // defaults for requests that don't name one
+    ScheduleMode schedule_mode;
+} ServerConfig;
+
+// Serve requests until stdin reaches EOF and every response is written, or,
+// with a socket, until the process is terminated (SIGINT/SIGTERM remove the
+// socket file). Returns 0 after a clean stdin session, -1 if the server
+// couldn't start.
+int server_run(const ServerConfig *config);
+
+#endif //SPARSE_STORAGE_LEARNING_SIM_SERVER_H
@@ -0,0 +1,219 @@
+//
+// Created by jo on 10/19/2026.
+//
+// What-if branching: runs a battle to a fork point, forks the world once per
+// branch and plays every branch out to the end on its own thread. Branch 0
+// continues unchanged; branch b gives team A's units b * FORK_DEFENSE_BOOST
+// more defense. Each fork shares the parent's battle arena copy-on-write, so the
+// fork itself costs page-table setup and the entity manager copy, and memory
+// grows with the pages each branch writes.
+//
+// Afterwards the parent plays on from the fork point as well, which must end
+// exactly like branch 0: a mismatch means a branch's writes leaked into the
+// parent. That check only means something if the branches' writes show, so
+// every boosted branch has to end differently from branch 0.
+//
+// Usage:
+//   battle_fork [--army A B] [--seed S] [--nearest] [--cooldown]
+//               [--fork-turn T] [--branches N] [--max-turns N]
+//
+// Exit status: 0 if the parent matched branch 0 and the boosted branches
+// diverged from it, 3 if the parent differs, 4 if a boosted branch didn't
+// diverge, 1/2 on errors.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "world.h"
+#include "entity_factory.h"
+#include "battle.h"
+#include "ecs_core/parallel.h"
+
+#define FORK_MAX_BRANCHES PARALLEL_MAX_THREADS
+#define FORK_DEFENSE_BOOST 1
+
+typedef struct {
+    uint32_t team_a_size;
+    uint32_t team_b_size;
+    uint64_t seed;
+    uint32_t fork_turn;
+    uint32_t branches;
+    uint32_t max_turns;
+    TargetingMode targeting_mode;
+    ScheduleMode schedule_mode;
+} ForkConfig;
+
+typedef struct {
+    World *world;
+    uint64_t fork_ns;
+    uint64_t run_ns;
+    BattleResult result;
+    uint64_t hash;
+    size_t private_bytes;   // battle arena pages the branch wrote
+} Branch;
+
+typedef struct {
+    Branch *branches;
+    uint32_t max_turns;
+} ForkRun;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int parse_args(int argc, char **argv, ForkConfig *config) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--army") == 0 && i + 2 < argc) {
+            config->team_a_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+            config->team_b_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--fork-turn") == 0 && i + 1 < argc) {
+            config->fork_turn = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--branches") == 0 && i + 1 < argc) {
+            config->branches = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-turns") == 0 && i + 1 < argc) {
+            config->max_turns = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--nearest") == 0) {
+            config->targeting_mode = TARGETING_NEAREST;
+        } else if (strcmp(argv[i], "--cooldown") == 0) {
+            config->schedule_mode = SCHEDULE_COOLDOWN;
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    if (config->branches == 0 || config->branches > FORK_MAX_BRANCHES) {
+        fprintf(stderr, "--branches must be 1..%d\n", FORK_MAX_BRANCHES);
+        return -1;
+    }
+    return 0;
+}
+
+// The what-if: every unit of team A blocks `boost` more damage per hit. Every
+// hit on A changes, so the branch plays out differently in any targeting
+// mode; boosting attack, or only a few units, vanishes into the overkill of
+// weakest targeting's focused fire
+static void apply_boost(World *world, uint32_t boost) {
+    SparseSet *set = world->combatant_storage;
+    CombatantBundle *bundles = set->dense_data;
+    for (uint32_t i = 0; i < set->dense_count; i++) {
+        if (bundles[i].team_id != 0) continue;
+        bundles[i].defense += (int)boost * FORK_DEFENSE_BOOST;
+        state_hash_mark(world->state_hash, i);
+    }
+}
+
+// One branch per chunk, so each runs on its own thread
+static void run_branches(void *ctx, uint32_t begin, uint32_t end) {
+    ForkRun *run = ctx;
+    for (uint32_t b = begin; b < end; b++) {
+        Branch *branch = &run->branches[b];
+        const uint64_t start = now_ns();
+        apply_boost(branch->world, b);
+        branch->result = battle_run(branch->world, run->max_turns);
+        branch->hash = world_state_hash(branch->world);
+        branch->run_ns = now_ns() - start;
+        branch->private_bytes = arena_private_bytes(branch->world->battle_arena);
+    }
+}
+
+static const char* winner_name(int winner) {
+    return winner == 0 ? "A" : winner == 1 ? "B" : "-";
+}
+
+int main(int argc, char **argv) {
+    ForkConfig config = {
+        .team_a_size = 100000,
+        .team_b_size = 100000,
+        .seed = 1,
+        .fork_turn = 20,
+        .branches = 8,
+        .max_turns = BATTLE_MAX_TURNS,
+        .targeting_mode = TARGETING_WEAKEST,
+        .schedule_mode = SCHEDULE_EVERY_TURN,
+    };
+    if (parse_args(argc, argv, &config) != 0) {
+        return 2;
+    }
+
+    World *world = world_create_forkable((size_t)config.team_a_size + config.team_b_size);
+    if (world->battle_arena->backing == ARENA_HEAP) {
+        fprintf(stderr, "shared memory arenas aren't available here\n");
+        world_destroy(world);
+        return 1;
+    }
+    world->targeting_mode = config.targeting_mode;
+    world->schedule_mode = config.schedule_mode;
+    world_seed(world, config.seed);
+    world_enable_state_hash(world);
+    spawn_army(world, 0, config.team_a_size);
+    spawn_army(world, 1, config.team_b_size);
+
+    const BattleResult before = battle_run(world, config.fork_turn);
+    if (!before.timed_out) {
+        fprintf(stderr, "battle ended at turn %u, before the fork point\n", before.turns);
+        world_destroy(world);
+        return 1;
+    }
+    printf("fork point: turn %u, %u vs %u alive, battle arena %.1f MB used\n",
+           before.turns, before.survivors[0], before.survivors[1],
+           world->battle_arena->offset / (1024.0 * 1024.0));
+
+    Branch branches[FORK_MAX_BRANCHES];
+    memset(branches, 0, sizeof(branches));
+    for (uint32_t b = 0; b < config.branches; b++) {
+        const uint64_t start = now_ns();
+        branches[b].world = world_fork(world);
+        branches[b].fork_ns = now_ns() - start;
+        if (!branches[b].world) {
+            fprintf(stderr, "world_fork failed for branch %u\n", b);
+            for (uint32_t i = 0; i < b; i++) world_destroy(branches[i].world);
+            world_destroy(world);
+            return 1;
+        }
+    }
+
+    ForkRun run = {branches, config.max_turns};
+    const uint64_t start = now_ns();
+    parallel_for(config.branches, 1, config.branches, run_branches, &run);
+    const uint64_t wall_ns = now_ns() - start;
+
+    printf("%-7s %10s %10s %7s %6s %9s %9s %12s %16s\n", "branch", "fork_us", "run_ms", "turns",
+           "winner", "a_alive", "b_alive", "private_MB", "state_hash");
+    for (uint32_t b = 0; b < config.branches; b++) {
+        const Branch *branch = &branches[b];
+        printf("%-7u %10.1f %10.1f %7u %6s %9u %9u %12.1f %016llx\n", b,
+               branch->fork_ns / 1e3, branch->run_ns / 1e6, branch->result.turns,
+               winner_name(branch->result.winner), branch->result.survivors[0],
+               branch->result.survivors[1], branch->private_bytes / (1024.0 * 1024.0),
+               (unsigned long long)branch->hash);
+    }
+    printf("%u branches in %.1f ms wall\n", config.branches, wall_ns / 1e6);
+
+    uint32_t unchanged = 0;
+    for (uint32_t b = 1; b < config.branches; b++) {
+        if (branches[b].hash == branches[0].hash && branches[b].result.turns == branches[0].result.turns) {
+            printf("branch %u ended exactly like branch 0: its boost had no effect\n", b);
+            unchanged++;
+        }
+    }
+
+    // Forks are gone; the parent plays on from the fork point like branch 0
+    for (uint32_t b = 0; b < config.branches; b++) world_destroy(branches[b].world);
+    const BattleResult result = battle_run(world, config.max_turns);
+    const uint64_t hash = world_state_hash(world);
+    const bool match = hash == branches[0].hash && result.turns == branches[0].result.turns;
+    printf("parent: %u turns, winner %s, state %016llx (%s branch 0)\n", result.turns,
+           winner_name(result.winner), (unsigned long long)hash, match ? "matches" : "DIFFERS from");
+
+    world_destroy(world);
+    return !match ? 3 : unchanged ? 4 : 0;
+}
@@ -0,0 +1,366 @@
+//
+// Created by jo on 10/19/2026.
+//
+// Records a battle as an initial snapshot plus a journal of per-turn state
+// hashes (and, by default, every combat event), then re-simulates it from the
+// snapshot and checks each turn's hash against the recording. The first turn
+// whose hash differs is reported; when both runs journaled their events, the
+// first combat event that differs names the entity. That can come turns
+// later (a unit's extra health only shows when it is hit or dies), so the
+// replay plays on to the end of the battle once it diverged.
+//
+// Usage:
+//   battle_replay record --snapshot FILE --journal FILE [--army A B] [--seed S]
+//                        [--nearest] [--cooldown] [--threads T] [--max-turns N]
+//                        [--hashes-only]
+//   battle_replay verify --snapshot FILE --journal FILE [--replay-journal FILE]
+//                        [--max-turns N] [--check] [--perturb TURN]
+//
+// --hashes-only journals just the state hashes, which is cheap enough for CI.
+// --replay-journal journals the re-simulation's events, needed to name the
+// divergent entity. --check also rehashes the whole storage every turn to
+// catch writes a system forgot to mark. --perturb gives a healthy unit of
+// each team an extra hit point at the start of TURN, to see what a divergence
+// report looks like; it skips the units weakest targeting focuses, so
+// overkill can't swallow the change.
+//
+// Exit status: 0 if the replay matched, 3 on divergence, 1/2 on errors.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "world.h"
+#include "world_snapshot.h"
+#include "entity_factory.h"
+#include "combat_system.h"
+#include "battle.h"
+#include "ecs_core/journal.h"
+
+typedef struct {
+    const char *snapshot_path;
+    const char *journal_path;
+    const char *replay_journal_path;
+    uint32_t team_a_size;
+    uint32_t team_b_size;
+    uint64_t seed;
+    uint32_t threads;
+    uint32_t max_turns;
+    uint32_t perturb_turn;
+    TargetingMode targeting_mode;
+    ScheduleMode schedule_mode;
+    bool hashes_only;
+    bool check;
+    bool perturb;
+} ReplayConfig;
+
+static int parse_args(int argc, char **argv, ReplayConfig *config) {
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--snapshot") == 0 && i + 1 < argc) {
+            config->snapshot_path = argv[++i];
+        } else if (strcmp(argv[i], "--journal") == 0 && i + 1 < argc) {
+            config->journal_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay-journal") == 0 && i + 1 < argc) {
+            config->replay_journal_path = argv[++i];
+        } else if (strcmp(argv[i], "--army") == 0 && i + 2 < argc) {
+            config->team_a_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+            config->team_b_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config->threads = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--max-turns") == 0 && i + 1 < argc) {
+            config->max_turns = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--perturb") == 0 && i + 1 < argc) {
+            config->perturb_turn = (uint32_t)strtoul(argv[++i], NULL, 10);
+            config->perturb = true;
+        } else if (strcmp(argv[i], "--nearest") == 0) {
+            config->targeting_mode = TARGETING_NEAREST;
+        } else if (strcmp(argv[i], "--cooldown") == 0) {
+            config->schedule_mode = SCHEDULE_COOLDOWN;
+        } else if (strcmp(argv[i], "--hashes-only") == 0) {
+            config->hashes_only = true;
+        } else if (strcmp(argv[i], "--check") == 0) {
+            config->check = true;
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    if (!config->snapshot_path || !config->journal_path) {
+        fprintf(stderr, "--snapshot and --journal are required\n");
+        return -1;
+    }
+    return 0;
+}
+
+static uint64_t event_hash(const JournalEvent *event) {
+    return ((uint64_t)event->object << 32) | (uint32_t)event->value;
+}
+
+static void print_event(const char *label, const JournalEvent *event) {
+    if (!event) {
+        printf("  %s: (no event)\n", label);
+    } else if (event->type == COMBAT_EVENT_STATE_HASH) {
+        printf("  %s: %s %016llx, %u alive\n", label, combat_event_name(event->type),
+               (unsigned long long)event_hash(event), event->subject);
+    } else {
+        printf("  %s: %s subject %u object %d value %d\n", label, combat_event_name(event->type),
+               event->subject, (int)event->object, event->value);
+    }
+}
+
+static int record(const ReplayConfig *config) {
+    World *world = world_create((size_t)config->team_a_size + config->team_b_size);
+    world->targeting_mode = config->targeting_mode;
+    world->schedule_mode = config->schedule_mode;
+    world->worker_threads = config->threads;
+    world_seed(world, config->seed);
+    spawn_army(world, 0, config->team_a_size);
+    spawn_army(world, 1, config->team_b_size);
+
+    if (world_snapshot_save(world, config->snapshot_path) != 0) {
+        fprintf(stderr, "cannot write snapshot %s\n", config->snapshot_path);
+        world_destroy(world);
+        return 1;
+    }
+
+    Journal *journal = journal_open(config->journal_path, 1);
+    if (!journal) {
+        fprintf(stderr, "cannot open journal %s\n", config->journal_path);
+        world_destroy(world);
+        return 1;
+    }
+    world->journal = journal_ring(journal, 0);
+    world->journal_state_only = config->hashes_only;
+    world_enable_state_hash(world);
+
+    const BattleResult result = battle_run(world, config->max_turns);
+    const uint64_t hash = world_state_hash(world);
+    world->journal = NULL;
+    const int rc = journal_close(journal);
+
+    printf("recorded %u turns, winner %d, final state %016llx\n",
+           result.turns, result.winner, (unsigned long long)hash);
+    world_destroy(world);
+    return rc == 0 ? 0 : 1;
+}
+
+// Next state hash in the recording, skipping combat events; 0 at the end
+static int next_recorded_hash(JournalReader *reader, JournalEvent *out) {
+    int rc;
+    while ((rc = journal_reader_next(reader, out)) == 1) {
+        if (out->type == COMBAT_EVENT_STATE_HASH) return 1;
+    }
+    return rc;
+}
+
+// Both journals from the divergent turn on: print the first combat event
+// that differs. State hashes are skipped, the divergence is already known.
+static void report_first_event(const char *recorded_path, const char *replay_path, uint32_t turn) {
+    JournalReader *a = journal_reader_open(recorded_path);
+    JournalReader *b = journal_reader_open(replay_path);
+    if (!a || !b || journal_reader_seek_turn(a, turn) != 0 || journal_reader_seek_turn(b, turn) != 0) {
+        printf("  (cannot read the journals back to compare events)\n");
+        journal_reader_close(a);
+        journal_reader_close(b);
+        return;
+    }
+
+    JournalEvent ea, eb;
+    bool recorded_events = false;   // the recording has combat events, not just hashes
+    uint32_t last_turn = turn;
+    uint64_t n = 0;                 // events so far in last_turn
+    for (;;) {
+        const int ra = journal_reader_next(a, &ea) == 1;
+        const int rb = journal_reader_next(b, &eb) == 1;
+        if (!ra && !rb) {
+            printf("  no combat event differs in turns %u to %u; the state changed outside what the journal "
+                   "records\n", turn, last_turn);
+            break;
+        }
+        const JournalEvent *latest = rb ? &eb : &ea;
+        if (latest->turn != last_turn) n = 0;
+        last_turn = latest->turn;
+        n++;
+        if (ra && ea.type != COMBAT_EVENT_STATE_HASH) recorded_events = true;
+
+        if (ra && rb && ea.type == eb.type && ea.subject == eb.subject &&
+            ea.object == eb.object && ea.value == eb.value) {
+            continue;
+        }
+        if (ra && rb && ea.type == COMBAT_EVENT_STATE_HASH && eb.type == COMBAT_EVENT_STATE_HASH) continue;
+        if (ra && ea.type == COMBAT_EVENT_STATE_HASH && !recorded_events) {
+            printf("  (the recording has no combat events; record without --hashes-only to name the entity)\n");
+            break;
+        }
+
+        printf("  first differing event: #%llu of turn %u\n", (unsigned long long)(n - 1), last_turn);
+        print_event("recorded", ra ? &ea : NULL);
+        print_event("replayed", rb ? &eb : NULL);
+        const bool recorded_combat = ra && ea.type != COMBAT_EVENT_STATE_HASH;
+        printf("  divergent entity: %u\n", recorded_combat ? ea.subject : eb.subject);
+        break;
+    }
+    journal_reader_close(a);
+    journal_reader_close(b);
+}
+
+static int verify(const ReplayConfig *config) {
+    const uint32_t capacity = world_snapshot_capacity(config->snapshot_path);
+    if (capacity == 0) {
+        fprintf(stderr, "cannot read snapshot %s\n", config->snapshot_path);
+        return 1;
+    }
+
+    World *world = world_create(capacity);
+    world_enable_state_hash(world);
+    if (world_snapshot_load(world, config->snapshot_path) != 0) {
+        fprintf(stderr, "cannot load snapshot %s\n", config->snapshot_path);
+        world_destroy(world);
+        return 1;
+    }
+
+    JournalReader *recorded = journal_reader_open(config->journal_path);
+    if (!recorded) {
+        fprintf(stderr, "cannot read journal %s\n", config->journal_path);
+        world_destroy(world);
+        return 1;
+    }
+
+    Journal *replay_journal = NULL;
+    if (config->replay_journal_path) {
+        if (!(replay_journal = journal_open(config->replay_journal_path, 1))) {
+            fprintf(stderr, "cannot open journal %s\n", config->replay_journal_path);
+            journal_reader_close(recorded);
+            world_destroy(world);
+            return 1;
+        }
+        world->journal = journal_ring(replay_journal, 0);
+    }
+
+    bool diverged = false;
+    uint32_t divergent_turn = 0;
+    JournalEvent expected;
+    int status = 0;
+
+    world->battle_active = true;
+    while (world->battle_active && world->turn_number < config->max_turns) {
+        const uint32_t turn = world->turn_number;
+
+        const bool perturbed = config->perturb && turn == config->perturb_turn &&
+                               world->combatant_storage->dense_count > 0;
+        if (perturbed) {
+            // Each team's healthiest unit outside its first WEAKEST_CACHE_SIZE,
+            // which weakest targeting focuses (and overkills) this turn. The
+            // losing side's one dies eventually, and its death names it.
+            const SparseSet *combatants = world->combatant_storage;
+            CombatantBundle *bundles = combatants->dense_data;
+            for (uint32_t t = 0; t < world->team_count; t++) {
+                uint32_t count;
+                const uint32_t *members = field_index_bucket(world->team_index, t, &count);
+                uint32_t victim = UINT32_MAX;
+                for (uint32_t i = count > WEAKEST_CACHE_SIZE ? WEAKEST_CACHE_SIZE : 0; i < count; i++) {
+                    const uint32_t idx = combatants->sparse[members[i]];
+                    if (victim == UINT32_MAX || bundles[idx].health > bundles[victim].health) victim = idx;
+                }
+                if (victim == UINT32_MAX) continue;
+                bundles[victim].health += 1;
+                state_hash_mark(world->state_hash, victim);
+                printf("perturbed entity %u at turn %u\n", combatants->dense_entities[victim], turn);
+            }
+        }
+
+        battle_run_turn(world);
+        const uint64_t actual = world->state_hash->value;
+
+        if (config->check && state_hash_full(world->combatant_storage, world->state_hash->fn) != actual) {
+            printf("turn %u: incremental hash differs from a full rehash (a system wrote without marking)\n", turn);
+            status = 1;
+            break;
+        }
+
+        const int rc = next_recorded_hash(recorded, &expected);
+        if (rc < 0) {
+            fprintf(stderr, "corrupt journal %s\n", config->journal_path);
+            status = 1;
+            break;
+        }
+        if (perturbed && rc == 1 && expected.turn == turn && event_hash(&expected) == actual) {
+            printf("perturbation had no observable effect\n");
+        }
+        if (rc == 0 || expected.turn != turn || event_hash(&expected) != actual) {
+            diverged = true;
+            divergent_turn = turn;
+            printf("DIVERGED at turn %u\n", turn);
+            print_event("recorded", rc == 1 ? &expected : NULL);
+            printf("  replayed: state_hash %016llx, %u alive\n",
+                   (unsigned long long)actual, world->combatant_storage->dense_count);
+            break;
+        }
+
+        if (combat_system_check_victory(world)) world->battle_active = false;
+    }
+
+    // Play on to the end, journaling, so a later combat event can name the entity
+    if (status == 0 && diverged && replay_journal && !combat_system_check_victory(world)) {
+        while (world->turn_number < config->max_turns) {
+            battle_run_turn(world);
+            if (combat_system_check_victory(world)) break;
+        }
+    }
+
+    // The recording may have kept going after the replay stopped
+    if (status == 0 && !diverged) {
+        const int rc = next_recorded_hash(recorded, &expected);
+        if (rc == 1) {
+            diverged = true;
+            divergent_turn = expected.turn;
+            printf("DIVERGED: the replay ended after %u turns, the recording continues at turn %u\n",
+                   world->turn_number, expected.turn);
+        }
+    }
+    journal_reader_close(recorded);
+
+    world->journal = NULL;
+    if (replay_journal && journal_close(replay_journal) != 0) status = 1;
+
+    if (diverged) {
+        if (config->replay_journal_path) {
+            report_first_event(config->journal_path, config->replay_journal_path, divergent_turn);
+        } else {
+            printf("  (pass --replay-journal FILE to find the divergent entity)\n");
+        }
+        status = 3;
+    } else if (status == 0) {
+        printf("replay matched %u turns, final state %016llx\n",
+               world->turn_number, (unsigned long long)world->state_hash->value);
+    }
+
+    world_destroy(world);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    ReplayConfig config = {
+        .team_a_size = 10000,
+        .team_b_size = 10000,
+        .seed = 1,
+        .threads = 1,
+        .max_turns = BATTLE_MAX_TURNS,
+        .targeting_mode = TARGETING_WEAKEST,
+        .schedule_mode = SCHEDULE_EVERY_TURN,
+    };
+
+    if (argc < 2 || (strcmp(argv[1], "record") != 0 && strcmp(argv[1], "verify") != 0)) {
+        fprintf(stderr, "usage: battle_replay record|verify --snapshot FILE --journal FILE [options]\n");
+        return 2;
+    }
+    if (parse_args(argc, argv, &config) != 0) {
+        return 2;
+    }
+    return strcmp(argv[1], "record") == 0 ? record(&config) : verify(&config);
+}
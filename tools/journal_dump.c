@@ -0,0 +1,108 @@
+//
+// Created by jo on 10/19/2026.
+//
+// Streams a battle journal (ecs_core/journal.h) back as text, one event per
+// line: turn, event, subject, object, value. --from-turn seeks through the
+// index blocks instead of decoding the journal from the start.
+//
+// Usage: journal_dump FILE [--from-turn N] [--to-turn N] [--summary]
+//
+// --summary prints per-type event counts and the encoded size per event
+// instead of the events themselves.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "combat_system.h"
+#include "ecs_core/journal.h"
+
+#define DUMP_MAX_TYPES 16
+
+int main(int argc, char **argv) {
+    const char *path = NULL;
+    uint32_t from_turn = 0;
+    uint32_t to_turn = UINT32_MAX;
+    int summary = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--from-turn") == 0 && i + 1 < argc) {
+            from_turn = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--to-turn") == 0 && i + 1 < argc) {
+            to_turn = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--summary") == 0) {
+            summary = 1;
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: journal_dump FILE [--from-turn N] [--to-turn N] [--summary]\n");
+        return 2;
+    }
+
+    JournalReader *reader = journal_reader_open(path);
+    if (!reader) {
+        fprintf(stderr, "cannot read journal %s\n", path);
+        return 1;
+    }
+    if (from_turn > 0 && journal_reader_seek_turn(reader, from_turn) != 0) {
+        fprintf(stderr, "corrupt index in %s\n", path);
+        journal_reader_close(reader);
+        return 1;
+    }
+
+    uint64_t counts[DUMP_MAX_TYPES] = {0};
+    uint64_t total = 0;
+    uint32_t first_turn = UINT32_MAX, last_turn = 0;
+
+    JournalEvent event;
+    int rc;
+    while ((rc = journal_reader_next(reader, &event)) == 1) {
+        // Rings are drained block by block, so a later block can still hold earlier turns
+        if (event.turn > to_turn) continue;
+
+        total++;
+        counts[event.type < DUMP_MAX_TYPES ? event.type : 0]++;
+        if (event.turn < first_turn) first_turn = event.turn;
+        if (event.turn > last_turn) last_turn = event.turn;
+
+        if (!summary) {
+            if (event.object == UINT32_MAX) {
+                printf("%u %s %u - %d\n", event.turn, combat_event_name(event.type), event.subject, event.value);
+            } else {
+                printf("%u %s %u %u %d\n", event.turn, combat_event_name(event.type),
+                       event.subject, event.object, event.value);
+            }
+        }
+    }
+    journal_reader_close(reader);
+
+    if (rc < 0) {
+        fprintf(stderr, "corrupt block in %s after %llu events\n", path, (unsigned long long)total);
+        return 1;
+    }
+
+    if (summary) {
+        FILE *f = fopen(path, "rb");
+        long size = 0;
+        if (f && fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+        if (f) fclose(f);
+
+        printf("events: %llu", (unsigned long long)total);
+        if (total > 0) printf(" (turns %u-%u)", first_turn, last_turn);
+        printf("\n");
+        for (uint32_t t = 0; t < DUMP_MAX_TYPES; t++) {
+            if (counts[t]) printf("  %-8s %llu\n", combat_event_name(t), (unsigned long long)counts[t]);
+        }
+        if (total > 0) {
+            printf("file bytes: %ld (%.2f per event)\n", size, (double)size / (double)total);
+        }
+    }
+    return 0;
+}
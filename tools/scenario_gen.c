@@ -0,0 +1,90 @@
+//
+// Created by jo on 10/19/2026.
+//
+// Writes a random scenario file (see scenario.h): a table of unit types with
+// stats in spawn_army's ranges, then both armies deployed the way spawn_army
+// deploys them, on the battlefield world_create sizes for the total.
+//
+// Usage: scenario_gen FILE [--army A B] [--types K] [--seed S]
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "world.h"
+#include "scenario.h"
+#include "ecs_core/rng.h"
+
+int main(int argc, char **argv) {
+    uint32_t team_size[2] = {100000, 100000};
+    uint32_t types = 16;
+    uint64_t seed = 1;
+
+    if (argc < 2 || argv[1][0] == '-') {
+        fprintf(stderr, "usage: scenario_gen FILE [--army A B] [--types K] [--seed S]\n");
+        return 2;
+    }
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--army") == 0 && i + 2 < argc) {
+            team_size[0] = (uint32_t)strtoul(argv[++i], NULL, 10);
+            team_size[1] = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--types") == 0 && i + 1 < argc) {
+            types = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+    if (types == 0 || types > SCENARIO_MAX_TYPES) {
+        fprintf(stderr, "--types must be 1..%d\n", SCENARIO_MAX_TYPES);
+        return 2;
+    }
+
+    FILE *out = fopen(argv[1], "w");
+    if (!out) {
+        fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+    static char buffer[1 << 20];
+    setvbuf(out, buffer, _IOFBF, sizeof(buffer));
+
+    Rng rng;
+    rng_seed(&rng, seed);
+
+    fprintf(out, "%s %d\n# generated by scenario_gen, seed %llu\n", SCENARIO_MAGIC, SCENARIO_VERSION,
+            (unsigned long long)seed);
+    fprintf(out, "types %u\n", types);
+    for (uint32_t t = 0; t < types; t++) {
+        fprintf(out, "type%u %u %u %u %.2f\n", t, 100 + rng_range(&rng, 21), 15 + rng_range(&rng, 11),
+                5 + rng_range(&rng, 6), 1.0f + rng_range(&rng, 100) / 100.0f);
+    }
+
+    // Same battlefield and deployment zones as world_create and spawn_army
+    const uint32_t total = team_size[0] + team_size[1];
+    float width = sqrtf((float)total) * UNIT_SPACING;
+    if (width < SPATIAL_CELL_SIZE) width = SPATIAL_CELL_SIZE;
+    const float deploy_width = width * 0.4f;
+
+    fprintf(out, "units %u\n", total);
+    for (uint32_t team = 0; team < 2; team++) {
+        const float deploy_x = team == 0 ? 0.0f : width - deploy_width;
+        for (uint32_t i = 0; i < team_size[team]; i++) {
+            const uint32_t type = rng_range(&rng, types);
+            const float x = deploy_x + rng_unit_float(rng_next_u32(&rng)) * deploy_width;
+            const float y = rng_unit_float(rng_next_u32(&rng)) * width;
+            fprintf(out, "%u %u %.2f %.2f\n", team, type, x, y);
+        }
+    }
+
+    if (fclose(out) != 0) {
+        fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+    printf("wrote %u units of %u types to %s\n", total, types, argv[1]);
+    return 0;
+}
@@ -0,0 +1,299 @@
+//
+// Created by jo on 10/19/2026.
+//
+// Load generator for the battle server (sparse_storage_learning --serve
+// --socket PATH, see sim_server.h). Opens C connections and sends N requests
+// split across them, keeping up to D unanswered requests in flight on each
+// (D = 1 is strict request/response, larger D pipelines). Request i uses
+// seed S + i. Reports throughput, client-side latency percentiles (request
+// written to response read) and the server's mean queue and battle times.
+//
+// Usage:
+//   server_load --socket PATH [--requests N] [--connections C] [--depth D]
+//               [--army A B] [--seed S] [--nearest] [--cooldown]
+//
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define LOAD_MAX_CONNECTIONS 256
+
+typedef struct {
+    const char *socket_path;
+    uint32_t requests;
+    uint32_t connections;
+    uint32_t depth;
+    uint32_t team_a_size;
+    uint32_t team_b_size;
+    uint64_t seed;
+    bool nearest;
+    bool cooldown;
+} LoadConfig;
+
+// Per-request timings shared by all connections; each owns every C-th request
+typedef struct {
+    const LoadConfig *config;
+    uint64_t *sent_ns;
+    uint64_t *latency_ns;
+} LoadRun;
+
+typedef struct {
+    LoadRun *run;
+    uint32_t first;        // this connection sends requests first, first + C, ...
+    uint32_t count;
+    uint32_t answered;
+    uint32_t errors;
+    uint64_t queue_us;     // server-reported, summed over successful responses
+    uint64_t battle_us;
+    bool failed;           // couldn't connect, or the server hung up early
+} LoadConnection;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int parse_args(int argc, char **argv, LoadConfig *config) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            config->socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--requests") == 0 && i + 1 < argc) {
+            config->requests = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--connections") == 0 && i + 1 < argc) {
+            config->connections = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--depth") == 0 && i + 1 < argc) {
+            config->depth = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--army") == 0 && i + 2 < argc) {
+            config->team_a_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+            config->team_b_size = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--nearest") == 0) {
+            config->nearest = true;
+        } else if (strcmp(argv[i], "--cooldown") == 0) {
+            config->cooldown = true;
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    if (!config->socket_path) {
+        fprintf(stderr, "--socket is required\n");
+        return -1;
+    }
+    if (config->requests == 0 || config->depth == 0 ||
+        config->connections == 0 || config->connections > LOAD_MAX_CONNECTIONS) {
+        fprintf(stderr, "--requests and --depth must be positive, --connections 1..%d\n", LOAD_MAX_CONNECTIONS);
+        return -1;
+    }
+    if (config->connections > config->requests) config->connections = config->requests;
+    return 0;
+}
+
+static int connect_to(const char *path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) return -1;
+    strcpy(addr.sun_path, path);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        const ssize_t written = write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return 0;
+}
+
+// Value of a numeric field in a response line, 0 if absent
+static uint64_t field_u64(const char *line, const char *key) {
+    const char *at = strstr(line, key);
+    return at ? strtoull(at + strlen(key), NULL, 10) : 0;
+}
+
+// Match one response to its request through the "r<index>" id
+static void handle_response(LoadConnection *lc, const char *line, uint64_t now) {
+    const char *id = strstr(line, "\"id\": \"r");
+    const uint32_t total = lc->run->config->requests;
+    uint32_t index = id ? (uint32_t)strtoul(id + 8, NULL, 10) : UINT32_MAX;
+    if (index >= total) {
+        lc->errors++;
+        return;
+    }
+
+    lc->run->latency_ns[index] = now - lc->run->sent_ns[index];
+    lc->answered++;
+    if (strstr(line, "\"ok\": true")) {
+        lc->queue_us += field_u64(line, "\"queue_us\": ");
+        lc->battle_us += field_u64(line, "\"battle_us\": ");
+    } else {
+        lc->errors++;
+    }
+}
+
+static void* connection_main(void *arg) {
+    LoadConnection *lc = arg;
+    const LoadConfig *config = lc->run->config;
+    const int fd = connect_to(config->socket_path);
+    if (fd < 0) {
+        lc->failed = true;
+        return NULL;
+    }
+
+    char in[64 * 1024];
+    size_t used = 0;
+    uint32_t sent = 0;
+
+    while (lc->answered < lc->count) {
+        // Top the pipeline back up to depth
+        char out[16 * 1024];
+        size_t out_len = 0;
+        while (sent < lc->count && sent - lc->answered < config->depth && out_len + 128 < sizeof(out)) {
+            const uint32_t index = lc->first + sent * config->connections;
+            out_len += (size_t)snprintf(out + out_len, sizeof(out) - out_len, "r%u %u %u %llu%s%s\n",
+                                        index, config->team_a_size, config->team_b_size,
+                                        (unsigned long long)(config->seed + index),
+                                        config->nearest ? " nearest" : "", config->cooldown ? " cooldown" : "");
+            lc->run->sent_ns[index] = now_ns();
+            sent++;
+        }
+        if (out_len > 0 && write_all(fd, out, out_len) != 0) {
+            lc->failed = true;
+            break;
+        }
+
+        // Block for at least one response
+        const ssize_t got = read(fd, in + used, sizeof(in) - used - 1);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) {
+            lc->failed = true;
+            break;
+        }
+        const uint64_t now = now_ns();
+        used += (size_t)got;
+
+        size_t begin = 0;
+        for (char *newline; (newline = memchr(in + begin, '\n', used - begin)) != NULL;) {
+            *newline = '\0';
+            handle_response(lc, in + begin, now);
+            begin = (size_t)(newline - in) + 1;
+        }
+        memmove(in, in + begin, used - begin);
+        used -= begin;
+    }
+
+    close(fd);
+    return NULL;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    const uint64_t x = *(const uint64_t*)a;
+    const uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile over a sorted array
+static uint64_t percentile(const uint64_t *sorted, uint32_t n, double p) {
+    uint32_t rank = (uint32_t)(p * n + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+int main(int argc, char **argv) {
+    LoadConfig config = {
+        .socket_path = NULL,
+        .requests = 1000,
+        .connections = 4,
+        .depth = 16,
+        .team_a_size = 1000,
+        .team_b_size = 1000,
+        .seed = 1,
+        .nearest = false,
+        .cooldown = false,
+    };
+    if (parse_args(argc, argv, &config) != 0) {
+        return 2;
+    }
+
+    LoadRun run = {&config, calloc(config.requests, sizeof(uint64_t)), calloc(config.requests, sizeof(uint64_t))};
+    LoadConnection *connections = calloc(config.connections, sizeof(LoadConnection));
+    pthread_t threads[LOAD_MAX_CONNECTIONS];
+    if (!run.sent_ns || !run.latency_ns || !connections) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    const uint64_t start = now_ns();
+    uint32_t started = 0;
+    for (uint32_t c = 0; c < config.connections; c++) {
+        connections[c].run = &run;
+        connections[c].first = c;
+        connections[c].count = (config.requests - c + config.connections - 1) / config.connections;
+        if (pthread_create(&threads[c], NULL, connection_main, &connections[c]) != 0) break;
+        started++;
+    }
+    for (uint32_t c = 0; c < started; c++) pthread_join(threads[c], NULL);
+    const double seconds = (now_ns() - start) / 1e9;
+
+    uint32_t answered = 0, errors = 0, failed = config.connections - started;
+    uint64_t queue_us = 0, battle_us = 0;
+    for (uint32_t c = 0; c < started; c++) {
+        answered += connections[c].answered;
+        errors += connections[c].errors;
+        queue_us += connections[c].queue_us;
+        battle_us += connections[c].battle_us;
+        if (connections[c].failed) failed++;
+    }
+
+    // Latencies of answered requests only
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < config.requests; i++) {
+        if (run.latency_ns[i]) run.latency_ns[n++] = run.latency_ns[i];
+    }
+    qsort(run.latency_ns, n, sizeof(uint64_t), compare_u64);
+
+    const uint32_t ok = answered - errors;
+    printf("requests: %u answered, %u errors, %u connections failed (%u connections, depth %u, %u vs %u%s%s)\n",
+           answered, errors, failed, config.connections, config.depth, config.team_a_size, config.team_b_size,
+           config.nearest ? ", nearest" : "", config.cooldown ? ", cooldown" : "");
+    printf("throughput: %.1f requests/s over %.3f s\n", seconds > 0 ? answered / seconds : 0.0, seconds);
+    if (n > 0) {
+        printf("latency_us: p50 %.0f  p90 %.0f  p99 %.0f  max %.0f\n",
+               percentile(run.latency_ns, n, 0.5) / 1e3, percentile(run.latency_ns, n, 0.9) / 1e3,
+               percentile(run.latency_ns, n, 0.99) / 1e3, run.latency_ns[n - 1] / 1e3);
+    }
+    if (ok > 0) {
+        printf("server: mean queue %.0f us, mean battle %.0f us\n", (double)queue_us / ok, (double)battle_us / ok);
+    }
+
+    free(run.sent_ns);
+    free(run.latency_ns);
+    free(connections);
+    return (failed == 0 && errors == 0 && answered == config.requests) ? 0 : 1;
+}
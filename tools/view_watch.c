@@ -0,0 +1,139 @@
+//
+// Created by jo on 10/19/2026.
+//
+// Out-of-process observer for a world's shared view (world_share_view, e.g.
+// ecs_bench --shared-view NAME). Maps the view read-only and, for each newly
+// published turn, summarizes the combatants in place: units and total health
+// per team (one pair for each team seen so far), and how many attackers'
+// targets died since they were picked, according to the published
+// generations. Nothing is copied and the writer is never blocked; a summary
+// the writer overwrote mid-read is detected, thrown away and retried, and
+// counted as torn.
+//
+// Usage: view_watch NAME [--frames N] [--poll-us U] [--slow-ns S]
+//
+// --slow-ns spends S ns per unit while summarizing, to see torn reads when a
+// reader can't keep up with the writer.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "components.h"
+#include "world.h"
+#include "ecs_core/shared_view.h"
+
+typedef struct {
+    uint32_t alive[MAX_TEAMS];
+    int64_t health[MAX_TEAMS];
+    uint32_t teams;          // bit t set when team t has units in the frame
+    uint32_t stale_targets;  // attackers whose target's generation has moved on
+} Summary;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void summarize(const SharedViewFrame *frame, uint64_t slow_ns, Summary *summary) {
+    memset(summary, 0, sizeof(*summary));
+    const CombatantBundle *bundles = frame->components;
+    for (uint32_t i = 0; i < frame->dense_count; i++) {
+        const CombatantBundle *b = &bundles[i];
+        if (b->team_id < MAX_TEAMS) {
+            summary->alive[b->team_id]++;
+            summary->health[b->team_id] += b->health;
+            summary->teams |= 1u << b->team_id;
+        }
+
+        const Entity target = b->target.entity;
+        if (b->is_attacking && target.id < frame->generation_count &&
+            frame->generations[target.id] != target.generation) {
+            summary->stale_targets++;
+        }
+        if (slow_ns) {
+            const uint64_t until = now_ns() + slow_ns;
+            while (now_ns() < until) {}
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t frames = 20;
+    uint64_t poll_us = 200;
+    uint64_t slow_ns = 0;
+
+    if (argc < 2 || argv[1][0] == '-') {
+        fprintf(stderr, "usage: view_watch NAME [--frames N] [--poll-us U] [--slow-ns S]\n");
+        return 2;
+    }
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            frames = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--poll-us") == 0 && i + 1 < argc) {
+            poll_us = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--slow-ns") == 0 && i + 1 < argc) {
+            slow_ns = strtoull(argv[++i], NULL, 10);
+        } else {
+            fprintf(stderr, "unknown or incomplete option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    // The writer may not have started yet
+    SharedViewReader reader;
+    for (int attempt = 0; shared_view_open(&reader, argv[1], sizeof(CombatantBundle)) != 0; attempt++) {
+        if (attempt == 100) {
+            fprintf(stderr, "no compatible view named %s\n", argv[1]);
+            return 1;
+        }
+        usleep(50000);
+    }
+    printf("attached to %s: capacity %u, writer pid %u\n", argv[1], reader.header->capacity,
+           reader.header->writer_pid);
+    printf("%8s %13s %8s %9s  %s\n", "turn", "stale_targets", "torn", "read_us", "team:alive/health ...");
+
+    uint64_t last_tick = UINT64_MAX;
+    uint32_t shown = 0, torn = 0, idle_polls = 0;
+    uint32_t teams_seen = 0;  // teams keep their column once wiped out
+    while (shown < frames) {
+        SharedViewFrame frame;
+        if (!shared_view_acquire(&reader, &frame) || frame.tick == last_tick) {
+            // Nothing new; give up once the writer has been quiet for about a second
+            if (++idle_polls * poll_us > 1000000 && shown > 0) break;
+            usleep((useconds_t)poll_us);
+            continue;
+        }
+        idle_polls = 0;
+
+        const uint64_t start = now_ns();
+        Summary summary;
+        summarize(&frame, slow_ns, &summary);
+        if (!shared_view_frame_valid(&frame)) {
+            torn++;
+            continue;
+        }
+
+        teams_seen |= summary.teams;
+        printf("%8llu %13u %8u %9.1f ", (unsigned long long)frame.tick, summary.stale_targets, torn,
+               (now_ns() - start) / 1e3);
+        for (uint32_t t = 0; t < MAX_TEAMS; t++) {
+            if (teams_seen & (1u << t)) {
+                printf(" %c:%u/%lld", 'A' + t, summary.alive[t], (long long)summary.health[t]);
+            }
+        }
+        printf("\n");
+        last_tick = frame.tick;
+        shown++;
+    }
+
+    printf("%u turns read, %u torn reads retried, %llu publishes so far\n", shown, torn,
+           (unsigned long long)__atomic_load_n(&reader.header->publish_count, __ATOMIC_ACQUIRE));
+    shared_view_close(&reader);
+    return 0;
+}
@@ -3,19 +3,91 @@
 //
 
 #include "world.h"
+#include "world_snapshot.h"
+#include "ecs_core/profiler.h"
 #include <stdio.h>
+#include <limits.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
 
-World* world_create(size_t max_entities) {
-    // Create arenas - Increase size for better performance
-    Arena *persistent = arena_create(32 * 1024 * 1024); // 32MB
-    Arena *battle = arena_create(32 * 1024 * 1024); // 32MB
+void world_init_turn_buffers(World *world, uint32_t capacity) {
+    world->ready_entities = arena_alloc(world->battle_arena, sizeof(uint32_t) * capacity);
+    world->ready_count = 0;
+    world->damage_accumulator = arena_alloc_aligned(world->battle_arena, sizeof(int32_t) * capacity, 64);
+    memset(world->damage_accumulator, 0, sizeof(int32_t) * capacity);
+    world->damaged_indices = arena_alloc(world->battle_arena, sizeof(uint32_t) * capacity);
+}
+
+// Per-battle scheduling state lives in the battle arena alongside the storages
+static void world_init_schedule(World *world, uint32_t capacity) {
+    timing_wheel_init(world->action_wheel, capacity, world->battle_arena);
+    world_init_turn_buffers(world, capacity);
+}
+
+// Labels for memory reports; sparse_set_init clears them
+static void world_name_storages(World *world) {
+    world->combatant_storage->name = "set.combatants";
+    world->team_index->members.name = "index.team";
+}
+
+// Declared again whenever the combatant storage is re-initialized
+static void world_index_teams(World *world) {
+    field_index_init(world->team_index, world->combatant_storage,
+            FIELD_INDEX_KEY(CombatantBundle, team_id), MAX_TEAMS, world->battle_arena);
+}
+
+// Per-team battle state and the targeting caches, as a new battle starts them
+static void world_clear_teams(World *world) {
+    memset(world->team_spawned, 0, sizeof(world->team_spawned));
+    world->needs_target_update = true;
+    world->resolved_target_version = 0;
+
+    for (uint32_t t = 0; t < MAX_TEAMS; t++) {
+        WeakestCache *cache = &world->enemy_cache[t];
+        cache->count = 0;
+        for (int i = 0; i < WEAKEST_CACHE_SIZE; i++) {
+            cache->targets[i] = (Entity){UINT32_MAX, 0};
+            cache->healths[i] = INT_MAX;
+        }
+    }
+}
+
+// Battle arena bytes for a capacity: every per-entity array world_reset_battle
+// allocates, plus the largest per-turn scratch and slack for alignment
+static size_t world_battle_arena_size(size_t capacity) {
+    size_t per_entity = 0;
+    per_entity += 2 * sizeof(uint32_t) + sizeof(CombatantBundle);        // combatant set
+    per_entity += 2 * sizeof(uint32_t);                                  // team index
+    per_entity += sizeof(SpatialGridNode) + sizeof(uint32_t) + 6;        // spatial grid (+ group, cells)
+    per_entity += 4 * sizeof(uint32_t);                                  // timing wheel
+    per_entity += 3 * sizeof(uint32_t);                                  // ready list, damage accumulator, damaged list
+    per_entity += sizeof(Entity) + sizeof(uint32_t) + sizeof(uint8_t);   // largest per-turn scratch
+    return per_entity * capacity + 1024 * 1024;
+}
+
+void world_size_battlefield(World *world, size_t units) {
+    const size_t capacity = world->entity_manager->capacity;
+    if (units > capacity) units = capacity;
+
+    // Square battlefield with room for every entity at UNIT_SPACING
+    world->battlefield_width = sqrtf((float)units) * UNIT_SPACING;
+    if (world->battlefield_width < SPATIAL_CELL_SIZE) world->battlefield_width = SPATIAL_CELL_SIZE;
+    world->battlefield_height = world->battlefield_width;
+}
+
+// The persistent arena only holds the World and manager structs
+#define WORLD_PERSISTENT_ARENA_SIZE (1024 * 1024)
+
+static World* world_create_with(Arena *battle, size_t max_entities) {
+    Arena *persistent = arena_create(WORLD_PERSISTENT_ARENA_SIZE);
 
     // Allocate the world struct itself from the persistent arena
     World *world = arena_alloc(persistent, sizeof(World));
     world->persistent_arena = persistent;
     world->battle_arena = battle;
-    world->weakest_team_a_health = INT_MAX;
-    world->weakest_team_b_health = INT_MAX;
+    world->snapshot_base = NULL;
+    world->snapshot_size = 0;
 
     // Initialize core ECS managers, allocating them in the persistent arena
     world->entity_manager = arena_alloc(persistent, sizeof(EntityManager));
@@ -31,42 +103,174 @@ World* world_create(size_t max_entities) {
     world->combatant_storage = arena_alloc(persistent, sizeof(SparseSet));
     sparse_set_init(world->combatant_storage, max_entities, sizeof(CombatantBundle), battle);
 
-    world->team_a_storage = arena_alloc(persistent, sizeof(SparseSet));
-    sparse_set_init(world->team_a_storage, max_entities, 0, battle);
-
-    world->team_b_storage = arena_alloc(persistent, sizeof(SparseSet));
-    sparse_set_init(world->team_b_storage, max_entities, 0, battle);
+    world->team_index = arena_alloc(persistent, sizeof(FieldIndex));
+    world_index_teams(world);
 
     // Register all temporary storages with the storage manager
     storage_manager_register(world->storage_manager, world->combatant_storage);
-    storage_manager_register(world->storage_manager, world->team_a_storage);
-    storage_manager_register(world->storage_manager, world->team_b_storage);
+    storage_manager_register(world->storage_manager, &world->team_index->members);
+    world_name_storages(world);
+
+    world->targeting_mode = TARGETING_WEAKEST;
+    world_size_battlefield(world, max_entities);
+
+    world->spatial = arena_alloc(persistent, sizeof(SpatialGrid));
+    spatial_grid_init(world->spatial, max_entities, 0.0f, 0.0f,
+            world->battlefield_width, world->battlefield_height, SPATIAL_CELL_SIZE, battle);
 
+    world->schedule_mode = SCHEDULE_EVERY_TURN;
+    world->action_wheel = arena_alloc(persistent, sizeof(TimingWheel));
+    world_init_schedule(world, max_entities);
+
+    world->team_count = DEFAULT_TEAMS;
     world->battle_active = false;
     world->turn_number = 0;
+    memset(&world->turn_cursor, 0, sizeof(world->turn_cursor));
+    world_seed(world, 0);
+    world->worker_threads = 1;
+    world->journal = NULL;
+    world->journal_state_only = false;
+    world->state_hash = NULL;
+    world->shared_view = NULL;
+    world->shared_view_every = 1;
+    world->parallel_deaths = NULL;
 
-    // Initialize cache
-    world->weakest_team_a = (Entity){UINT32_MAX, 0};
-    world->weakest_team_b = (Entity){UINT32_MAX, 0};
-    world->needs_target_update = true;
+    // Initialize team counts and multi-target caches
+    world_clear_teams(world);
+
+    return world;
+}
+
+World* world_create(size_t max_entities) {
+    PROFILE_FUNCTION();
+    return world_create_with(arena_create(world_battle_arena_size(max_entities)), max_entities);
+}
+
+World* world_create_forkable(size_t max_entities) {
+    PROFILE_FUNCTION();
+    return world_create_with(arena_create_forkable(world_battle_arena_size(max_entities)), max_entities);
+}
+
+// Same offset in the fork's battle arena for pointers into the parent's
+static void* fork_rebase(const Arena *from, const Arena *to, void *ptr) {
+    const uint8_t *p = ptr;
+    if (!p || p < from->buffer || p >= from->buffer + from->size) return ptr;
+    return to->buffer + (p - from->buffer);
+}
 
-    // Initialize multi-target caches
-    world->weakest_cache_a.count = 0;
-    world->weakest_cache_b.count = 0;
-    for (int i = 0; i < WEAKEST_CACHE_SIZE; i++) {
-        world->weakest_cache_a.targets[i] = (Entity){UINT32_MAX, 0};
-        world->weakest_cache_b.targets[i] = (Entity){UINT32_MAX, 0};
-        world->weakest_cache_a.healths[i] = INT_MAX;
-        world->weakest_cache_b.healths[i] = INT_MAX;
+static void fork_sparse_set_into(World *fork, const World *parent, const SparseSet *set, SparseSet *copy) {
+    *copy = *set;
+    copy->sparse = fork_rebase(parent->battle_arena, fork->battle_arena, set->sparse);
+    copy->dense_entities = fork_rebase(parent->battle_arena, fork->battle_arena, set->dense_entities);
+    copy->dense_data = fork_rebase(parent->battle_arena, fork->battle_arena, set->dense_data);
+    copy->arena = fork->battle_arena;
+    copy->indices = NULL;
+    storage_manager_register(fork->storage_manager, copy);
+}
+
+static SparseSet* fork_sparse_set(World *fork, const World *parent, const SparseSet *set) {
+    SparseSet *copy = arena_alloc(fork->persistent_arena, sizeof(SparseSet));
+    fork_sparse_set_into(fork, parent, set, copy);
+    return copy;
+}
+
+// Bucket bounds are copied as they are; the copy is attached to the forked source set
+static FieldIndex* fork_field_index(World *fork, const World *parent, const FieldIndex *index, SparseSet *source) {
+    FieldIndex *copy = arena_alloc(fork->persistent_arena, sizeof(FieldIndex));
+    *copy = *index;
+    fork_sparse_set_into(fork, parent, &index->members, &copy->members);
+    copy->source = source;
+    copy->next = source->indices;
+    source->indices = copy;
+    return copy;
+}
+
+static SpatialGrid* fork_spatial_grid(World *fork, const World *parent, const SpatialGrid *grid) {
+    SpatialGrid *copy = arena_alloc(fork->persistent_arena, sizeof(SpatialGrid));
+    *copy = *grid;
+    copy->cell_head = fork_rebase(parent->battle_arena, fork->battle_arena, grid->cell_head);
+    copy->nodes = fork_rebase(parent->battle_arena, fork->battle_arena, grid->nodes);
+    copy->cell_of = fork_rebase(parent->battle_arena, fork->battle_arena, grid->cell_of);
+    copy->group = fork_rebase(parent->battle_arena, fork->battle_arena, grid->group);
+    copy->cell_groups = fork_rebase(parent->battle_arena, fork->battle_arena, grid->cell_groups);
+    return copy;
+}
+
+World* world_fork(World *parent) {
+    PROFILE_FUNCTION();
+
+    // Storages mapped from a snapshot file aren't in the battle arena
+    if (parent->snapshot_base) return NULL;
+
+    Arena *battle = arena_fork(parent->battle_arena);
+    if (!battle) return NULL;
+    Arena *persistent = arena_create(WORLD_PERSISTENT_ARENA_SIZE);
+    if (!persistent) {
+        arena_destroy(battle);
+        return NULL;
     }
 
-    return world;
+    // Battle state, caches and settings carry over as they are; everything the
+    // battle arena holds is shared copy-on-write and only needs rebasing
+    World *fork = arena_alloc(persistent, sizeof(World));
+    *fork = *parent;
+    fork->persistent_arena = persistent;
+    fork->battle_arena = battle;
+    fork->journal = NULL;
+    fork->shared_view = NULL;
+    fork->parallel_deaths = NULL;
+
+    // The managers own heap arrays, so those are copied
+    fork->entity_manager = arena_alloc(persistent, sizeof(EntityManager));
+    entity_manager_copy(fork->entity_manager, parent->entity_manager);
+
+    fork->death_queue = arena_alloc(persistent, sizeof(DeathQueue));
+    death_queue_init(fork->death_queue, parent->death_queue->capacity);
+    for (size_t i = 0; i < parent->death_queue->count; i++) {
+        death_queue_push(fork->death_queue, parent->death_queue->entities[i]);
+    }
+    fork->death_queue->peak_count = parent->death_queue->peak_count;
+
+    // Registered in the same order as world_create
+    fork->storage_manager = arena_alloc(persistent, sizeof(StorageManager));
+    storage_manager_init(fork->storage_manager, 16);
+    fork->combatant_storage = fork_sparse_set(fork, parent, parent->combatant_storage);
+    fork->team_index = fork_field_index(fork, parent, parent->team_index, fork->combatant_storage);
+
+    fork->spatial = fork_spatial_grid(fork, parent, parent->spatial);
+
+    const TimingWheel *wheel = parent->action_wheel;
+    fork->action_wheel = arena_alloc(persistent, sizeof(TimingWheel));
+    *fork->action_wheel = *wheel;
+    fork->action_wheel->slot_head = fork_rebase(parent->battle_arena, battle, wheel->slot_head);
+    fork->action_wheel->next = fork_rebase(parent->battle_arena, battle, wheel->next);
+    fork->action_wheel->prev = fork_rebase(parent->battle_arena, battle, wheel->prev);
+    fork->action_wheel->slot_of = fork_rebase(parent->battle_arena, battle, wheel->slot_of);
+    fork->action_wheel->due = fork_rebase(parent->battle_arena, battle, wheel->due);
+
+    fork->ready_entities = fork_rebase(parent->battle_arena, battle, parent->ready_entities);
+    fork->damage_accumulator = fork_rebase(parent->battle_arena, battle, parent->damage_accumulator);
+    fork->damaged_indices = fork_rebase(parent->battle_arena, battle, parent->damaged_indices);
+
+    // Chunk hashes are a few bytes per 256 entities; copy them with the dirty bits
+    if (parent->state_hash) {
+        const StateHash *sh = parent->state_hash;
+        fork->state_hash = arena_alloc(persistent, sizeof(StateHash));
+        state_hash_init(fork->state_hash, fork->combatant_storage->capacity, sh->fn, persistent);
+        memcpy(fork->state_hash->chunk_hash, sh->chunk_hash, sizeof(uint64_t) * sh->chunk_capacity);
+        memcpy(fork->state_hash->dirty, sh->dirty, sizeof(uint64_t) * ((sh->chunk_capacity + 63) / 64));
+        fork->state_hash->tracked_count = sh->tracked_count;
+        fork->state_hash->combined = sh->combined;
+        fork->state_hash->value = sh->value;
+    }
+
+    return fork;
 }
 
 void world_reset_battle(World *world) {
+    PROFILE_FUNCTION();
+    world_snapshot_release(world);
     arena_reset(world->battle_arena);
-    world->weakest_team_a_health = INT_MAX;
-    world->weakest_team_b_health = INT_MAX;
 
     // Save the capacity before freeing
     uint32_t entity_capacity = world->entity_manager->capacity;
@@ -74,48 +278,181 @@ void world_reset_battle(World *world) {
     // Re-initialize sparse sets with the battle arena
     sparse_set_init(world->combatant_storage, entity_capacity,
             sizeof(CombatantBundle), world->battle_arena);
-    sparse_set_init(world->team_a_storage, entity_capacity,
-            0, world->battle_arena);
-    sparse_set_init(world->team_b_storage, entity_capacity,
-            0, world->battle_arena);
+    world_index_teams(world);
+    world_name_storages(world);
+
+    // The spatial grid lives in the battle arena too
+    spatial_grid_init(world->spatial, entity_capacity, 0.0f, 0.0f,
+            world->battlefield_width, world->battlefield_height, SPATIAL_CELL_SIZE, world->battle_arena);
+
+    world_init_schedule(world, entity_capacity);
 
     // Reset entity manager
     entity_manager_free(world->entity_manager);
     entity_manager_init(world->entity_manager, entity_capacity);
 
+    if (world->state_hash) state_hash_reset(world->state_hash);
+
     // Clear death queue
     death_queue_clear(world->death_queue);
+    world->death_queue->peak_count = 0;
 
-    world->team_a_count = 0;
-    world->team_b_count = 0;
     world->turn_number = 0;
+    memset(&world->turn_cursor, 0, sizeof(world->turn_cursor));
 
-    // Reset cache
-    world->weakest_team_a = (Entity){UINT32_MAX, 0};
-    world->weakest_team_b = (Entity){UINT32_MAX, 0};
-    world->needs_target_update = true;
+    // Reset team counts and multi-target caches
+    world_clear_teams(world);
+}
+
+void world_seed(World *world, uint64_t seed) {
+    world->seed = seed;
+    rng_seed(&world->rng, seed);
+}
+
+// Simulation state of a run of combatants; the cached target index is derived,
+// so it's left out. Each field word goes through its own odd multiplier (a
+// bijection, so any field change alters the product) and one multiply chains
+// the slots, so rehashing is bound by reading the bundles back.
+static uint64_t combatant_state_hash(const void *components, const uint32_t *entities, uint32_t count) {
+    const CombatantBundle *c = components;
+    uint64_t h = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t x, y;
+        memcpy(&x, &c[i].position.x, sizeof(x));
+        memcpy(&y, &c[i].position.y, sizeof(y));
 
-    // Reset multi-target caches
-    world->weakest_cache_a.count = 0;
-    world->weakest_cache_b.count = 0;
-    for (int i = 0; i < WEAKEST_CACHE_SIZE; i++) {
-        world->weakest_cache_a.targets[i] = (Entity){UINT32_MAX, 0};
-        world->weakest_cache_b.targets[i] = (Entity){UINT32_MAX, 0};
-        world->weakest_cache_a.healths[i] = INT_MAX;
-        world->weakest_cache_b.healths[i] = INT_MAX;
+        const uint64_t id = ((uint64_t)entities[i] << 32) | (uint32_t)c[i].health;
+        const uint64_t target = ((uint64_t)c[i].target.entity.id << 32) | c[i].target.entity.generation;
+        const uint64_t position = ((uint64_t)x << 32) | y;
+        const uint64_t stats = (((uint64_t)(uint32_t)c[i].attack << 32) | (uint32_t)c[i].defense) ^
+                               ((uint64_t)c[i].is_attacking << 63) ^ ((uint64_t)c[i].team_id << 62);
+
+        h ^= id * 0x9e3779b97f4a7c15ull ^ target * 0xc2b2ae3d27d4eb4full ^
+             position * 0x165667b19e3779f9ull ^ stats * 0xd6e8feb86659fd93ull;
+        h = ((h << 31) | (h >> 33)) * 0xff51afd7ed558ccdull;
+    }
+    return h;
+}
+
+void world_enable_state_hash(World *world) {
+    if (world->state_hash) return;
+    world->state_hash = arena_alloc(world->persistent_arena, sizeof(StateHash));
+    state_hash_init(world->state_hash, world->combatant_storage->capacity,
+                    combatant_state_hash, world->persistent_arena);
+}
+
+int world_share_view(World *world, const char *name, uint32_t every_turns) {
+    if (world->shared_view) return -1;
+    world->shared_view_every = every_turns ? every_turns : 1;
+    world->shared_view = shared_view_create(name, world->combatant_storage->capacity, sizeof(CombatantBundle),
+                                            world->entity_manager->capacity);
+    return world->shared_view ? 0 : -1;
+}
+
+uint64_t world_state_hash(World *world) {
+    return world->state_hash ? state_hash_update(world->state_hash, world->combatant_storage) : 0;
+}
+
+static MemoryRegion* report_add(WorldMemoryReport *report, const char *name, bool nested) {
+    if (report->count >= WORLD_MEMORY_MAX_REGIONS) return NULL;
+    MemoryRegion *r = &report->regions[report->count++];
+    r->name = name;
+    r->nested = nested;
+    return r;
+}
+
+static void report_arena(WorldMemoryReport *report, const char *name, const Arena *arena) {
+    MemoryRegion *r = report_add(report, name, false);
+    if (!r) return;
+    r->reserved = arena->size;
+    r->committed = memory_resident_bytes(arena->buffer, arena->size);
+    r->used = arena->offset;
+    r->high_water = arena->high_water;
+}
+
+void world_memory_report(const World *world, WorldMemoryReport *report) {
+    report->count = 0;
+
+    report_arena(report, "arena.persistent", world->persistent_arena);
+    report_arena(report, "arena.battle", world->battle_arena);
+
+    // Registered storages, all allocated from the battle arena. The sparse array
+    // is needed at full capacity; dense entries count as used while live.
+    const StorageManager *sm = world->storage_manager;
+    for (size_t i = 0; i < sm->count; i++) {
+        const SparseSet *set = sm->sets[i];
+        MemoryRegion *r = report_add(report, set->name ? set->name : "set", true);
+        if (!r) break;
+
+        const size_t per_entry = sizeof(uint32_t) + set->comp_size;
+        const size_t sparse_bytes = sizeof(uint32_t) * set->capacity;
+        r->reserved = sparse_bytes + per_entry * set->capacity;
+        r->committed = memory_resident_bytes(set->sparse, sparse_bytes) +
+                       memory_resident_bytes(set->dense_entities, sizeof(uint32_t) * set->capacity) +
+                       memory_resident_bytes(set->dense_data, set->comp_size * set->capacity);
+        r->used = sparse_bytes + per_entry * set->dense_count;
+        r->high_water = sparse_bytes + per_entry * set->peak_count;
+    }
+
+    // Generation counter and free-stack slot per entity ID
+    const EntityManager *em = world->entity_manager;
+    MemoryRegion *r = report_add(report, "entity_manager", false);
+    if (r) {
+        const size_t per_entity = 2 * sizeof(uint32_t);
+        r->reserved = per_entity * em->capacity;
+        r->committed = memory_resident_bytes(em->generation, sizeof(uint32_t) * em->capacity) +
+                       memory_resident_bytes(em->free_ids, sizeof(uint32_t) * em->capacity);
+        r->used = per_entity * em->living_count;
+        r->high_water = per_entity * em->peak_living;
+    }
+
+    const DeathQueue *dq = world->death_queue;
+    r = report_add(report, "death_queue", false);
+    if (r) {
+        r->reserved = sizeof(Entity) * dq->capacity;
+        r->committed = memory_resident_bytes(dq->entities, r->reserved);
+        r->used = sizeof(Entity) * dq->count;
+        r->high_water = sizeof(Entity) * dq->peak_count;
+    }
+
+    const ConcurrentDeathQueue *cq = world->parallel_deaths;
+    if (cq && (r = report_add(report, "parallel_deaths", false))) {
+        r->reserved = 2 * sizeof(OrderedDeath) * cq->capacity;
+        r->committed = memory_resident_bytes(cq->entries, sizeof(OrderedDeath) * cq->capacity) +
+                       memory_resident_bytes(cq->scratch, sizeof(OrderedDeath) * cq->capacity);
+        r->used = 0;  // drained within the pass that fills it
+        r->high_water = 0;
+    }
+
+    r = report_add(report, "storage_manager", false);
+    if (r) {
+        r->reserved = sizeof(SparseSet*) * sm->capacity;
+        r->committed = memory_resident_bytes(sm->sets, r->reserved);
+        r->used = sizeof(SparseSet*) * sm->count;
+        r->high_water = r->used;
     }
 }
 
 void world_destroy(World *world) {
+    PROFILE_FUNCTION();
+
     // Note: We don't free individual components since they're allocated from arenas
     // We just destroy the arenas which will free everything at once
 
     if (world) {
+        // Storages may still point into a loaded snapshot
+        world_snapshot_release(world);
+        shared_view_destroy(world->shared_view);
+
         // Storage manager cleanup (just frees the pointer array)
         storage_manager_free(world->storage_manager);
 
         // Death queue cleanup
         death_queue_free(world->death_queue);
+        if (world->parallel_deaths) {
+            concurrent_death_queue_free(world->parallel_deaths);
+            free(world->parallel_deaths);
+        }
 
         // Entity manager cleanup
         entity_manager_free(world->entity_manager);
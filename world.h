@@ -10,18 +10,59 @@
 #include "ecs_core/storage_manager.h"
 #include "ecs_core/death_queue.h"
 #include "ecs_core/sparse_set_storage.h"
+#include "ecs_core/field_index.h"
+#include "ecs_core/spatial_grid.h"
+#include "ecs_core/timing_wheel.h"
+#include "ecs_core/rng.h"
+#include "ecs_core/memory_stats.h"
+#include "ecs_core/journal.h"
+#include "ecs_core/state_hash.h"
+#include "ecs_core/shared_view.h"
 #include "components.h"
 #include "entity_factory.h"
 
 #define WEAKEST_CACHE_SIZE 8
+#define MAX_TEAMS 16    // team_id values a world supports (team index buckets, per-team arrays)
+#define DEFAULT_TEAMS 2 // team_count of a new world
+typedef char world_teams_fit_grid[MAX_TEAMS <= SPATIAL_GRID_MAX_GROUPS ? 1 : -1]; // team_id is the grid group
+#define WORLD_MEMORY_MAX_REGIONS 16
 
-//  Cache multiple weak targets per team
+// Nearest-targeting battlefield layout
+#define ATTACK_RANGE 1.5f       // max distance at which a unit can hit its target
+#define UNIT_SPACING 2.0f       // average spacing used to size the battlefield from capacity
+#define SPATIAL_CELL_SIZE 8.0f  // spatial grid cell side, a few unit spacings
+
+// Cooldown scheduling
+#define BASE_ATTACK_COOLDOWN 3.0f // turns between attacks at speed 1.0; faster units attack sooner
+
+typedef enum {
+    TARGETING_WEAKEST = 0, // spread attacks over the cached weakest enemies, no notion of space
+    TARGETING_NEAREST      // engage the nearest enemy, moving into ATTACK_RANGE first
+} TargetingMode;
+
+typedef enum {
+    SCHEDULE_EVERY_TURN = 0, // every unit acts on every turn
+    SCHEDULE_COOLDOWN        // units act when their attack cooldown expires
+} ScheduleMode;
+
+//  Cache multiple weak targets per team (or, for enemy_cache, across a team's enemies)
 typedef struct {
     Entity targets[WEAKEST_CACHE_SIZE];
     int healths[WEAKEST_CACHE_SIZE];
     uint32_t count;
 } WeakestCache;
 
+// Where world_step stopped inside a turn, so the next call resumes there.
+// Each phase zeroes everything but `phase` once it completes.
+typedef struct {
+    uint32_t phase;              // next entry of battle_phases; BATTLE_PHASE_COUNT once all ran
+    uint32_t stage;              // pass within the phase, 0 before it starts
+    uint32_t index;              // next item of that pass (dense, ready or damaged index)
+    uint32_t enemy_cache_idx[MAX_TEAMS]; // round-robin position in each team's enemy cache
+    uint32_t damaged_count;      // damaged_indices filled so far this turn
+    bool needs_cache_update;     // a unit died in this turn's attacks
+} TurnCursor;
+
 typedef struct World {
     // ECS Core
     EntityManager *entity_manager;
@@ -34,30 +75,111 @@ typedef struct World {
 
     // Component Storages
     SparseSet *combatant_storage;
-    // index-only sets for fast team-based lookups
-    SparseSet *team_a_storage;
-    SparseSet *team_b_storage;
+    // Combatants bucketed by team_id; combatant_storage keeps it up to date
+    FieldIndex *team_index;
 
     // Battle State
-    uint32_t team_a_count;
-    uint32_t team_b_count;
+    // Teams 0 .. team_count - 1 take part (set before spawning, kept across
+    // world_reset_battle; spawning a higher team_id raises it). Every team is
+    // hostile to every other one.
+    uint32_t team_count;
+    uint32_t team_spawned[MAX_TEAMS]; // units spawned per team this battle
     bool battle_active;
     uint32_t turn_number;
+    TurnCursor turn_cursor; // partial turn left by world_step, zero between turns
 
     // Targeting Cache (Enhanced)
-    Entity weakest_team_a;
-    Entity weakest_team_b;
-    int weakest_team_a_health;
-    int weakest_team_b_health;
     bool needs_target_update;
+    uint32_t resolved_target_version; // combatant_storage version all targets were last resolved at
+
+    //  Multiple target caching: the weakest units of every team hostile to
+    //  team t, which team t's units spread their attacks over
+    WeakestCache enemy_cache[MAX_TEAMS];
+
+    // Spatial targeting (set targeting_mode before spawning)
+    TargetingMode targeting_mode;
+    float battlefield_width;
+    float battlefield_height;
+    SpatialGrid *spatial; // every team, grouped by team_id; only populated in TARGETING_NEAREST
 
-    //  Multiple target caching
-    WeakestCache weakest_cache_a;
-    WeakestCache weakest_cache_b;
+    // Cooldown scheduling (set schedule_mode before spawning)
+    ScheduleMode schedule_mode;
+    TimingWheel *action_wheel;    // next action turn per entity
+    uint32_t *ready_entities;     // entities acting this turn, filled by combat_system_schedule
+    uint32_t ready_count;
+    int32_t *damage_accumulator;  // per dense index, zero between turns (both schedule modes)
+    uint32_t *damaged_indices;    // dense indices with pending damage this turn
+
+    // Per-world random streams, so worlds on different threads don't share state
+    uint64_t seed;  // base seed; spawn_army derives per-block streams from it
+    Rng rng;        // sequential stream for one-off draws (spawn_soldier)
+
+    // Threads spawn_army and large damage-application passes may use; 1 keeps
+    // everything on the caller's thread
+    uint32_t worker_threads;
+    // Deaths queued by parallel damage application, drained into death_queue
+    // in dense order; allocated on first use
+    ConcurrentDeathQueue *parallel_deaths;
+
+    // Combat events are recorded here when set (see CombatEventType); the ring
+    // must belong to the thread running the battle
+    JournalRing *journal;
+    bool journal_state_only;     // record only per-turn state hashes, not combat events
+
+    // Incremental hash of the combatant storage, NULL unless world_enable_state_hash
+    // was called; systems mark the dense slots they write
+    StateHash *state_hash;
+
+    // Combatants and generations published here every shared_view_every
+    // turns for other processes to read, NULL unless world_share_view was called
+    SharedView *shared_view;
+    uint32_t shared_view_every;
+
+    // File mapping the storages point into after world_snapshot_load, NULL otherwise
+    void *snapshot_base;
+    size_t snapshot_size;
 } World;
 
+// Footprint of the arenas, every registered storage and the managers.
+// Storages are nested under the battle arena they live in.
+typedef struct {
+    MemoryRegion regions[WORLD_MEMORY_MAX_REGIONS];
+    size_t count;
+} WorldMemoryReport;
+
 World* world_create(size_t max_entities);
+// Like world_create, with the battle arena in shared memory so world_fork can
+// branch it; falls back to a plain world where that isn't available
+World* world_create_forkable(size_t max_entities);
+// Independent copy of a forkable world (or of a fork) as it stands, for what-if
+// branches. Storages, grids and the wheel stay shared with the parent page by
+// page until either side writes them; only the entity manager's arrays are
+// copied. The fork has no journal and may run on another thread; destroy it
+// with world_destroy. Returns NULL for plain worlds and worlds running on a
+// loaded snapshot. See arena_fork for what forking again after the parent
+// has moved on costs.
+World* world_fork(World *parent);
 void world_destroy(World *world);
 void world_reset_battle(World *world);
+// Size the battlefield for a battle of `units` (at most the capacity) as
+// world_create does for its capacity; takes effect at the next
+// world_reset_battle. Lets a large pooled world play a small battle exactly
+// like a world created for it.
+void world_size_battlefield(World *world, size_t units);
+void world_seed(World *world, uint64_t seed);
+// Track a hash of the combatant storage from now on (see battle_finish_turn)
+void world_enable_state_hash(World *world);
+// Publish the combatant storage and entity generations to the POSIX shared
+// memory object `name` at the end of every `every_turns`-th turn and of the
+// battle's last one (by battle_end; see ecs_core/shared_view.h); removed again by
+// world_destroy. Returns -1 if shared memory isn't available or the world
+// already has a view.
+int world_share_view(World *world, const char *name, uint32_t every_turns);
+// Hash of the combatant storage after rehashing what changed; 0 if not enabled
+uint64_t world_state_hash(World *world);
+// Per-turn scratch (ready list, damage accumulator) from the battle arena
+void world_init_turn_buffers(World *world, uint32_t capacity);
+// High-water marks cover the current battle (reset by world_reset_battle)
+void world_memory_report(const World *world, WorldMemoryReport *report);
 
 #endif //SPARSE_STORAGE_LEARNING_WORLD_H
\ No newline at end of file
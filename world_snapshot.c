@@ -0,0 +1,474 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#include "world_snapshot.h"
+#include "ecs_core/profiler.h"
+#include <string.h>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define WORLD_SNAPSHOT_HAVE_MMAP 1
+#endif
+
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+// Fixed section slots; absent sections have size 0
+enum {
+    SECTION_EM_GENERATION = 0,
+    SECTION_EM_FREE_IDS,
+    SECTION_DEATH_QUEUE,
+    SECTION_WHEEL_SLOT_HEAD,
+    SECTION_WHEEL_NEXT,
+    SECTION_WHEEL_PREV,
+    SECTION_WHEEL_SLOT_OF,
+    SECTION_WHEEL_DUE,
+    SECTION_GRID_CELL_HEAD,
+    SECTION_GRID_NODES,
+    SECTION_GRID_CELL_OF,
+    SECTION_GRID_GROUP,
+    SECTION_GRID_CELL_GROUPS,
+    SECTION_SET_BASE,                                            // sparse, dense_entities, dense_data per set
+    SECTION_COUNT = SECTION_SET_BASE + 3 * WORLD_SNAPSHOT_MAX_SETS
+};
+
+typedef struct {
+    uint64_t offset;    // from the start of the file, a multiple of WORLD_SNAPSHOT_ALIGN
+    uint64_t size;      // bytes reserved, including any hole at the end
+} SnapshotSection;
+
+typedef struct {
+    uint64_t comp_size;
+    uint32_t capacity;
+    uint32_t dense_count;
+    uint32_t version;
+    uint32_t peak_count;
+} SnapshotSet;
+
+typedef struct {
+    float origin_x;
+    float origin_y;
+    float cell_size;
+    uint32_t cols;
+    uint32_t rows;
+    uint32_t count;     // 0: not stored, rebuilt empty on load
+} SnapshotGrid;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint32_t capacity;          // entity capacity every per-entity array is sized to
+    uint64_t file_size;
+
+    // Entity manager
+    uint32_t living_count;
+    uint32_t free_count;
+    uint32_t peak_living;
+    uint32_t set_count;
+
+    // Battle state
+    uint32_t team_count;
+    uint32_t team_spawned[MAX_TEAMS];
+    uint32_t turn_number;
+    uint32_t resolved_target_version;
+    uint32_t battle_active;
+    uint32_t needs_target_update;
+    uint32_t targeting_mode;
+    uint32_t schedule_mode;
+    float battlefield_width;
+    float battlefield_height;
+    uint64_t seed;
+    Rng rng;
+    WeakestCache enemy_cache[MAX_TEAMS];
+    uint64_t death_count;
+    uint64_t death_peak;
+
+    SnapshotSet sets[WORLD_SNAPSHOT_MAX_SETS];
+    SnapshotGrid grid;
+    uint32_t wheel_now;
+    uint32_t wheel_count;       // 0: not stored, rebuilt empty on load
+
+    SnapshotSection sections[SECTION_COUNT];
+} SnapshotHeader;
+
+// The header has the first page to itself
+typedef char snapshot_header_fits[sizeof(SnapshotHeader) <= WORLD_SNAPSHOT_ALIGN ? 1 : -1];
+
+static uint64_t snapshot_align(uint64_t offset) {
+    return (offset + WORLD_SNAPSHOT_ALIGN - 1) & ~(uint64_t)(WORLD_SNAPSHOT_ALIGN - 1);
+}
+
+#ifdef WORLD_SNAPSHOT_HAVE_MMAP
+
+static int write_all(int fd, const void *data, size_t size, uint64_t offset) {
+    const char *bytes = data;
+    while (size > 0) {
+        const ssize_t n = pwrite(fd, bytes, size, (off_t)offset);
+        if (n <= 0) return -1;
+        bytes += n;
+        size -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+// Reserve `reserved` bytes for a section at the end of the file and write the
+// first `written` of them; the rest stays a hole until ftruncate extends the file
+static int write_section(int fd, SnapshotHeader *header, uint64_t *end, int section,
+                         const void *data, size_t written, size_t reserved) {
+    SnapshotSection *s = &header->sections[section];
+    s->offset = *end;
+    s->size = reserved;
+    *end = snapshot_align(*end + reserved);
+    return written ? write_all(fd, data, written, s->offset) : 0;
+}
+
+int world_snapshot_save(const World *world, const char *path) {
+    PROFILE_FUNCTION();
+
+    const EntityManager *em = world->entity_manager;
+    const StorageManager *sm = world->storage_manager;
+    const DeathQueue *dq = world->death_queue;
+    const TimingWheel *tw = world->action_wheel;
+    if (sm->count > WORLD_SNAPSHOT_MAX_SETS) return -1;
+    if (world->turn_cursor.phase != 0) return -1;
+
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WORLD_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = WORLD_SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.header_size = sizeof(SnapshotHeader);
+    header.capacity = em->capacity;
+
+    header.living_count = em->living_count;
+    header.free_count = em->free_count;
+    header.peak_living = em->peak_living;
+    header.set_count = (uint32_t)sm->count;
+
+    header.team_count = world->team_count;
+    memcpy(header.team_spawned, world->team_spawned, sizeof(header.team_spawned));
+    header.turn_number = world->turn_number;
+    header.resolved_target_version = world->resolved_target_version;
+    header.battle_active = world->battle_active;
+    header.needs_target_update = world->needs_target_update;
+    header.targeting_mode = world->targeting_mode;
+    header.schedule_mode = world->schedule_mode;
+    header.battlefield_width = world->battlefield_width;
+    header.battlefield_height = world->battlefield_height;
+    header.seed = world->seed;
+    header.rng = world->rng;
+    memcpy(header.enemy_cache, world->enemy_cache, sizeof(header.enemy_cache));
+    header.death_count = dq->count;
+    header.death_peak = dq->peak_count;
+
+    const int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+
+    uint64_t end = WORLD_SNAPSHOT_ALIGN;
+    const size_t id_bytes = sizeof(uint32_t) * em->capacity;
+    int rc = 0;
+
+    // Free IDs are popped from the top, so only the stack's live part matters
+    rc |= write_section(fd, &header, &end, SECTION_EM_GENERATION, em->generation, id_bytes, id_bytes);
+    rc |= write_section(fd, &header, &end, SECTION_EM_FREE_IDS, em->free_ids,
+                        sizeof(uint32_t) * em->free_count, id_bytes);
+    rc |= write_section(fd, &header, &end, SECTION_DEATH_QUEUE, dq->entities,
+                        sizeof(Entity) * dq->count, sizeof(Entity) * dq->count);
+
+    if (tw->count > 0) {
+        header.wheel_now = tw->now;
+        header.wheel_count = tw->count;
+        const size_t slot_bytes = sizeof(uint32_t) * TIMING_WHEEL_LEVELS * TIMING_WHEEL_SLOTS;
+        const size_t wheel_bytes = sizeof(uint32_t) * tw->capacity;
+        rc |= write_section(fd, &header, &end, SECTION_WHEEL_SLOT_HEAD, tw->slot_head, slot_bytes, slot_bytes);
+        rc |= write_section(fd, &header, &end, SECTION_WHEEL_NEXT, tw->next, wheel_bytes, wheel_bytes);
+        rc |= write_section(fd, &header, &end, SECTION_WHEEL_PREV, tw->prev, wheel_bytes, wheel_bytes);
+        rc |= write_section(fd, &header, &end, SECTION_WHEEL_SLOT_OF, tw->slot_of, wheel_bytes, wheel_bytes);
+        rc |= write_section(fd, &header, &end, SECTION_WHEEL_DUE, tw->due, wheel_bytes, wheel_bytes);
+    }
+
+    const SpatialGrid *grid = world->spatial;
+    if (grid->count > 0) {
+        SnapshotGrid *sg = &header.grid;
+        sg->origin_x = grid->origin_x;
+        sg->origin_y = grid->origin_y;
+        sg->cell_size = grid->cell_size;
+        sg->cols = grid->cols;
+        sg->rows = grid->rows;
+        sg->count = grid->count;
+
+        const size_t cell_bytes = sizeof(uint32_t) * grid->cols * grid->rows * SPATIAL_GRID_MAX_GROUPS;
+        const size_t node_bytes = sizeof(SpatialGridNode) * grid->capacity;
+        const size_t cell_of_bytes = sizeof(uint32_t) * grid->capacity;
+        const size_t group_bytes = sizeof(uint8_t) * grid->capacity;
+        const size_t cell_groups_bytes = sizeof(uint16_t) * grid->cols * grid->rows;
+        rc |= write_section(fd, &header, &end, SECTION_GRID_CELL_HEAD, grid->cell_head, cell_bytes, cell_bytes);
+        rc |= write_section(fd, &header, &end, SECTION_GRID_NODES, grid->nodes, node_bytes, node_bytes);
+        rc |= write_section(fd, &header, &end, SECTION_GRID_CELL_OF, grid->cell_of, cell_of_bytes, cell_of_bytes);
+        rc |= write_section(fd, &header, &end, SECTION_GRID_GROUP, grid->group, group_bytes, group_bytes);
+        rc |= write_section(fd, &header, &end, SECTION_GRID_CELL_GROUPS, grid->cell_groups,
+                            cell_groups_bytes, cell_groups_bytes);
+    }
+
+    // Dense arrays are reserved at full capacity so the loaded set can grow in place
+    for (size_t i = 0; i < sm->count; i++) {
+        const SparseSet *set = sm->sets[i];
+        SnapshotSet *ss = &header.sets[i];
+        ss->comp_size = set->comp_size;
+        ss->capacity = set->capacity;
+        ss->dense_count = set->dense_count;
+        ss->version = set->version;
+        ss->peak_count = set->peak_count;
+
+        const size_t bytes = sizeof(uint32_t) * set->capacity;
+        const int base = SECTION_SET_BASE + 3 * (int)i;
+        rc |= write_section(fd, &header, &end, base, set->sparse, bytes, bytes);
+        rc |= write_section(fd, &header, &end, base + 1, set->dense_entities,
+                            sizeof(uint32_t) * set->dense_count, bytes);
+        if (set->comp_size > 0) {
+            rc |= write_section(fd, &header, &end, base + 2, set->dense_data,
+                                set->comp_size * set->dense_count, set->comp_size * set->capacity);
+        }
+    }
+
+    header.file_size = end;
+    rc |= write_all(fd, &header, sizeof(header), 0);
+    if (rc == 0 && ftruncate(fd, (off_t)end) != 0) rc = -1;
+    if (close(fd) != 0) rc = -1;
+    return rc == 0 ? 0 : -1;
+}
+
+static bool section_ok(const SnapshotHeader *header, int section, uint64_t expected) {
+    const SnapshotSection *s = &header->sections[section];
+    return s->size == expected && s->offset % WORLD_SNAPSHOT_ALIGN == 0 &&
+           s->offset >= WORLD_SNAPSHOT_ALIGN && s->offset + s->size <= header->file_size;
+}
+
+// Check the header against the world it's being loaded into, and every
+// section against the array it will back
+static bool snapshot_matches(const SnapshotHeader *header, const World *world, uint64_t file_size) {
+    const StorageManager *sm = world->storage_manager;
+    const uint64_t ids = (uint64_t)sizeof(uint32_t) * header->capacity;
+
+    if (memcmp(header->magic, WORLD_SNAPSHOT_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != WORLD_SNAPSHOT_VERSION || header->byte_order != SNAPSHOT_BYTE_ORDER ||
+        header->header_size != sizeof(SnapshotHeader) || header->file_size != file_size ||
+        header->capacity != world->entity_manager->capacity || header->set_count != sm->count ||
+        header->free_count > header->capacity || header->death_count > header->capacity ||
+        header->team_count > MAX_TEAMS) {
+        return false;
+    }
+
+    if (!section_ok(header, SECTION_EM_GENERATION, ids) || !section_ok(header, SECTION_EM_FREE_IDS, ids) ||
+        !section_ok(header, SECTION_DEATH_QUEUE, sizeof(Entity) * header->death_count)) {
+        return false;
+    }
+
+    if (header->wheel_count > 0) {
+        if (!section_ok(header, SECTION_WHEEL_SLOT_HEAD,
+                        sizeof(uint32_t) * TIMING_WHEEL_LEVELS * TIMING_WHEEL_SLOTS)) return false;
+        for (int s = SECTION_WHEEL_NEXT; s <= SECTION_WHEEL_DUE; s++) {
+            if (!section_ok(header, s, ids)) return false;
+        }
+    }
+
+    const SnapshotGrid *sg = &header->grid;
+    if (sg->count > 0 &&
+        (sg->cols == 0 || sg->rows == 0 ||
+         !section_ok(header, SECTION_GRID_CELL_HEAD,
+                     (uint64_t)sizeof(uint32_t) * sg->cols * sg->rows * SPATIAL_GRID_MAX_GROUPS) ||
+         !section_ok(header, SECTION_GRID_NODES, (uint64_t)sizeof(SpatialGridNode) * header->capacity) ||
+         !section_ok(header, SECTION_GRID_CELL_OF, ids) ||
+         !section_ok(header, SECTION_GRID_GROUP, (uint64_t)sizeof(uint8_t) * header->capacity) ||
+         !section_ok(header, SECTION_GRID_CELL_GROUPS, (uint64_t)sizeof(uint16_t) * sg->cols * sg->rows))) {
+        return false;
+    }
+
+    for (size_t i = 0; i < sm->count; i++) {
+        const SparseSet *set = sm->sets[i];
+        const SnapshotSet *ss = &header->sets[i];
+        const int base = SECTION_SET_BASE + 3 * (int)i;
+        if (ss->comp_size != set->comp_size || ss->capacity != set->capacity ||
+            ss->dense_count > ss->capacity ||
+            !section_ok(header, base, ids) || !section_ok(header, base + 1, ids) ||
+            (set->comp_size > 0 && !section_ok(header, base + 2, ss->comp_size * ss->capacity))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int world_snapshot_load(World *world, const char *path) {
+    PROFILE_FUNCTION();
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size < WORLD_SNAPSHOT_ALIGN) {
+        close(fd);
+        return -1;
+    }
+
+    // Private and writable: the battle writes into these pages, the file never changes
+    const size_t size = (size_t)st.st_size;
+    char *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    const SnapshotHeader *header = (const SnapshotHeader*)base;
+    if (!snapshot_matches(header, world, size)) {
+        munmap(base, size);
+        return -1;
+    }
+
+    // From here on the snapshot replaces the battle
+    world_snapshot_release(world);
+    arena_reset(world->battle_arena);
+    const uint32_t capacity = header->capacity;
+
+    const StorageManager *sm = world->storage_manager;
+    for (size_t i = 0; i < sm->count; i++) {
+        SparseSet *set = sm->sets[i];
+        const SnapshotSet *ss = &header->sets[i];
+        const int s = SECTION_SET_BASE + 3 * (int)i;
+        set->sparse = (uint32_t*)(base + header->sections[s].offset);
+        set->dense_entities = (uint32_t*)(base + header->sections[s + 1].offset);
+        set->dense_data = set->comp_size > 0 ? base + header->sections[s + 2].offset : NULL;
+        set->dense_count = ss->dense_count;
+        set->version = ss->version;
+        set->peak_count = ss->peak_count;
+        set->arena = world->battle_arena;
+    }
+    // Members were saved in bucket order; only the bounds need recomputing
+    field_index_recount(world->team_index);
+
+    world->battlefield_width = header->battlefield_width;
+    world->battlefield_height = header->battlefield_height;
+    SpatialGrid *grid = world->spatial;
+    const SnapshotGrid *sg = &header->grid;
+    if (sg->count == 0) {
+        spatial_grid_init(grid, capacity, 0.0f, 0.0f, world->battlefield_width,
+                          world->battlefield_height, SPATIAL_CELL_SIZE, world->battle_arena);
+    } else {
+        grid->origin_x = sg->origin_x;
+        grid->origin_y = sg->origin_y;
+        grid->cell_size = sg->cell_size;
+        grid->inv_cell_size = 1.0f / sg->cell_size;
+        grid->cols = sg->cols;
+        grid->rows = sg->rows;
+        grid->cell_head = (uint32_t*)(base + header->sections[SECTION_GRID_CELL_HEAD].offset);
+        grid->nodes = (SpatialGridNode*)(base + header->sections[SECTION_GRID_NODES].offset);
+        grid->cell_of = (uint32_t*)(base + header->sections[SECTION_GRID_CELL_OF].offset);
+        grid->group = (uint8_t*)(base + header->sections[SECTION_GRID_GROUP].offset);
+        grid->cell_groups = (uint16_t*)(base + header->sections[SECTION_GRID_CELL_GROUPS].offset);
+        grid->capacity = capacity;
+        grid->count = sg->count;
+    }
+
+    TimingWheel *tw = world->action_wheel;
+    if (header->wheel_count == 0) {
+        timing_wheel_init(tw, capacity, world->battle_arena);
+    } else {
+        tw->slot_head = (uint32_t*)(base + header->sections[SECTION_WHEEL_SLOT_HEAD].offset);
+        tw->next = (uint32_t*)(base + header->sections[SECTION_WHEEL_NEXT].offset);
+        tw->prev = (uint32_t*)(base + header->sections[SECTION_WHEEL_PREV].offset);
+        tw->slot_of = (uint32_t*)(base + header->sections[SECTION_WHEEL_SLOT_OF].offset);
+        tw->due = (uint32_t*)(base + header->sections[SECTION_WHEEL_DUE].offset);
+        tw->now = header->wheel_now;
+        tw->capacity = capacity;
+        tw->count = header->wheel_count;
+    }
+    world_init_turn_buffers(world, capacity);
+
+    // The entity manager owns its arrays, so these are copied
+    EntityManager *em = world->entity_manager;
+    memcpy(em->generation, base + header->sections[SECTION_EM_GENERATION].offset,
+           sizeof(uint32_t) * capacity);
+    memcpy(em->free_ids, base + header->sections[SECTION_EM_FREE_IDS].offset,
+           sizeof(uint32_t) * header->free_count);
+    em->living_count = header->living_count;
+    em->free_count = header->free_count;
+    em->peak_living = header->peak_living;
+
+    DeathQueue *dq = world->death_queue;
+    death_queue_clear(dq);
+    const Entity *deaths = (const Entity*)(base + header->sections[SECTION_DEATH_QUEUE].offset);
+    for (uint64_t i = 0; i < header->death_count; i++) {
+        death_queue_push(dq, deaths[i]);
+    }
+    dq->peak_count = header->death_peak;
+
+    world->team_count = header->team_count;
+    memcpy(world->team_spawned, header->team_spawned, sizeof(world->team_spawned));
+    world->turn_number = header->turn_number;
+    memset(&world->turn_cursor, 0, sizeof(world->turn_cursor));
+    world->resolved_target_version = header->resolved_target_version;
+    world->battle_active = header->battle_active != 0;
+    world->needs_target_update = header->needs_target_update != 0;
+    world->targeting_mode = (TargetingMode)header->targeting_mode;
+    world->schedule_mode = (ScheduleMode)header->schedule_mode;
+    world->seed = header->seed;
+    world->rng = header->rng;
+    memcpy(world->enemy_cache, header->enemy_cache, sizeof(world->enemy_cache));
+
+    // Every dense slot was replaced
+    if (world->state_hash) state_hash_reset(world->state_hash);
+
+    world->snapshot_base = base;
+    world->snapshot_size = size;
+    return 0;
+}
+
+uint32_t world_snapshot_capacity(const char *path) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+
+    SnapshotHeader header;
+    const ssize_t n = pread(fd, &header, sizeof(header), 0);
+    close(fd);
+    if (n != (ssize_t)sizeof(header) || memcmp(header.magic, WORLD_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != WORLD_SNAPSHOT_VERSION || header.byte_order != SNAPSHOT_BYTE_ORDER) {
+        return 0;
+    }
+    return header.capacity;
+}
+
+void world_snapshot_release(World *world) {
+    if (!world->snapshot_base) return;
+    munmap(world->snapshot_base, world->snapshot_size);
+    world->snapshot_base = NULL;
+    world->snapshot_size = 0;
+}
+
+#else
+
+int world_snapshot_save(const World *world, const char *path) {
+    (void)world;
+    (void)path;
+    return -1;
+}
+
+int world_snapshot_load(World *world, const char *path) {
+    (void)world;
+    (void)path;
+    return -1;
+}
+
+uint32_t world_snapshot_capacity(const char *path) {
+    (void)path;
+    return 0;
+}
+
+void world_snapshot_release(World *world) {
+    world->snapshot_base = NULL;
+    world->snapshot_size = 0;
+}
+
+#endif
@@ -0,0 +1,49 @@
+//
+// Created by jo on 10/19/2026.
+//
+
+#ifndef SPARSE_STORAGE_LEARNING_WORLD_SNAPSHOT_H
+#define SPARSE_STORAGE_LEARNING_WORLD_SNAPSHOT_H
+
+#include "world.h"
+
+// Binary snapshot of a World's battle: entity manager, every registered
+// storage, spatial grids, action wheel, death queue and battle state.
+//
+// Layout: a header page (magic, version, battle state, section table)
+// followed by one section per array, each starting on a
+// WORLD_SNAPSHOT_ALIGN boundary and sized to the array's full capacity.
+// Unused tails are left as file holes, so the file is only as large on
+// disk as the live data. An empty grid or wheel isn't stored at all and
+// is rebuilt on load.
+//
+// Loading maps the file MAP_PRIVATE and points the storages, grid and
+// wheel straight into the mapping, so pages are only read when touched and
+// only copied when written. The entity manager's arrays are copied since
+// it owns them. Files use the writer's byte order and struct layout.
+
+#define WORLD_SNAPSHOT_MAGIC "ECSWSNAP"
+#define WORLD_SNAPSHOT_VERSION 2
+#define WORLD_SNAPSHOT_ALIGN 4096
+#define WORLD_SNAPSHOT_MAX_SETS 16
+
+// Write the world's current state to path; returns 0 on success, -1 on error.
+// Can be taken between any two turns, so it also serves as a checkpoint; a
+// world world_step left partway through a turn can't be saved.
+int world_snapshot_save(const World *world, const char *path);
+
+// Replace the world's battle with the snapshot at path. The world needs the
+// same entity capacity and registered storage layout as the one that saved
+// it. Returns 0 on success, -1 (world untouched) if the file can't be mapped
+// or doesn't match. The mapping lives until the next reset, load or destroy.
+int world_snapshot_load(World *world, const char *path);
+
+// Entity capacity of the world that saved path, 0 if it isn't a readable
+// snapshot; create the world to load it into with this capacity
+uint32_t world_snapshot_capacity(const char *path);
+
+// Unmap the world's snapshot, if any; storages pointing into it become
+// invalid, so only call this right before re-initializing them
+void world_snapshot_release(World *world);
+
+#endif //SPARSE_STORAGE_LEARNING_WORLD_SNAPSHOT_H